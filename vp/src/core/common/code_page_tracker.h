@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2024-2026 Manfred Schlaegl <manfred.schlaegl@gmx.at>
+ *
+ * Code Page Tracker
+ * Tracks writes to 4KiB pages of (dmi capable) host memory, that hold code cached by the DBBCache (code pages).
+ * Each page has a state word: Bit 0 is set, if the page is a code page. The remaining bits are a write generation,
+ * which is incremented on every write to a code page.
+ * The DBBCache remembers the state words of all pages of a block and only has to re-fetch/re-decode a block on
+ * coherence events (fence.i, sfence.vma), if one of its pages was written (or re-mapped) since then.
+ *
+ * All writers to the tracked memory must report their writes:
+ *  * ISS stores via dmi: MemoryDMI::store (dmi.h)
+ *  * ISS stores via LSCache: LSCache entries with store permission are never created for code pages and are flushed
+ *    on all harts, if a new code page is marked (see CombinedMemoryInterface_T in mem.h)
+ *  * Transactions (ISS without dmi, DMA, debugger, ...): SimpleMemory (platform/common/memory.h) via host_write
+ *  * Direct host accesses (e.g. syscall emulation): host_write
+ *
+ * State words are updated atomically (harts may run in parallel, see parallel_runner.h).
+ * Additionally, a flag per 2MiB region of the memory is set, if the region contains code pages (fast check for
+ * superpage entries in the LSCache, see has_code_pages).
+ *
+ * There is one tracker per host memory area. Trackers are created on creation of MemoryDMI objects and are shared by
+ * all MemoryDMI objects (and their copies) referring to the same memory.
+ */
+
+#ifndef RISCV_ISA_CODE_PAGE_TRACKER_H
+#define RISCV_ISA_CODE_PAGE_TRACKER_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "util/common.h"
+
+class CodePageTracker {
+	const static unsigned int PAGE_SHIFT = 12;
+	const static unsigned int REGION_SHIFT = 21;
+	const static uint32_t STATE_CODE = (1 << 0);
+	const static uint32_t STATE_GEN_INC = (1 << 1);
+
+	const uint8_t *const mem;
+	const uint64_t size;
+	std::vector<uint32_t> state;
+	std::vector<uint8_t> code_regions;
+	std::vector<std::function<void(void)>> new_code_page_listeners;
+
+	CodePageTracker(const uint8_t *mem, uint64_t size)
+	    : mem(mem),
+	      size(size),
+	      state(((size - 1) >> PAGE_SHIFT) + 1, 0),
+	      code_regions(((size - 1) >> REGION_SHIFT) + 1, 0) {}
+
+	static std::vector<std::unique_ptr<CodePageTracker>> &trackers() {
+		static std::vector<std::unique_ptr<CodePageTracker>> trackers;
+		return trackers;
+	}
+
+	__always_inline uint64_t page_idx(const void *host_addr) const {
+		return ((const uint8_t *)host_addr - mem) >> PAGE_SHIFT;
+	}
+
+   public:
+	/* get the tracker responsible for the given host memory area (created if not existent) */
+	static CodePageTracker *get(const uint8_t *mem, uint64_t size) {
+		for (auto &t : trackers()) {
+			if (t->contains(mem) && t->contains(mem + size - 1)) {
+				return t.get();
+			}
+		}
+		trackers().emplace_back(new CodePageTracker(mem, size));
+		return trackers().back().get();
+	}
+
+	/* report a write to host memory, which is not done via MemoryDMI (e.g. transactions, syscall emulation) */
+	static void host_write(const void *host_addr, uint64_t len) {
+		if (len == 0) {
+			return;
+		}
+		for (auto &t : trackers()) {
+			if (t->contains(host_addr)) {
+				t->write(host_addr, len);
+			}
+		}
+	}
+
+	__always_inline bool contains(const void *host_addr) const {
+		return (const uint8_t *)host_addr >= mem && (const uint8_t *)host_addr < mem + size;
+	}
+
+	/* called on new code pages (e.g. to flush LSCache store entries) */
+	void add_new_code_page_listener(std::function<void(void)> listener) {
+		new_code_page_listeners.push_back(listener);
+	}
+
+	/*
+	 * report a write of len bytes to host_addr (may span pages)
+	 * returns true, if a code page was written
+	 */
+	__always_inline bool write(const void *host_addr, uint64_t len) {
+		bool ret = false;
+		uint64_t last = page_idx((const uint8_t *)host_addr + len - 1);
+		for (uint64_t idx = page_idx(host_addr); idx <= last && idx < state.size(); idx++) {
+			if (unlikely(__atomic_load_n(&state[idx], __ATOMIC_RELAXED) & STATE_CODE)) {
+				__atomic_fetch_add(&state[idx], STATE_GEN_INC, __ATOMIC_RELAXED);
+				ret = true;
+			}
+		}
+		return ret;
+	}
+
+	__always_inline bool is_code_page(const void *host_addr) const {
+		return state[page_idx(host_addr)] & STATE_CODE;
+	}
+
+	/* returns true, if the len bytes at host_addr may contain code pages (granularity: regions, see above) */
+	bool has_code_pages(const void *host_addr, uint64_t len) const {
+		uint64_t last = ((const uint8_t *)host_addr + len - 1 - mem) >> REGION_SHIFT;
+		for (uint64_t idx = ((const uint8_t *)host_addr - mem) >> REGION_SHIFT; idx <= last; idx++) {
+			if (__atomic_load_n(&code_regions[idx], __ATOMIC_RELAXED)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/*
+	 * mark the page containing host_addr as code page
+	 * returns a pointer to the state of the page (see above)
+	 */
+	const uint32_t *mark_code_page(const void *host_addr) {
+		uint32_t &s = state[page_idx(host_addr)];
+		if (!(__atomic_load_n(&s, __ATOMIC_RELAXED) & STATE_CODE) &&
+		    !(__atomic_fetch_or(&s, STATE_CODE, __ATOMIC_RELAXED) & STATE_CODE)) {
+			__atomic_store_n(&code_regions[((const uint8_t *)host_addr - mem) >> REGION_SHIFT], 1, __ATOMIC_RELAXED);
+			for (auto &listener : new_code_page_listeners) {
+				listener();
+			}
+		}
+		return &s;
+	}
+};
+
+#endif /* RISCV_ISA_CODE_PAGE_TRACKER_H */
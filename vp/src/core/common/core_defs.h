@@ -70,7 +70,7 @@ class RV_ISA_Config {
 
 	uint64_t cfg = 0;
 
-	RV_ISA_Config(bool use_E_base_isa = false, bool en_Zfh = false) {
+	constexpr RV_ISA_Config(bool use_E_base_isa = false, bool en_Zfh = false) {
 		// init default: IMACFDV + NUS
 		cfg = csr_misa::I | csr_misa::M | csr_misa::A | csr_misa::F | csr_misa::D | csr_misa::C | csr_misa::N |
 		      csr_misa::U | csr_misa::S | csr_misa::V;
@@ -83,12 +83,12 @@ class RV_ISA_Config {
 		}
 	}
 
-	void select_E_base_isa() {
+	constexpr void select_E_base_isa() {
 		cfg &= ~csr_misa::I;
 		cfg |= csr_misa::E;
 	}
 
-	void select_Zfh() {
+	constexpr void select_Zfh() {
 		cfg |= Zfh;
 	}
 
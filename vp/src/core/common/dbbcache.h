@@ -37,43 +37,144 @@
  *      ISS has to set its flag and must also force the DBBCache to its
  *      slow path). The slow path is for example set on interrupt events,
  *      changes of interrupt/trap related csrs, tlm quantum sync requests
- *      (see below), handling of atomic instructions, enabled debug/trace
- *      mode, ...
+ *      (see below), handling of atomic instructions holding the bus lock
+ *      (no dmi), enabled debug/trace mode, ...
  *      After handling these events, a full DBBCache fetch/decode is called
  *      and the next operation is dispatched (jump).
- *  * Lazy/Approximate tlm quantum checks:
- *    * an estimate of the consumed tlm quantum cycles is tracked
- *      using the instruction count (reduces quantum keeper update calls
- *      significantly)
+ *  * Batched tlm quantum checks:
+ *    * the cycles (and instructions) of a block are accounted at once,
+ *      when the block is left (see switch_block). The ISS compares the
+ *      accounted cycles against the budget left in the current quantum
+ *      (see get_cycle_counter_raw_accounted) on taken branches and jumps
+ *      -> no per-instruction counting in the fast path and no quantum
+ *      keeper calls until the budget is exhausted.
  *    * check and synchronization with the quantum keeper is done only
- *      before systemc context switches or control flow changes based
- *      on the estimate.
+ *      before systemc context switches or if the budget is exhausted.
  *      (reduces quantum keeper check and sync calls significantly)
  *  * Executed cycles and PC calculated on demand: The DBBCache implicitly
  *    keeps track of the current PC and the number executed cycles. The ISS can
  *    request generation of these values on demand (e.g. PC for trap,
  *    cycles see below)
  *  * On demand performance counters (minstret and mcycles CSRs) are
- *    created on demand. Number of executed instructions is tracked by the
- *    ISS (->minstret), number of executed cycles is tracked by DBBCache
- *    (see above) (->mcycles)
+ *    created on demand. Number of executed instructions (->minstret) and
+ *    cycles (->mcycles) are tracked by DBBCache (see above)
  *  * Target PC addresses for taken branche and static jumps are handled
  *    by DBBCache. They are calculated once and cached on a cache miss.
  *    On cache hits, the values are not calculated but taken from the
  *    cache.
+ *  * Superblocks: If a block ending with a static jump (j/jal) is linked to
+ *    its target block and was left via this link often enough (hot), the
+ *    entries of the target block are appended directly after the jump
+ *    entry. The jump then does not switch blocks and the fast path
+ *    continues without block switch. Fusion is repeated on the appended
+ *    entries -> hot chains of blocks are formed. Cycle counts of appended
+ *    entries are rebased, so timing is not changed.
+ *  * Page-granular coherence: Each block keeps track of the pages of its
+ *    entries (virtual page, physical page and the state of the page in the
+ *    CodePageTracker). On coherence events (fence.i, sfence.vma) all blocks
+ *    get incoherent as before, but the re-validation of a block only checks
+ *    if its pages are still mapped to the same physical pages and were not
+ *    written since. A full re-fetch of the block is only necessary, if one of
+ *    its pages was re-mapped or written, or if its pages can not be tracked
+ *    (e.g. no dmi). The coherence events are logged (see coherence_log): If
+ *    all events since the last validation of a block were page-scoped
+ *    sfence.vma (rs1 != x0) of pages not used by the block, its pages are not
+ *    translated again (only the write state is checked). A page-scoped
+ *    sfence.vma covers the whole leaf page of the translation -> pages of a
+ *    block inside of a superpage are matched against the whole superpage
+ *    (the size of the leaf is tracked per page). Global sfence.vma
+ *    (also ASID-scoped, blocks are not tagged with an ASID) and fence.i still
+ *    re-translate all pages of a block.
+ *  * Block lookup (dynamic jump/trap link cache misses, block creation) is
+ *    done in a two-level radix page table (see BlockMap) instead of a hash
+ *    map. The link caches of blocks are only an accelerator on top of it.
+ *  * Bounded memory: Blocks and entries are allocated from a per-hart arena
+ *    (see DBBCacheArena). If the memory budget is reached on creation of a
+ *    new block, all blocks are released at once (generation-based flush) and
+ *    the cache is rebuilt from scratch.
+ *  * Sharing between harts (optional, see share): Harts with identical ISA
+ *    config and op map can form a share group. A new block of a hart is
+ *    filled with the entries of the block at the same pc of another hart of
+ *    the group (no fetch/decode), if the tracked pages of this block (see
+ *    Page-granular coherence) are mapped to the same physical pages for the
+ *    hart and were not written since. Links and other per-hart state are
+ *    not shared.
+ *  * Warm start (optional, see DBBCacheWarmStore): The start pc and the
+ *    instruction words of all blocks are saved at the end of a simulation.
+ *    In the next run (same images), a new block with a record is filled with
+ *    all recorded instructions at once, after they were re-validated (fetch
+ *    and compare). Only dmi (tracked) memory is pre-fetched.
+ *  * Predecode: All decodes (cache misses, re-decodes and the dummy
+ *    implementation) are done by a table-driven decoder (see Predecoder)
+ *    instead of the switch-based reference decoders.
+ *  * Breakpoints (see insert_breakpoint): Entries at breakpoint addresses
+ *    are flagged and dispatch to the fast abort label (like a terminal).
+ *    When execution reaches such an entry, the DBBCache stops before it and
+ *    signals the hit to the ISS (see abort_fetch_decode_fast), which then
+ *    handles the breakpoint in its slow path. Code between breakpoints is
+ *    executed on the fast path, also in debug mode. On insert/remove only
+ *    the entries at the address are updated in place.
+ *  * Translation (optional, see jit_enable and DBBCacheJIT): If a block was
+ *    entered often enough on the fast path (hot), the leading run of its
+ *    entries without memory accesses, control flow and csr accesses is
+ *    translated to host code once. The first entry then dispatches to the
+ *    translation label of the ISS, which executes the translated code (see
+ *    jit_exec) and continues with the first not translated entry. Cycles and
+ *    instructions are still accounted on block exit. Translations are
+ *    dropped, if an entry of them is changed (coherence, breakpoints), and
+ *    are all released at once, if the code buffer is full. The interpreter
+ *    is used for everything else (and as fallback in the medium/slow path).
+ *  * Return-address stack (see jump_dyn_ret): Each call (jump with link)
+ *    pushes the link address and the calling block to a per-hart stack.
+ *    A return (jump via ra/t0 without link) to the address on top of the
+ *    stack takes its target block from a small link cache of the calling
+ *    block (one return site per call site) instead of the dynamic jump
+ *    link cache of the returning block, which is thrashed by functions
+ *    called from many places.
+ *  * Trap return (see ret_trap): On trap entry the interrupted block and
+ *    entry are saved. If the trap returns to this entry (e.g. retry after a
+ *    page fault) or to the next one (e.g. after an interrupt or ecall),
+ *    execution continues directly in the interrupted block instead of a
+ *    lookup. Cycles and instructions of the entries before were already
+ *    accounted on trap entry and are deducted again.
+ *  * Macro-op fusion (see Fusion): If an entry is created (or changed) and
+ *    forms a common idiom (e.g. lui+addi, auipc+jalr) with the entry before,
+ *    the entry before dispatches to the handler of the pair in the ISS. The
+ *    handler executes the first operation, steps to the second entry (see
+ *    fusion_next) and jumps directly to the second operation -> one dispatch
+ *    less. Both entries are kept, so cycles, instructions and traps are the
+ *    same as without fusion. Pairs are only executed on the fast path and
+ *    never include an entry at a breakpoint.
+ *  * Cross-hart requests (see post_request): Other harts, devices (e.g.
+ *    CLINT, PLIC) and the debugger never change the execution state of a
+ *    hart directly. They set bits in an atomic per-hart request word
+ *    instead. The hart polls this word on block exits (see switch_block) and
+ *    leaves the fast path, if a request is pending. The ISS then takes and
+ *    handles the requests in its slow path. force_slow_path is only called
+ *    by the hart itself.
  */
 
 #ifndef RISCV_ISA_DBBCACHE_H
 #define RISCV_ISA_DBBCACHE_H
 
+#include <algorithm>
+#include <atomic>
 #include <climits>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "core_defs.h"
+#include "dbbcache_arena.h"
+#include "dbbcache_jit.h"
 #include "dbbcache_stats.h"
+#include "dbbcache_warm.h"
+#include "fusion.h"
 #include "instr.h"
+#include "predecode.h"
 #include "trap.h"
 #include "util/common.h"
 
@@ -102,6 +203,20 @@
 // #define DBBCACHE_STATS_ENABLED
 #undef DBBCACHE_STATS_ENABLED
 
+/*
+ * enable translation of hot blocks to host code (x86-64 hosts only)
+ * if disabled, jit_enable has no effect
+ */
+#define DBBCACHE_JIT_ENABLED
+// #undef DBBCACHE_JIT_ENABLED
+
+/*
+ * enable macro-op fusion of instruction pairs
+ * if disabled, fusion_init has no effect
+ */
+#define DBBCACHE_FUSION_ENABLED
+// #undef DBBCACHE_FUSION_ENABLED
+
 /******************************************************************************
  * END: CONFIG
  ******************************************************************************/
@@ -125,7 +240,11 @@ struct OpMapEntry {
  * BEGIN: COMMON BASE CLASS
  ******************************************************************************/
 
-template <enum Architecture arch, typename T_uxlen_t, typename T_instr_memory_if>
+/*
+ * forced_enabled: same as DBBCACHE_FORCED_ENABLED, but only for this type (e.g. for an ISS with fixed configuration,
+ * see ISS_CT_CACHES_FORCED_ENABLED in the rv32/rv64 ISS)
+ */
+template <enum Architecture arch, typename T_uxlen_t, typename T_instr_memory_if, bool forced_enabled = false>
 class DBBCacheBase_T {
    protected:
 	bool enabled = false;
@@ -136,8 +255,34 @@ class DBBCacheBase_T {
 	struct OpMapEntry *opMap = nullptr;
 	void *fast_abort_labelPtr = nullptr;
 	uint32_t mem_word = 0x0;
+	Predecoder predecoder;
+	/* max memory used for cached blocks in bytes (0 = unlimited) */
+	uint64_t memory_budget = DEFAULT_MEMORY_BUDGET;
+	std::unordered_set<T_uxlen_t> breakpoints;
+	/* execution stopped before a breakpoint (see abort_fetch_decode_fast) */
+	bool breakpoint_hit = false;
+	/* translation of hot blocks (see Translation) */
+	bool jit_enabled = false;
+	/* ISS label executing translated code (see jit_exec) */
+	void *jit_labelPtr = nullptr;
+	/* ISS labels of fused instruction pairs (indexed by Fusion::Id, nullptr -> not implemented) */
+	void *const *fusionMap = nullptr;
+	/* pending requests of other harts (bits are defined by the ISS, see post_request) */
+	std::atomic<uint32_t> requests{0};
+
+	__always_inline bool is_breakpoint(T_uxlen_t pc) const {
+		return unlikely(!breakpoints.empty()) && breakpoints.count(pc);
+	}
+
+	/* stop before the instruction at a breakpoint -> return to the ISS via the fast abort label */
+	__always_inline void *breakpoint_stop() {
+		breakpoint_hit = true;
+		return fast_abort_labelPtr;
+	}
 
    public:
+	const static uint64_t DEFAULT_MEMORY_BUDGET = 256 * 1024 * 1024;
+
 	DBBCacheBase_T() {
 		init(false, nullptr, 0, nullptr, nullptr, nullptr, 0);
 	}
@@ -147,6 +292,7 @@ class DBBCacheBase_T {
 		this->enabled = enabled;
 		this->isa_config = isa_config;
 		this->hartId = hartId;
+		predecoder.init(arch, isa_config);
 		if (isa_config != nullptr) {
 			this->has_compressed = isa_config->get_misa_extensions();
 		} else {
@@ -156,19 +302,76 @@ class DBBCacheBase_T {
 		this->opMap = opMap;
 		this->fast_abort_labelPtr = fast_abort_labelPtr;
 		this->mem_word = 0;
+		this->breakpoint_hit = false;
 	}
 
 	void enable(bool ena) {
-#ifdef LSCACHE_FORCED_ENABLED
+#ifdef DBBCACHE_FORCED_ENABLED
 		ena = true;
 #endif
-		this->enabled = ena;
+		this->enabled = ena || forced_enabled;
 	}
 	__always_inline bool is_enabled() const {
 #ifdef DBBCACHE_FORCED_ENABLED
 		return true;
 #else
-		return enabled;
+		return forced_enabled || enabled;
+#endif
+	}
+
+	void set_memory_budget(uint64_t memory_budget) {
+		this->memory_budget = memory_budget;
+	}
+	uint64_t get_memory_budget() const {
+		return memory_budget;
+	}
+
+	void insert_breakpoint(T_uxlen_t addr) {
+		breakpoints.insert(addr);
+	}
+
+	void remove_breakpoint(T_uxlen_t addr) {
+		breakpoints.erase(addr);
+	}
+
+	/*
+	 * post requests req for this hart (can be called by other harts/threads)
+	 * data written before (e.g. pending interrupt bits) is visible to the hart after take_requests
+	 */
+	void post_request(uint32_t req) {
+		requests.fetch_or(req, std::memory_order_release);
+	}
+
+	/* any requests pending? (polled on block exits and in the ISS) */
+	__always_inline bool requests_pending() const {
+		return unlikely(requests.load(std::memory_order_relaxed) != 0);
+	}
+
+	/* take all pending requests (called by the ISS of this hart) */
+	uint32_t take_requests() {
+		return requests.exchange(0, std::memory_order_acquire);
+	}
+
+	/* set the translation label of the ISS (must be called before jit_enable) */
+	void jit_init(void *jit_labelPtr) {
+		this->jit_labelPtr = jit_labelPtr;
+	}
+
+	void jit_enable(bool ena) {
+		this->jit_enabled = ena;
+	}
+	__always_inline bool jit_is_enabled() const {
+#ifdef DBBCACHE_JIT_ENABLED
+		return jit_enabled;
+#else
+		return false;
+#endif
+	}
+
+	/* set the labels of the fused instruction pairs of the ISS (see Macro-op fusion) */
+	void fusion_init(void *const fusionMap[]) {
+#ifdef DBBCACHE_FUSION_ENABLED
+		this->fusionMap = fusionMap;
 #endif
 	}
 
@@ -183,12 +386,13 @@ class DBBCacheBase_T {
  * BEGIN: DUMMY IMPLEMENTATION
  ******************************************************************************/
 
-template <enum Architecture arch, typename T_uxlen_t, typename T_instr_memory_if>
-class DBBCacheDummy_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
+template <enum Architecture arch, typename T_uxlen_t, typename T_instr_memory_if, bool forced_enabled = false>
+class DBBCacheDummy_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if, forced_enabled> {
    private:
 	T_uxlen_t pc;
 	T_uxlen_t last_pc;
 	uint64_t cycle_counter_raw = 0;
+	uint64_t instr_counter = 0;
 
 	__always_inline uint32_t fetch(T_uxlen_t &pc, Instruction &instr) {
 		try {
@@ -202,13 +406,9 @@ class DBBCacheDummy_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if
 	}
 
 	__always_inline int decode(Instruction &instr, Operation::OpId &opId) {
-		if (instr.is_compressed()) {
-			opId = instr.decode_and_expand_compressed(arch, *this->isa_config);
-			return 2;
-		} else {
-			opId = instr.decode_normal(arch, *this->isa_config);
-			return 4;
-		}
+		int len = instr.is_compressed() ? 2 : 4;
+		opId = this->predecoder.decode(instr);
+		return len;
 	}
 
 	__always_inline uint32_t fetch_decode(T_uxlen_t &pc, Instruction &instr, Operation::OpId &opId) {
@@ -228,11 +428,19 @@ class DBBCacheDummy_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if
 
 	void init(bool enabled, RV_ISA_Config *isa_config, uint64_t hartId, T_instr_memory_if *instr_mem,
 	          struct OpMapEntry opMap[], void *fast_abort_labelPtr, T_uxlen_t entrypoint) {
-		DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if>::init(enabled, isa_config, hartId, instr_mem, opMap,
-		                                                         fast_abort_labelPtr, entrypoint);
+		DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if, forced_enabled>::init(
+		    enabled, isa_config, hartId, instr_mem, opMap, fast_abort_labelPtr, entrypoint);
 		this->pc = entrypoint;
 	}
 
+	bool share(DBBCacheDummy_T &other) {
+		return false;
+	}
+
+	void set_warm_store(DBBCacheWarmStore *warm_store) {}
+
+	void warm_store_collect(DBBCacheWarmStore &warm_store) {}
+
 	__always_inline void branch_not_taken(T_uxlen_t pc) {}
 
 	__always_inline void branch_taken(int32_t pc_offset) {
@@ -259,9 +467,14 @@ class DBBCacheDummy_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if
 		return link;
 	}
 
+	__always_inline void jump_dyn_ret(T_uxlen_t pc) {
+		this->pc = pc;
+	}
+
 	__always_inline void fence_i(T_uxlen_t pc) {}
 
 	__always_inline void fence_vma(T_uxlen_t pc) {}
+	__always_inline void fence_vma(T_uxlen_t pc, T_uxlen_t vaddr) {}
 
 	__always_inline void enter_trap(T_uxlen_t pc) {
 		this->pc = pc;
@@ -281,14 +494,33 @@ class DBBCacheDummy_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if
 		return this->fast_abort_labelPtr;
 	}
 
-	__always_inline void abort_fetch_decode_fast() {}
+	/* returns true, if execution was stopped before a breakpoint (see breakpoint_stop) */
+	__always_inline bool abort_fetch_decode_fast() {
+		bool hit = this->breakpoint_hit;
+		this->breakpoint_hit = false;
+		return hit;
+	}
+
+	/* nothing is translated -> never called */
+	__always_inline void *jit_exec(void *regs) {
+		return this->fast_abort_labelPtr;
+	}
+
+	void jit_enable(bool ena) {}
+
+	/* nothing is fused -> never called */
+	__always_inline void fusion_next(Instruction &instr) {}
 
 	__always_inline void *fetch_decode(T_uxlen_t &pc, Instruction &instr) {
 		Operation::OpId opId;
+		if (unlikely(this->is_breakpoint(pc))) {
+			return this->breakpoint_stop();
+		}
 		this->last_pc = this->pc;
 		this->mem_word = fetch_decode(pc, instr, opId);
 		this->pc = pc;
 		cycle_counter_raw += this->opMap[opId].instr_time;
+		instr_counter++;
 		return this->opMap[opId].labelPtr;
 	}
 
@@ -313,6 +545,14 @@ class DBBCacheDummy_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if
 		return cycle_counter_raw;
 	}
 
+	__always_inline uint64_t get_cycle_counter_raw_accounted() {
+		return cycle_counter_raw;
+	}
+
+	__always_inline uint64_t get_instr_counter() {
+		return instr_counter;
+	}
+
 	uint32_t get_mem_word() {
 		return this->mem_word;
 	}
@@ -326,13 +566,37 @@ class DBBCacheDummy_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if
  * BEGIN: FUNCTIONAL IMPLEMENTATION
  ******************************************************************************/
 
-template <enum Architecture arch, typename T_uxlen_t, typename T_instr_memory_if>
-class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
+template <enum Architecture arch, typename T_uxlen_t, typename T_instr_memory_if, bool forced_enabled = false>
+class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if, forced_enabled> {
 	/* Configuration */
 	const static unsigned int N_ENTRIES_START = 2;
 	const static unsigned int JUMPDYNLINKCACHE_SIZE = 16;
 	const static unsigned int BRANCHLINKLIST_SIZE = 16;
 	const static unsigned int TRAPLINKCACHE_SIZE = 8;
+	/* return sites per block (a block has one call site; superblocks may have more) */
+	const static unsigned int RETLINKCACHE_SIZE = 2;
+	/* number of entries of the return-address stack (power of two) */
+	const static unsigned int RAS_SIZE = 32;
+	/* number of linked static jump exits of a block before trying to fuse the target block into it */
+	const static unsigned int SUPERBLOCK_HOT_THRESHOLD = 64;
+	/* max number of entries of a superblock (must fit in Entry::idx) */
+	const static unsigned int SUPERBLOCK_MAX_LEN = 1024;
+	/* number of fast path entries of a block before trying to translate it */
+	const static unsigned int JIT_HOT_THRESHOLD = 128;
+	/* min number of translated entries (shorter runs do not pay off the call) */
+	const static unsigned int JIT_MIN_LEN = 2;
+
+	/* max number of tracked pages per block (blocks with more pages are always re-fetched on coherence events) */
+	const static unsigned int BLOCK_PAGES_MAX = 4;
+	const static unsigned int BLOCK_PAGES_INVALID = BLOCK_PAGES_MAX + 1;
+
+	/* entry flags */
+	/* entry is a static jump, which is directly followed by the entries of its target (superblock) */
+	const static uint8_t ENTRY_FLAG_FUSED = (1 << 0);
+	/* entry is at a breakpoint (opLabelPtr is the fast abort label, see entry_set_breakpoint) */
+	const static uint8_t ENTRY_FLAG_BREAKPOINT = (1 << 1);
+	/* entry and its successor are a fused pair (opLabelPtr is the pair label, see entry_fusion_update) */
+	const static uint8_t ENTRY_FLAG_PAIR = (1 << 2);
 
 	/* instructions can 4 or 2 bytes
 	 * -> valid pc's are aligned to 2 or 4 bytes.
@@ -359,16 +623,30 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 		uint32_t mem_word;
 		int32_t instr;
 
-		uint16_t pc_increment;
+		uint8_t pc_increment;
+		uint8_t flags;
 		uint16_t idx;
 
 		__always_inline void set_terminal(const DBBCache_T &dbbcache) {
 			opLabelPtr = dbbcache.fast_abort_labelPtr;
+			flags = 0;
 		}
 		__always_inline bool is_terminal(const DBBCache_T &dbbcache) {
 			return opLabelPtr == dbbcache.fast_abort_labelPtr;
 		}
 
+		__always_inline bool is_fused() {
+			return flags & ENTRY_FLAG_FUSED;
+		}
+
+		__always_inline bool is_breakpoint() {
+			return flags & ENTRY_FLAG_BREAKPOINT;
+		}
+
+		__always_inline bool is_pair() {
+			return flags & ENTRY_FLAG_PAIR;
+		}
+
 		__always_inline void resetLink() {
 			link = nullptr;
 		}
@@ -395,7 +673,7 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 				}
 
 				if (pc_increment != 2 && pc_increment != 4) {
-					std::cerr << " Entry: Invalid pc_increment: " << pc_increment << std::endl;
+					std::cerr << " Entry: Invalid pc_increment: " << (unsigned int)pc_increment << std::endl;
 					ok = false;
 				}
 			}
@@ -413,7 +691,8 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 			} else {
 				std::cout << "false" << std::hex << ", pc: " << pc << ", mem_word: " << mem_word << ", instr: " << instr
 				          << ", opLabelPtr: " << opLabelPtr << ", link: " << link << std::dec
-				          << ", pc_increment: " << pc_increment << ", cycle_counter_raw: " << cycle_counter_raw;
+				          << ", pc_increment: " << (unsigned int)pc_increment << ", flags: " << (unsigned int)flags
+				          << ", cycle_counter_raw: " << cycle_counter_raw;
 			}
 			std::cout << std::endl;
 		}
@@ -515,6 +794,115 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 		}
 	};
 
+	/*
+	 * Map of block start addresses (pc) to blocks (two-level radix page table)
+	 *  * 1st level: direct-mapped, tagged page directory (virtual page number -> page)
+	 *    On a directory miss, the page is taken from (or created in) the hash map of all pages.
+	 *    -> The hash map is only used once per (re-)visited page and not on every block lookup.
+	 *  * 2nd level: page with one block slot per halfword (possible instruction start)
+	 * Pages are allocated lazily on the first lookup of an address in them.
+	 * Memory cost: one page (2048 slots, 16KiB on 64 bit hosts) per 4KiB page with looked up addresses, e.g. 16MiB for
+	 * 1024 code pages (4MiB of code). Pages are counted in the memory budget (see memory_usage) -> the map is released
+	 * on eviction together with the blocks.
+	 */
+	class BlockMap {
+		const static unsigned int PAGE_SHIFT = 12;
+		const static unsigned int SLOT_SHIFT = 1;
+		const static unsigned int PAGE_SLOTS = 1 << (PAGE_SHIFT - SLOT_SHIFT);
+		const static unsigned int DIR_SIZE = 1024;
+		/* page numbers are shifted addresses -> all bits set is never a valid page number */
+		const static T_uxlen_t INVALID_VPN = ((T_uxlen_t)(0 - 1));
+
+		struct Page {
+			Block *slot[PAGE_SLOTS];
+		};
+
+		struct DirEntry {
+			T_uxlen_t vpn;
+			Page *page;
+		};
+
+		DirEntry dir[DIR_SIZE];
+		std::unordered_map<T_uxlen_t, Page *> pages;
+
+		Page *dir_miss(DirEntry &d, T_uxlen_t vpn) {
+			Page *&page = pages[vpn];
+			if (page == nullptr) {
+				/* new (zeroed) page */
+				page = new Page();
+			}
+			d.vpn = vpn;
+			d.page = page;
+			return page;
+		}
+
+	   public:
+		BlockMap() {
+			dir_reset();
+		}
+
+		~BlockMap() {
+			clear();
+		}
+
+		void dir_reset() {
+			for (auto &d : dir) {
+				d.vpn = INVALID_VPN;
+				d.page = nullptr;
+			}
+		}
+
+		/*
+		 * get slot of pc (created if not existent)
+		 * a nullptr in the returned slot means, that there is no block for pc (yet)
+		 */
+		__always_inline Block *&lookup(T_uxlen_t pc) {
+			T_uxlen_t vpn = pc >> PAGE_SHIFT;
+			DirEntry &d = dir[vpn & (DIR_SIZE - 1)];
+			Page *page = likely(d.vpn == vpn) ? d.page : dir_miss(d, vpn);
+			return page->slot[(pc & ((1 << PAGE_SHIFT) - 1)) >> SLOT_SHIFT];
+		}
+
+		/* get block of pc without creating a page (nullptr, if not existent) */
+		Block *find(T_uxlen_t pc) const {
+			auto it = pages.find(pc >> PAGE_SHIFT);
+			if (it == pages.end()) {
+				return nullptr;
+			}
+			return it->second->slot[(pc & ((1 << PAGE_SHIFT) - 1)) >> SLOT_SHIFT];
+		}
+
+		/* call func for all blocks in the map */
+		template <typename T_func>
+		void for_each(T_func func) const {
+			for (const auto &it : pages) {
+				for (Block *block : it.second->slot) {
+					if (block != nullptr) {
+						func(block);
+					}
+				}
+			}
+		}
+
+		/* number of allocated pages */
+		size_t n_pages() const {
+			return pages.size();
+		}
+
+		static size_t page_size() {
+			return sizeof(Page);
+		}
+
+		/* remove all pages (blocks are not deleted) */
+		void clear() {
+			for (const auto &it : pages) {
+				delete it.second;
+			}
+			pages.clear();
+			dir_reset();
+		}
+	};
+
 	class Block {
 	   public:
 		T_uxlen_t start_addr;
@@ -524,17 +912,44 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 
 		/* cache links of dynamic jump addresses (jalr) */
 		BlockLinkCache_T<JUMPDYNLINKCACHE_SIZE> jumpDynLinkCache;
+		/* cache links of the return addresses of calls in this block (see Return-address stack) */
+		BlockLinkCache_T<RETLINKCACHE_SIZE> retLinkCache;
 
 		uint32_t coherence_cnt;
 
+		/* number of linked static jump exits (see SUPERBLOCK_HOT_THRESHOLD) */
+		uint32_t hotness;
+
+		/* translated code of the first jit_len entries (nullptr, if not translated; see jit_translate) */
+		DBBCacheJIT::Code jit_code;
+		/* label of the operation of the first entry (replaced by the translation label; see jit_exec) */
+		void *jit_opLabelPtr;
+		uint32_t jit_len;
+		/* number of fast path entries (see JIT_HOT_THRESHOLD) */
+		uint32_t jit_hotness;
+
+		/* pages of all entries (see block_page_add) */
+		struct Page {
+			T_uxlen_t vpage;
+			uint64_t ppage;
+			/* size (log2) of the leaf page of the translation (see block_pages_maybe_remapped) */
+			unsigned int page_shift;
+			const uint32_t *state_ptr;
+			uint32_t state;
+		};
+		Page pages[BLOCK_PAGES_MAX];
+		/* number of tracked pages or BLOCK_PAGES_INVALID */
+		unsigned int n_pages;
+
 		Block() : Block(0) {}
-		Block(T_uxlen_t pc, const DBBCache_T &dbbcache) {
-			init(pc, dbbcache);
+		Block(T_uxlen_t pc, const DBBCache_T &dbbcache, Entry *entries, uint32_t alloc_len) {
+			init(pc, dbbcache, entries, alloc_len);
 		}
 
-		void init(T_uxlen_t pc, const DBBCache_T &dbbcache) {
-			alloc_len = N_ENTRIES_START;
-			entries = (Entry *)malloc(alloc_len * sizeof(*entries));
+		/* entries: space for at least N_ENTRIES_START entries (owned by caller) */
+		void init(T_uxlen_t pc, const DBBCache_T &dbbcache, Entry *entries, uint32_t alloc_len) {
+			this->alloc_len = alloc_len;
+			this->entries = entries;
 			entries[0].idx = 0;
 			entries[0].pc = pc;
 			/* counter of first entry is always 0, because the next entry holds the value after execution */
@@ -543,11 +958,18 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 			start_addr = pc;
 			len = 0;
 			coherence_cnt = dbbcache.coherence_cnt;
+			hotness = 0;
+			jit_code = nullptr;
+			jit_opLabelPtr = nullptr;
+			jit_len = 0;
+			jit_hotness = 0;
+			n_pages = 0;
 			invalidate_links();
 		}
 
 		void invalidate_links() {
 			jumpDynLinkCache.reset();
+			retLinkCache.reset();
 			for (unsigned int i = 0; i < len; i++) {
 				entries[i].resetLink();
 			}
@@ -600,7 +1022,7 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 	};
 
    protected:
-	using super = DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if>;
+	using super = DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if, forced_enabled>;
 #ifdef DBBCACHE_STATS_ENABLED
 	using dbbcachestats_t = DBBCacheStats_T<DBBCache_T, JUMPDYNLINKCACHE_SIZE>;
 #else
@@ -611,22 +1033,56 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 	dbbcachestats_t stats = dbbcachestats_t(*this);
 
    private:
-	std::unordered_map<uint64_t, Block *> blockmap;
+	/* memory of blocks and their entries (except dummyBlock and fastDisableBlock) */
+	DBBCacheArena arena;
+	/* incremented, if all blocks are released (see evict) */
+	uint64_t generation = 0;
+	uint64_t evictions = 0;
+	uint64_t memory_peak = 0;
+
+	BlockMap blockmap;
+	/* harts sharing blocks with this hart (including this hart; nullptr if not shared) */
+	std::shared_ptr<std::vector<DBBCache_T *>> share_group;
+	/* records of a previous run (nullptr if not used) */
+	DBBCacheWarmStore *warm_store = nullptr;
+	/* translated code of all blocks (see Translation) */
+	DBBCacheJIT jit;
 	Block *curBlock;
-	Block dummyBlock = Block(0, *this);
+	Entry dummyBlockEntries[N_ENTRIES_START];
+	Block dummyBlock = Block(0, *this, dummyBlockEntries, N_ENTRIES_START);
 	int32_t curEntryIdx = -1;
 
 	bool slow_path = false;
-	Block fastDisableBlock = Block(0, *this);
+	Entry fastDisableBlockEntries[N_ENTRIES_START];
+	Block fastDisableBlock = Block(0, *this, fastDisableBlockEntries, N_ENTRIES_START);
 	Entry *fastEntry;
 
 	bool exception = false;
 
 	BlockLinkCache_T<TRAPLINKCACHE_SIZE> trapLinkCache;
+	/* interrupted block and index of its current entry on the last trap entry (nullptr, if none; see ret_trap) */
+	Block *trapRetBlock = nullptr;
+	int32_t trapRetEntryIdx = -1;
+
+	/* return-address stack (see Return-address stack; ring buffer, oldest entries are overwritten) */
+	struct RASEntry {
+		/* link address (INVALID_PC, if unused) */
+		T_uxlen_t pc;
+		/* block containing the call */
+		Block *block;
+	};
+	RASEntry ras[RAS_SIZE];
+	unsigned int rasTop = 0;
 
 	uint32_t coherence_cnt = 0;
+	/* virtual page of the last coherence events (index: coherence_cnt, COHERENCE_LOG_ALL: all pages) */
+	static constexpr unsigned int COHERENCE_LOG_SIZE = 16;
+	static constexpr uint64_t COHERENCE_LOG_ALL = ~(uint64_t)0;
+	uint64_t coherence_log[COHERENCE_LOG_SIZE];
 
+	/* cycles and instructions of all left blocks (see switch_block) */
 	uint64_t cycle_counter_raw = 0;
+	uint64_t instr_counter = 0;
 
 	/* consistency check */
 	bool check_fastEntry() {
@@ -682,13 +1138,9 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 
 	__always_inline int decode(Instruction &instr, Operation::OpId &opId) {
 		stats.inc_decodes();
-		if (instr.is_compressed()) {
-			opId = instr.decode_and_expand_compressed(arch, *this->isa_config);
-			return 2;
-		} else {
-			opId = instr.decode_normal(arch, *this->isa_config);
-			return 4;
-		}
+		int len = instr.is_compressed() ? 2 : 4;
+		opId = this->predecoder.decode(instr);
+		return len;
 	}
 
 	__always_inline uint32_t fetch_decode(T_uxlen_t &pc, Instruction &instr, Operation::OpId &opId) {
@@ -713,7 +1165,179 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 		(entry + 1)->cycle_counter_raw = entry->cycle_counter_raw + this->opMap[opId].instr_time;
 
 		entry->instr = instr.data();
+		entry->flags = 0;
 		entry->resetLink();
+
+		if (unlikely(this->is_breakpoint(entry->pc))) {
+			entry_set_breakpoint(entry, true);
+		}
+	}
+
+	/* label of the operation of entry (re-decoded, because opLabelPtr may be replaced; see breakpoints, translation) */
+	void *entry_op_labelPtr(Entry *entry) {
+		Instruction instr(entry->mem_word);
+		Operation::OpId opId;
+		decode(instr, opId);
+		return this->opMap[opId].labelPtr;
+	}
+
+	/* label of the pair formed by entry and its successor (nullptr, if they can not be fused; see Macro-op fusion) */
+	void *entry_fusion_labelPtr(Entry *entry) {
+		Entry *next = entry + 1;
+		/* no successor or successor at a breakpoint (both dispatch to the fast abort label) */
+		if (this->fusionMap == nullptr || next->is_terminal(*this)) {
+			return nullptr;
+		}
+		Instruction instr1(entry->mem_word);
+		Instruction instr2(next->mem_word);
+		Operation::OpId opId1 = this->predecoder.decode(instr1);
+		Operation::OpId opId2 = this->predecoder.decode(instr2);
+		return this->fusionMap[Fusion::match(opId1, instr1, opId2, instr2)];
+	}
+
+	/* dispatch the pair, if entry and its successor can be fused, otherwise the operation of entry */
+	void entry_fusion_update(Entry *entry) {
+		/* label is replaced (breakpoint, translation) -> updated on restore (see entry_restore_labelPtr) */
+		if (entry->is_breakpoint() || entry->opLabelPtr == this->jit_labelPtr) {
+			return;
+		}
+		void *labelPtr = entry_fusion_labelPtr(entry);
+		if (labelPtr != nullptr) {
+			if (!entry->is_pair()) {
+				stats.inc_pair_fusions();
+			}
+			entry->opLabelPtr = labelPtr;
+			entry->flags |= ENTRY_FLAG_PAIR;
+		} else if (entry->is_pair()) {
+			entry->opLabelPtr = entry_op_labelPtr(entry);
+			entry->flags &= ~ENTRY_FLAG_PAIR;
+		}
+	}
+
+	/* all entries of block changed (e.g. repaired) -> update all pairs */
+	void block_fusion_update(Block *block) {
+		if (this->fusionMap == nullptr) {
+			return;
+		}
+		for (unsigned int i = 0; i < block->len; i++) {
+			entry_fusion_update(&block->entries[i]);
+		}
+	}
+
+	/* restore the label of entry after it was replaced (breakpoint, translation) */
+	void entry_restore_labelPtr(Entry *entry) {
+		entry->opLabelPtr = entry_op_labelPtr(entry);
+		entry->flags &= ~ENTRY_FLAG_PAIR;
+		entry_fusion_update(entry);
+	}
+
+	/* flag entry as breakpoint (dispatch to fast abort label) or restore its operation */
+	void entry_set_breakpoint(Entry *entry, bool set) {
+		if (set) {
+			entry->opLabelPtr = this->fast_abort_labelPtr;
+			entry->flags |= ENTRY_FLAG_BREAKPOINT;
+			entry->flags &= ~ENTRY_FLAG_PAIR;
+			return;
+		}
+
+		entry->flags &= ~ENTRY_FLAG_BREAKPOINT;
+		entry_restore_labelPtr(entry);
+	}
+
+	/* update the breakpoint state of all entries of block at addr (superblocks may hold more than one) */
+	void block_update_breakpoint(Block *block, T_uxlen_t addr, bool set) {
+		for (unsigned int i = 0; i < block->len; i++) {
+			Entry *e = &block->entries[i];
+			if (e->pc == addr && e->is_breakpoint() != set) {
+				/* translated entries must stop at the breakpoint (set) or may be translated again (remove) */
+				if (i < block->jit_len || i == 0) {
+					block_jit_drop(block);
+				}
+				entry_set_breakpoint(e, set);
+				/* a pair must not include the entry at a breakpoint */
+				if (i > 0) {
+					entry_fusion_update(e - 1);
+				}
+			}
+		}
+	}
+
+	/* entry was copied from another block -> must not dispatch to its translation */
+	void entry_jit_sanitize(Entry *entry) {
+		if (entry->opLabelPtr == this->jit_labelPtr && this->jit_labelPtr != nullptr) {
+			entry_restore_labelPtr(entry);
+		}
+	}
+
+	/* count fast path entries of block and translate it, if hot (see Translation) */
+	__always_inline void jit_count(Block *block) {
+		if (unlikely(this->jit_is_enabled()) && block->jit_hotness < JIT_HOT_THRESHOLD &&
+		    ++block->jit_hotness == JIT_HOT_THRESHOLD) {
+			jit_translate(block);
+		}
+	}
+
+	/* emit the leading run of translatable entries of block -> number of emitted entries */
+	unsigned int jit_emit(Block *block) {
+		jit.begin(arch);
+		unsigned int len = 0;
+		for (; len < block->len; len++) {
+			Entry *e = &block->entries[len];
+			if (e->is_breakpoint()) {
+				break;
+			}
+			Instruction instr(e->mem_word);
+			Operation::OpId opId = this->predecoder.decode(instr);
+			if (!jit.emit(opId, instr, e->pc)) {
+				break;
+			}
+		}
+		return len;
+	}
+
+	/* translate block (coherent, not translated, entered on the fast path) */
+	__attribute__((noinline)) void jit_translate(Block *block) {
+		/* second try after release of all translations, if the code buffer is full */
+		for (unsigned int i = 0; i < 2; i++) {
+			unsigned int len = jit_emit(block);
+			if (len < JIT_MIN_LEN) {
+				jit.abort();
+				break;
+			}
+			DBBCacheJIT::Code code = jit.end();
+			if (code != nullptr) {
+				stats.inc_jit_translations();
+				block->jit_code = code;
+				block->jit_opLabelPtr = entry_op_labelPtr(&block->entries[0]);
+				block->jit_len = len;
+				block->jit_hotness = JIT_HOT_THRESHOLD;
+				block->entries[0].opLabelPtr = this->jit_labelPtr;
+				return;
+			}
+			jit_flush();
+		}
+		/* not translatable (keep jit_hotness -> not counted anymore until entries change) */
+		stats.inc_jit_rejects();
+		block->jit_hotness = JIT_HOT_THRESHOLD;
+	}
+
+	/* entries of block changed -> remove its translation (code is released on the next flush) */
+	void block_jit_drop(Block *block) {
+		if (block->jit_code != nullptr) {
+			stats.inc_jit_drops();
+			entry_restore_labelPtr(&block->entries[0]);
+			block->jit_code = nullptr;
+			block->jit_opLabelPtr = nullptr;
+			block->jit_len = 0;
+		}
+		block->jit_hotness = 0;
+	}
+
+	/* release all translations */
+	void jit_flush() {
+		stats.inc_jit_flushes();
+		blockmap.for_each([&](Block *block) { block_jit_drop(block); });
+		jit.reset();
 	}
 
 	__always_inline Entry *fetch_decode_add_entry(T_uxlen_t &pc, Instruction &instr) {
@@ -721,20 +1345,23 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 
 		/* space for entries and terminal (+1) */
 		if (idx + 1 == curBlock->alloc_len) {
-			curBlock->alloc_len *= 2;
-			curBlock->entries = (Entry *)realloc(curBlock->entries, curBlock->alloc_len * sizeof(*curBlock->entries));
+			block_entries_grow(curBlock, idx + 2);
 		}
 
 		Entry *entry = &curBlock->entries[idx];
 		fetch(pc, instr);
 		decode_update_entry(entry, pc, instr);
 		entry->idx = idx;
+		block_entry_pages_add(curBlock, entry);
 
 		/* set next as terminal */
 		(entry + 1)->idx = idx + 1;
 		(entry + 1)->set_terminal(*this);
 
 		curBlock->len++;
+		if (idx > 0) {
+			entry_fusion_update(entry - 1);
+		}
 		return entry;
 	}
 
@@ -746,8 +1373,9 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 			lastEntry = &curBlock->entries[curEntryIdx];
 		}
 
-		/* update cycles from last block */
+		/* update cycles and instructions (index after the last executed entry) from last block */
 		cycle_counter_raw += (lastEntry + 1)->cycle_counter_raw;
+		instr_counter += (lastEntry + 1)->idx;
 
 		dummyBlock.entries[0].pc = pc;
 
@@ -760,6 +1388,12 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 	}
 
 	__always_inline void switch_block(Block *block) {
+		/* block exit -> leave the fast path, if there are requests of other harts (see Cross-hart requests) */
+		if (unlikely(this->requests_pending())) {
+			stats.inc_request_exits();
+			force_slow_path();
+		}
+
 		Entry *lastEntry;
 		if (likely(in_fast_path())) {
 			lastEntry = fastEntry;
@@ -767,14 +1401,16 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 			lastEntry = &curBlock->entries[curEntryIdx];
 		}
 
-		/* update cycles from last block */
+		/* update cycles and instructions (index after the last executed entry) from last block */
 		cycle_counter_raw += (lastEntry + 1)->cycle_counter_raw;
+		instr_counter += (lastEntry + 1)->idx;
 
 		if (curBlock == block) {
 			/* we switch to the same block -> we know already that len>0 and that it is coherent -> switch directly */
 			if (likely(in_fast_path() || slow_path == false)) {
 				stats.inc_swtch_same_fast();
 				fast_path_raw_enable(&curBlock->entries[-1]);
+				jit_count(curBlock);
 			} else {
 				stats.inc_swtch_same_slow();
 				curEntryIdx = -1;
@@ -796,6 +1432,7 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 		 */
 		if (likely(slow_path == false && curBlock->len > 0 && coherence_cnt == curBlock->coherence_cnt)) {
 			fast_path_raw_enable(&curBlock->entries[-1]);
+			jit_count(curBlock);
 		} else {
 			fast_path_raw_disable();
 			curEntryIdx = -1;
@@ -803,21 +1440,187 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 		}
 	}
 
+	Block *block_new(T_uxlen_t pc) {
+		size_t size = N_ENTRIES_START * sizeof(Entry);
+		Entry *entries = (Entry *)arena.alloc_array(size);
+		return new (arena.alloc(sizeof(Block))) Block(pc, *this, entries, size / sizeof(Entry));
+	}
+
+	/* grow entries of block to (at least) min_len */
+	void block_entries_grow(Block *block, uint32_t min_len) {
+		size_t size = block->alloc_len * 2;
+		while (size < min_len) {
+			size *= 2;
+		}
+		size *= sizeof(Entry);
+		Entry *entries = (Entry *)arena.alloc_array(size);
+		memcpy(entries, block->entries, block->alloc_len * sizeof(Entry));
+		arena.free_array(block->entries, block->alloc_len * sizeof(Entry));
+		block->entries = entries;
+		block->alloc_len = size / sizeof(Entry);
+	}
+
+	/* fill new (empty) block with the entries of a valid block at the same pc of another hart in the share group */
+	void block_share_fill(Block *block) {
+		for (DBBCache_T *other : *share_group) {
+			if (other == this) {
+				continue;
+			}
+			Block *src = other->blockmap.find(block->start_addr);
+			if (src == nullptr || src->len == 0) {
+				continue;
+			}
+			/*
+			 * valid for this hart? (pages have same translation and were not written since fetch of src)
+			 * -> always re-translate: the coherence state of src (coherence_cnt) belongs to the other hart
+			 * (the pages are checked on the copy, because the re-translation updates them)
+			 */
+			memcpy(block->pages, src->pages, sizeof(block->pages));
+			block->n_pages = src->n_pages;
+			if (!block_pages_unchanged(block, true)) {
+				block->n_pages = 0;
+				continue;
+			}
+
+			/* copy entries with terminal (+1) */
+			if (src->len + 1 > block->alloc_len) {
+				block_entries_grow(block, src->len + 1);
+			}
+			memcpy(block->entries, src->entries, (src->len + 1) * sizeof(*block->entries));
+			block->len = src->len;
+			/* links point to blocks of the other hart */
+			block->invalidate_links();
+			/* translations are per hart */
+			entry_jit_sanitize(&block->entries[0]);
+			/* breakpoints are per hart */
+			for (unsigned int i = 0; i < block->len; i++) {
+				Entry *e = &block->entries[i];
+				if (e->is_breakpoint() != this->is_breakpoint(e->pc)) {
+					entry_set_breakpoint(e, !e->is_breakpoint());
+					if (i > 0) {
+						entry_fusion_update(e - 1);
+					}
+				}
+			}
+
+			stats.inc_share_fills();
+			return;
+		}
+	}
+
+	/* fill new (empty) block with the re-validated instructions recorded in a previous run (see warm_store) */
+	void block_warm_fill(Block *block) {
+		const std::vector<uint32_t> *words = warm_store->find(block->start_addr);
+		if (words == nullptr) {
+			return;
+		}
+
+		T_uxlen_t pc = block->start_addr;
+		for (uint32_t word : *words) {
+			unsigned int len = ((word & 0b11) == 0b11) ? 4 : 2;
+			uint32_t mask = (len == 4) ? 0xffffffff : 0xffff;
+
+			/* pre-fetch only from trackable (dmi) memory -> no side effects */
+			block_page_add(block, pc);
+			block_page_add(block, pc + len - 1);
+			if (block->n_pages == BLOCK_PAGES_INVALID) {
+				break;
+			}
+
+			/* re-validate */
+			uint32_t mem_word;
+			try {
+				mem_word = fetch_raw(pc);
+			} catch (SimulationTrap &e) {
+				break;
+			}
+			if ((mem_word & mask) != (word & mask)) {
+				break;
+			}
+
+			/* space for entries and terminal (+1) */
+			unsigned int idx = block->len;
+			if (idx + 1 == block->alloc_len) {
+				block_entries_grow(block, idx + 2);
+			}
+			Entry *entry = &block->entries[idx];
+			Instruction instr(mem_word);
+			decode_update_entry(entry, pc, instr);
+			entry->idx = idx;
+			(entry + 1)->idx = idx + 1;
+			(entry + 1)->set_terminal(*this);
+			block->len++;
+			if (idx > 0) {
+				entry_fusion_update(entry - 1);
+			}
+		}
+
+		if (block->len > 0) {
+			stats.inc_warm_fills();
+		}
+	}
+
+	uint64_t memory_usage() const {
+		return arena.get_size() + blockmap.n_pages() * BlockMap::page_size();
+	}
+
+	__always_inline bool memory_budget_reached() {
+		uint64_t usage = memory_usage();
+		if (usage > memory_peak) {
+			memory_peak = usage;
+		}
+		return this->memory_budget != 0 && usage >= this->memory_budget;
+	}
+
+	/*
+	 * Memory budget reached -> release all blocks (generation-based flush)
+	 * Blocks referenced before (e.g. lastBlock in callers of find_create_switch_block) are no longer valid after
+	 * this call (see generation).
+	 */
+	__attribute__((noinline)) void evict(T_uxlen_t pc) {
+		evictions++;
+
+		/* leave current block (cycles are accounted) -> dummyBlock */
+		switch_block_dummy(pc);
+
+		blockmap.clear();
+		stats.map_clear();
+		arena.reset();
+		jit.reset();
+		generation++;
+
+		/* remove all remaining references to released blocks */
+		dummyBlock.invalidate_links();
+		trapLinkCache.reset();
+		trapRetBlock = nullptr;
+		ras_reset();
+	}
+
 	__always_inline void find_create_switch_block(T_uxlen_t pc) {
 		stats.inc_map_search();
-		Block *block = nullptr;
-		auto it = blockmap.find(pc);
-		if (it != blockmap.end()) {
+		auto lookup_start = stats.map_lookup_begin();
+		Block **slot = &blockmap.lookup(pc);
+		stats.map_lookup_end(lookup_start, pc);
+		if (likely(*slot != nullptr)) {
 			/* found */
 			stats.inc_map_found();
-			block = it->second;
 		} else {
 			/* not found -> new */
+			if (unlikely(memory_budget_reached())) {
+				evict(pc);
+				/* the map was cleared -> get new slot */
+				slot = &blockmap.lookup(pc);
+			}
 			stats.inc_blocks();
-			block = new Block(pc, *this);
-			blockmap[pc] = block;
+			*slot = block_new(pc);
+			if (share_group != nullptr) {
+				block_share_fill(*slot);
+			}
+			if (warm_store != nullptr && (*slot)->len == 0) {
+				block_warm_fill(*slot);
+			}
 		}
-		switch_block(block);
+		switch_block(*slot);
 	}
 
 	__always_inline void branch_taken_sjump(int32_t pc_offset) {
@@ -852,8 +1655,9 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 		if (likely(this->is_enabled())) {
 			Block *lastBlock = curBlock;
 			int lastEntryIdx = curEntryIdx;
+			uint64_t lastGeneration = generation;
 			find_create_switch_block(pc);
-			if (lastBlock != &dummyBlock) {
+			if (lastBlock != &dummyBlock && lastGeneration == generation) {
 				lastBlock->entries[lastEntryIdx].setLinkBlock(curBlock);
 			}
 		} else {
@@ -861,11 +1665,271 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 		}
 	}
 
-	__always_inline void coherence_update() {
+	/* add page containing vaddr to the tracked pages of block */
+	void block_page_add(Block *block, T_uxlen_t vaddr) {
+		if (block->n_pages == BLOCK_PAGES_INVALID) {
+			return;
+		}
+
+		T_uxlen_t vpage = vaddr & ~((T_uxlen_t)0xFFF);
+		for (unsigned int i = 0; i < block->n_pages; i++) {
+			if (block->pages[i].vpage == vpage) {
+				return;
+			}
+		}
+
+		if (block->n_pages == BLOCK_PAGES_MAX) {
+			stats.inc_page_track_fails();
+			block->n_pages = BLOCK_PAGES_INVALID;
+			return;
+		}
+
+		uint64_t paddr = 0;
+		unsigned int page_shift = 12;
+		const uint32_t *state_ptr = nullptr;
+		try {
+			state_ptr = this->instr_mem->track_code_page(vpage, paddr, page_shift);
+		} catch (SimulationTrap &e) {
+			state_ptr = nullptr;
+		}
+		if (state_ptr == nullptr) {
+			/* page can not be tracked */
+			stats.inc_page_track_fails();
+			block->n_pages = BLOCK_PAGES_INVALID;
+			return;
+		}
+
+		typename Block::Page &page = block->pages[block->n_pages];
+		page.vpage = vpage;
+		page.ppage = paddr & ~((uint64_t)0xFFF);
+		page.page_shift = page_shift;
+		page.state_ptr = state_ptr;
+		page.state = *state_ptr;
+		block->n_pages++;
+	}
+
+	__always_inline void block_entry_pages_add(Block *block, Entry *entry) {
+		block_page_add(block, entry->pc);
+		/* instruction may cross a page boundary */
+		block_page_add(block, entry->pc + entry->pc_increment - 1);
+	}
+
+	/* rebuild tracked pages of block (after re-fetch) */
+	void block_pages_rebuild(Block *block) {
+		block->n_pages = 0;
+		for (unsigned int idx = 0; idx < block->len; idx++) {
+			block_entry_pages_add(block, &block->entries[idx]);
+		}
+	}
+
+	/*
+	 * check, if a page of the block may be mapped to another physical page since the last validation of the block
+	 * (see coherence_log)
+	 * A page-scoped sfence.vma invalidates the translation of the whole leaf page containing its address -> all pages of
+	 * the block inside of the same leaf (e.g. megapage) are affected
+	 */
+	bool block_pages_maybe_remapped(Block *block) {
+		uint32_t n = coherence_cnt - block->coherence_cnt;
+		if (n > COHERENCE_LOG_SIZE) {
+			return true;
+		}
+		for (uint32_t cnt = block->coherence_cnt + 1; n > 0; cnt++, n--) {
+			uint64_t vpage = coherence_log[cnt % COHERENCE_LOG_SIZE];
+			if (vpage == COHERENCE_LOG_ALL) {
+				return true;
+			}
+			for (unsigned int i = 0; i < block->n_pages; i++) {
+				typename Block::Page &page = block->pages[i];
+				if ((((uint64_t)page.vpage ^ vpage) >> page.page_shift) == 0) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	/*
+	 * check, if all pages of the block are still mapped to the same physical pages and were not written since they
+	 * were added to the block
+	 * translate: always re-translate the pages (e.g. pages of another hart, see block_share_fill)
+	 */
+	bool block_pages_unchanged(Block *block, bool translate = false) {
+		if (block->n_pages == 0 || block->n_pages == BLOCK_PAGES_INVALID) {
+			return false;
+		}
+
+		bool remapped = translate || block_pages_maybe_remapped(block);
+		if (!remapped) {
+			stats.inc_page_translate_skips();
+		}
+
+		try {
+			for (unsigned int i = 0; i < block->n_pages; i++) {
+				typename Block::Page &page = block->pages[i];
+				if (*page.state_ptr != page.state) {
+					return false;
+				}
+				if (remapped) {
+					/* re-translate (the size of the leaf may have changed too -> see block_pages_maybe_remapped) */
+					uint64_t paddr = 0;
+					if (this->instr_mem->track_code_page(page.vpage, paddr, page.page_shift) == nullptr ||
+					    (paddr & ~((uint64_t)0xFFF)) != page.ppage) {
+						return false;
+					}
+				}
+			}
+		} catch (SimulationTrap &e) {
+			/* not mapped anymore -> handled by re-fetch */
+			return false;
+		}
+
+		return true;
+	}
+
+	/*
+	 * Try to append the entries of the target block of the static jump in jumpEntry to the current block.
+	 * Returns true, if the jump was fused (the target entries follow the jump entry -> no block switch required)
+	 */
+	bool superblock_fuse(Entry *jumpEntry) {
+		Block *block = curBlock;
+		Block *target = jumpEntry->getLinkBlock();
+		unsigned int jumpIdx = jumpEntry->idx;
+
+		/* only coherent blocks can be fused; the jump must be the last entry; no self loops */
+		if (target == block || jumpIdx + 1 != block->len || target->len == 0 || block->coherence_cnt != coherence_cnt ||
+		    target->coherence_cnt != coherence_cnt || block->len + target->len > SUPERBLOCK_MAX_LEN) {
+			stats.inc_superblock_rejects();
+			return false;
+		}
+
+		stats.inc_superblock_fusions();
+
+		unsigned int len = block->len + target->len;
+
+		/* space for entries and terminal (+1) */
+		if (len + 1 > block->alloc_len) {
+			block_entries_grow(block, len + 1);
+		}
+
+		/* cycles after the jump (held by the current terminal) are the base for the appended entries */
+		Entry *dst = &block->entries[block->len];
+		uint32_t cycle_base = dst->cycle_counter_raw;
+
+		/* copy entries with terminal (+1) and rebase index and cycles */
+		memcpy(dst, target->entries, (target->len + 1) * sizeof(*dst));
+		for (unsigned int i = 0; i < target->len + 1; i++) {
+			dst[i].idx = block->len + i;
+			dst[i].cycle_counter_raw += cycle_base;
+		}
+		/* the translation of target is only executed on entry of target */
+		entry_jit_sanitize(&dst[0]);
+
+		block->entries[jumpIdx].flags |= ENTRY_FLAG_FUSED;
+		block->len = len;
+
+		/* merge tracked pages */
+		if (target->n_pages == BLOCK_PAGES_INVALID) {
+			block->n_pages = BLOCK_PAGES_INVALID;
+		}
+		for (unsigned int i = 0; i < target->n_pages && block->n_pages != BLOCK_PAGES_INVALID; i++) {
+			typename Block::Page &page = target->pages[i];
+			bool found = false;
+			for (unsigned int j = 0; j < block->n_pages; j++) {
+				if (block->pages[j].vpage == page.vpage) {
+					found = true;
+					if (block->pages[j].ppage != page.ppage || block->pages[j].state != page.state) {
+						/* different views -> not trackable */
+						block->n_pages = BLOCK_PAGES_INVALID;
+					}
+					break;
+				}
+			}
+			if (!found) {
+				if (block->n_pages == BLOCK_PAGES_MAX) {
+					block->n_pages = BLOCK_PAGES_INVALID;
+				} else {
+					block->pages[block->n_pages++] = page;
+				}
+			}
+		}
+
+		/* entries may be moved (block_entries_grow) -> update fast path */
+		if (likely(in_fast_path())) {
+			fast_path_raw_enable(&block->entries[jumpIdx]);
+		}
+
+		return true;
+	}
+
+	/*
+	 * The fused jump at idx (or an entry before it) is no longer valid
+	 * -> cut the superblock after the jump and remove the fused flag
+	 */
+	void superblock_cut(unsigned int idx) {
+		stats.inc_superblock_cuts();
+		Entry *jumpEntry = &curBlock->entries[idx];
+		jumpEntry->flags &= ~ENTRY_FLAG_FUSED;
+		curBlock->len = idx + 1;
+		/* keep cycle_counter_raw (value after the jump) */
+		(jumpEntry + 1)->set_terminal(*this);
+	}
+
+	/*
+	 * The superblock was cut (see superblock_cut) after the position of the current execution
+	 * -> account cycles and instructions executed so far and continue execution at pc in the corresponding block
+	 */
+	__attribute__((noinline)) void *superblock_leave(T_uxlen_t &pc, Instruction &instr, uint32_t cycles,
+	                                                 unsigned int ninstr) {
+		cycle_counter_raw += cycles;
+		instr_counter += ninstr;
+		/* start of curBlock -> no further cycles/instructions are added on switch */
+		curEntryIdx = -1;
+		if (likely(this->is_enabled())) {
+			find_create_switch_block(pc);
+		} else {
+			switch_block_dummy(pc);
+		}
+		return fetch_decode(pc, instr);
+	}
+
+	__always_inline void ras_push(T_uxlen_t link) {
+		rasTop = (rasTop + 1) & (RAS_SIZE - 1);
+		ras[rasTop].pc = link;
+		ras[rasTop].block = curBlock;
+	}
+
+	/* remove all references to blocks */
+	void ras_reset() {
+		for (unsigned int i = 0; i < RAS_SIZE; i++) {
+			ras[i].pc = INVALID_PC;
+		}
+		rasTop = 0;
+	}
+
+	/* switch to block and continue at entry idx (see Trap return) */
+	void block_resume(Block *block, uint32_t idx) {
+		stats.inc_trap_ret_hits();
+		switch_block(block);
+
+		/* cycles and instructions of the entries before idx were accounted on trap entry */
+		cycle_counter_raw -= block->entries[idx].cycle_counter_raw;
+		instr_counter -= block->entries[idx].idx;
+
+		/* continue at idx (see switch_block for fast or slow start) */
+		if (likely(in_fast_path())) {
+			fast_path_raw_enable(&block->entries[(int32_t)idx - 1]);
+		} else {
+			curEntryIdx = (int32_t)idx - 1;
+		}
+	}
+
+	/* vpage: virtual page with changed mapping or COHERENCE_LOG_ALL (see coherence_log) */
+	__always_inline void coherence_update(uint64_t vpage = COHERENCE_LOG_ALL) {
 		stats.inc_coherence_updates();
 
 		// TODO: handle counters before overflow!
 		coherence_cnt++;
+		coherence_log[coherence_cnt % COHERENCE_LOG_SIZE] = vpage;
 
 		/* stop fast execution, if enabled */
 		if (likely((in_fast_path()))) {
@@ -891,22 +1955,30 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 
 	void init(bool enabled, RV_ISA_Config *isa_config, uint64_t hartId, T_instr_memory_if *instr_mem,
 	          struct OpMapEntry opMap[], void *fast_abort_labelPtr, T_uxlen_t entrypoint) {
-		DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if>::init(enabled, isa_config, hartId, instr_mem, opMap,
-		                                                         fast_abort_labelPtr, entrypoint);
+		DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if, forced_enabled>::init(
+		    enabled, isa_config, hartId, instr_mem, opMap, fast_abort_labelPtr, entrypoint);
 
 		/* set abort label ptr and reinit blocks to have valid terminal entries */
 		this->fast_abort_labelPtr = fast_abort_labelPtr;
-		dummyBlock.init(0, *this);
-		fastDisableBlock.init(0, *this);
+		dummyBlock.init(0, *this, dummyBlockEntries, N_ENTRIES_START);
+		dummyBlock.entries[1].idx = 0;
+		dummyBlock.entries[1].cycle_counter_raw = 0;
+		fastDisableBlock.init(0, *this, fastDisableBlockEntries, N_ENTRIES_START);
 
 		coherence_cnt = 0;
+		std::fill(std::begin(coherence_log), std::end(coherence_log), COHERENCE_LOG_ALL);
+		cycle_counter_raw = 0;
+		instr_counter = 0;
 
-		for (const auto &it : blockmap) {
-			delete it.second;
-		}
-
+		/* release all blocks */
 		blockmap.clear();
+		stats.map_clear();
+		arena.reset();
+		jit.reset();
+		generation++;
 		trapLinkCache.reset();
+		trapRetBlock = nullptr;
+		ras_reset();
 		exception = false;
 
 		/* use dummyBlock (and its first entry) as valid predecessor */
@@ -951,11 +2023,109 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 		curBlock->invalidate_links();
 		/* ensure, that we not switch from the dummyBlock to a real block on a dyn call */
 		dummyBlock.invalidate_links();
-		/* ensure, that we not switch to real block on a trap */
+		/* ensure, that we not switch to real block on a trap or a trap return */
 		trapLinkCache.reset();
+		trapRetBlock = nullptr;
+		/* ensure, that we not switch to real block on a return */
+		ras_reset();
+	}
+
+	void jit_enable(bool ena) {
+#ifdef DBBCACHE_JIT_ENABLED
+		bool available = this->jit_labelPtr != nullptr && jit.is_available();
+#else
+		bool available = false;
+#endif
+		if (ena && !available) {
+			std::cerr << "[DBBCache] Warning: translation not available (host or build configuration) -> disabled"
+			          << std::endl;
+			ena = false;
+		}
+		if (!ena && this->jit_is_enabled()) {
+			/* cached blocks are kept, only their translations are released */
+			jit_flush();
+		}
+		super::jit_enable(ena);
+	}
+
+	/*
+	 * share blocks with other (and all harts already sharing with other)
+	 * only possible with identical isa config, op map (labels, instruction timing) and pair labels
+	 * returns false, if not possible
+	 */
+	bool share(DBBCache_T &other) {
+		if (this->isa_config == nullptr || other.isa_config == nullptr ||
+		    this->isa_config->cfg != other.isa_config->cfg || this->fast_abort_labelPtr != other.fast_abort_labelPtr) {
+			return false;
+		}
+		for (unsigned int opId = 0; opId < Operation::OpId::NUMBER_OF_OPERATIONS; opId++) {
+			if (this->opMap[opId].labelPtr != other.opMap[opId].labelPtr ||
+			    this->opMap[opId].instr_time != other.opMap[opId].instr_time) {
+				return false;
+			}
+		}
+		if (this->fusionMap != other.fusionMap) {
+			for (unsigned int id = 0; id < Fusion::NUMBER_OF_FUSIONS; id++) {
+				if (this->fusionMap == nullptr || other.fusionMap == nullptr ||
+				    this->fusionMap[id] != other.fusionMap[id]) {
+					return false;
+				}
+			}
+		}
+
+		if (other.share_group == nullptr) {
+			other.share_group = std::make_shared<std::vector<DBBCache_T *>>();
+			other.share_group->push_back(&other);
+		}
+		share_group = other.share_group;
+		share_group->push_back(this);
+		return true;
+	}
+
+	/* use records of a previous run for new blocks */
+	void set_warm_store(DBBCacheWarmStore *warm_store) {
+		this->warm_store = warm_store;
+	}
+
+	/* record all blocks (only the sequential part of superblocks) */
+	void warm_store_collect(DBBCacheWarmStore &warm_store) {
+		std::vector<uint32_t> words;
+		blockmap.for_each([&](Block *block) {
+			words.clear();
+			/* blocks have no max length -> record the first BLOCK_WORDS_MAX words (see DBBCacheWarmStore) */
+			for (unsigned int idx = 0; idx < block->len && words.size() < DBBCacheWarmStore::BLOCK_WORDS_MAX; idx++) {
+				words.push_back(block->entries[idx].mem_word);
+				if (block->entries[idx].is_fused()) {
+					break;
+				}
+			}
+			if (!words.empty()) {
+				warm_store.add(block->start_addr, words);
+			}
+		});
+	}
+
+	/* stop execution before addr (see Breakpoints above) */
+	void insert_breakpoint(T_uxlen_t addr) {
+		DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if, forced_enabled>::insert_breakpoint(addr);
+		blockmap.for_each([&](Block *block) { block_update_breakpoint(block, addr, true); });
+	}
+
+	void remove_breakpoint(T_uxlen_t addr) {
+		DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if, forced_enabled>::remove_breakpoint(addr);
+		blockmap.for_each([&](Block *block) { block_update_breakpoint(block, addr, false); });
 	}
 
 	void print_stats() {
+		if (this->is_enabled()) {
+			std::cout << "DBBCache (hartId: " << this->hartId << "): memory: " << memory_usage() / 1024
+			          << " KiB, peak: " << memory_peak / 1024 << " KiB, budget: " << this->memory_budget / 1024
+			          << " KiB, evictions: " << evictions;
+			if (this->jit_is_enabled()) {
+				std::cout << ", translated code: " << jit.get_size() / 1024 << " KiB";
+			}
+			std::cout << std::endl;
+		}
 		stats.print();
 	}
 
@@ -970,6 +2140,28 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 
 	__always_inline void jump(int32_t pc_offset) {
 		stats.inc_sjumps();
+
+		Entry *e;
+		if (likely(in_fast_path())) {
+			e = fastEntry;
+		} else {
+			e = &curBlock->entries[curEntryIdx];
+		}
+
+		/* superblock: target entries directly follow -> nothing to do */
+		if (e->is_fused()) {
+			stats.inc_superblock_jumps();
+			return;
+		}
+
+		/* linked and hot -> try to fuse the target */
+		if (curBlock != &dummyBlock && e->linkValid() && unlikely(++curBlock->hotness >= SUPERBLOCK_HOT_THRESHOLD)) {
+			curBlock->hotness = 0;
+			if (superblock_fuse(e)) {
+				return;
+			}
+		}
+
 		branch_taken_sjump(pc_offset);
 	}
 
@@ -982,6 +2174,7 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 			e = &curBlock->entries[curEntryIdx];
 		}
 		T_uxlen_t link = e->pc + e->pc_increment;
+		ras_push(link);
 
 		/* reuse jump */
 		jump(pc_offset);
@@ -1001,8 +2194,11 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 
 		if (likely(this->is_enabled())) {
 			Block *lastBlock = curBlock;
+			uint64_t lastGeneration = generation;
 			find_create_switch_block(pc);
-			lastBlock->jumpDynLinkCache.add(pc, curBlock);
+			if (lastGeneration == generation) {
+				lastBlock->jumpDynLinkCache.add(pc, curBlock);
+			}
 		} else {
 			switch_block_dummy(pc);
 		}
@@ -1017,6 +2213,7 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 			e = &curBlock->entries[curEntryIdx];
 		}
 		T_uxlen_t link = e->pc + e->pc_increment;
+		ras_push(link);
 
 		/* reuse jump_dyn */
 		jump_dyn(pc);
@@ -1024,6 +2221,41 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 		return link;
 	}
 
+	/* dynamic jump without link via a link register (return, see Return-address stack) */
+	__always_inline void jump_dyn_ret(T_uxlen_t pc) {
+		stats.inc_ras_rets();
+
+		RASEntry &top = ras[rasTop];
+		if (unlikely(top.pc != pc)) {
+			/* not predicted (e.g. longjmp, stack overflow, no return) -> stack is kept */
+			jump_dyn(pc);
+			return;
+		}
+
+		/* predicted -> pop */
+		stats.inc_ras_hits();
+		Block *callBlock = top.block;
+		top.pc = INVALID_PC;
+		rasTop = (rasTop - 1) & (RAS_SIZE - 1);
+
+		Block *linkBlock = callBlock->retLinkCache.find(pc);
+		if (likely(linkBlock != nullptr)) {
+			stats.inc_ras_link_hits();
+			switch_block(linkBlock);
+			return;
+		}
+
+		if (likely(this->is_enabled())) {
+			uint64_t lastGeneration = generation;
+			find_create_switch_block(pc);
+			if (lastGeneration == generation) {
+				callBlock->retLinkCache.add(pc, curBlock);
+			}
+		} else {
+			switch_block_dummy(pc);
+		}
+	}
+
 	__always_inline T_uxlen_t get_curBlock_start_addr() {
 		return curBlock->start_addr;
 	}
@@ -1036,10 +2268,27 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 		coherence_update();
 	}
 
+	/* page-scoped sfence.vma (rs1 != x0) -> only blocks using the page of vaddr have to re-translate their pages */
+	__always_inline void fence_vma([[maybe_unused]] T_uxlen_t pc, T_uxlen_t vaddr) {
+		coherence_update(vaddr & ~((T_uxlen_t)0xFFF));
+	}
+
 	__always_inline void enter_trap(T_uxlen_t pc) {
-		// TODO maybe stack push (curBlock, CurEntryIdx?)
 		stats.inc_trap_enters();
 
+		/* save interrupted position (see ret_trap; nested traps overwrite it) */
+		if (curBlock != &dummyBlock) {
+			trapRetBlock = curBlock;
+			if (likely(in_fast_path())) {
+				/* see force_slow_path */
+				trapRetEntryIdx = (fastEntry == &curBlock->entries[-1]) ? -1 : fastEntry->idx;
+			} else {
+				trapRetEntryIdx = curEntryIdx;
+			}
+		} else {
+			trapRetBlock = nullptr;
+		}
+
 		Block *linkBlock = trapLinkCache.find(pc);
 		if (likely(linkBlock != nullptr)) {
 			stats.inc_trap_enter_hits();
@@ -1057,7 +2306,22 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 
 	__always_inline void ret_trap(T_uxlen_t pc) {
 		stats.inc_trap_rets();
-		// TODO maybe stack restore
+
+		Block *block = trapRetBlock;
+		trapRetBlock = nullptr;
+		if (likely(block != nullptr && this->is_enabled())) {
+			/* return to the interrupted entry (retry) or to the next one */
+			int32_t idx = trapRetEntryIdx;
+			if (idx >= 0 && (uint32_t)idx < block->len && block->entries[idx].pc == pc) {
+				block_resume(block, idx);
+				return;
+			}
+			if ((uint32_t)(idx + 1) < block->len && block->entries[idx + 1].pc == pc) {
+				block_resume(block, idx + 1);
+				return;
+			}
+		}
+
 		switch_block_dummy(pc);
 	}
 
@@ -1071,9 +2335,10 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 
 		/*
 		 * Restore curEntryIdx from fastEntry
-		 * This function is called by other harts too. It can therefore be called in any state:
+		 * This function is only called by this hart (other harts post requests, see Cross-hart requests), but
+		 * before or after callbacks:
 		 *  * After fetch_decode and before any callback -> fastEntry points to current entry
-		 *  * After fetch_decode and a callback -> fastEntry might point to its block start value
+		 *  * After fetch_decode and a callback (e.g. block switch) -> fastEntry might point to its block start value
 		 * (curBlock->entries[-1])! We have to consider both cases!
 		 */
 		if (unlikely(fastEntry == &curBlock->entries[-1])) {
@@ -1103,12 +2368,65 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 		return fastEntry->opLabelPtr;
 	}
 
-	__always_inline void abort_fetch_decode_fast() {
+	/*
+	 * called by the handler of a fused pair (see Macro-op fusion) after the first operation (fast path only)
+	 * -> instr is the second instruction of the pair, which is then executed directly by the ISS
+	 */
+	__always_inline void fusion_next(Instruction &instr) {
+		stats.inc_cnt();
+		stats.inc_pair_hit();
+
+		fastEntry++;
+		instr = Instruction(fastEntry->instr);
+	}
+
+	/* returns true, if execution was stopped before a breakpoint (see breakpoint_stop) */
+	__always_inline bool abort_fetch_decode_fast() {
 		/* revert to state before fetch_decode_fast */
 		fastEntry--;
 
 		stats.dec_cnt();
 		stats.inc_fast_abort();
+
+		if (unlikely(this->breakpoint_hit)) {
+			this->breakpoint_hit = false;
+			return true;
+		}
+		return false;
+	}
+
+	/*
+	 * stop before the instruction at a breakpoint (called in the slow path of fetch_decode, before any state is
+	 * changed) -> the fast abort label is dispatched, which reverts fastEntry to the disabled fast path
+	 */
+	__always_inline void *breakpoint_stop() {
+		fastEntry = &fastDisableBlock.entries[1];
+		return DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if, forced_enabled>::breakpoint_stop();
+	}
+
+	/*
+	 * called on dispatch of the translation label (first entry of a translated block, see Translation)
+	 *  * fast path: execute the translated entries on regs (register file of the ISS) -> returns nullptr; the ISS
+	 *    continues with the next entry (fastEntry points to the last translated entry)
+	 *  * otherwise (e.g. slow path with trace): returns the label of the operation of the entry (cached on
+	 *    translation; only the first entry of a translated block dispatches to the translation label)
+	 */
+	__always_inline void *jit_exec(void *regs) {
+		Entry *entry;
+		if (likely(in_fast_path())) {
+			if (likely(fastEntry == &curBlock->entries[0] && curBlock->jit_code != nullptr)) {
+				curBlock->jit_code(regs);
+				fastEntry = &curBlock->entries[curBlock->jit_len - 1];
+				return nullptr;
+			}
+			entry = fastEntry;
+		} else {
+			entry = &curBlock->entries[curEntryIdx];
+		}
+		if (likely(entry == &curBlock->entries[0] && curBlock->jit_code != nullptr)) {
+			return curBlock->jit_opLabelPtr;
+		}
+		return entry_op_labelPtr(entry);
 	}
 
 	__always_inline void *fetch_decode(T_uxlen_t &pc, Instruction &instr) {
@@ -1145,6 +2463,9 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 
 		/* ignore cache, if cache is disabled or if we are after return from interrupt to random position */
 		if (unlikely(curBlock == &dummyBlock)) {
+			if (unlikely(this->is_breakpoint(pc))) {
+				return breakpoint_stop();
+			}
 			Operation::OpId opId = Operation::OpId::UNDEF;
 			stats.inc_cache_ignored_instr();
 			/* all tracked data is stored in first entry */
@@ -1158,6 +2479,8 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 
 			/* update block cycle counter -> see comments in decode_update_entry above */
 			dummyBlock.entries[1].cycle_counter_raw += this->opMap[opId].instr_time;
+			/* instructions are counted directly (dummyBlock.entries[1].idx is always 0, see init) */
+			instr_counter++;
 
 			return this->opMap[opId].labelPtr;
 		}
@@ -1173,6 +2496,9 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 		if (unlikely(nextEntryIdx >= curBlock->len)) {
 			/* miss -> add new entry to current block */
 			Entry *e = fetch_decode_add_entry(pc, instr);
+			if (unlikely(e->is_breakpoint())) {
+				return breakpoint_stop();
+			}
 			curEntryIdx = nextEntryIdx;
 			return e->opLabelPtr;
 		}
@@ -1180,81 +2506,135 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 		/* hit -> use existing entry */
 
 		Entry *curEntry = &curBlock->entries[nextEntryIdx];
+		if (unlikely(curEntry->is_breakpoint())) {
+			return breakpoint_stop();
+		}
 
 		if (curBlock->coherence_cnt != coherence_cnt) {
-			/* check and repair whole block at once */
-			bool invalidate_links_once = true;
-			unsigned int idx = 0;
-			try {
-				exception = false;
-				T_uxlen_t addr = curBlock->start_addr;
-				for (idx = 0; idx < curBlock->len; idx++) {
-					Entry *e = &curBlock->entries[idx];
+			stats.inc_page_checks();
+			if (likely(block_pages_unchanged(curBlock))) {
+				/* pages neither re-mapped nor written -> block is still valid -> no re-fetch necessary */
+				stats.inc_page_check_hits();
+				curBlock->coherence_cnt = coherence_cnt;
+			} else {
+				/* check and repair whole block at once */
+				bool invalidate_links_once = true;
+				unsigned int idx = 0;
+				/* cycles and instructions executed so far in this block (needed, if the superblock is cut before the
+				 * current entry) */
+				uint32_t cycles = curEntry->cycle_counter_raw;
+				unsigned int ninstr = curEntry->idx;
+				try {
+					exception = false;
+					T_uxlen_t addr = curBlock->start_addr;
+					for (idx = 0; idx < curBlock->len; idx++) {
+						Entry *e = &curBlock->entries[idx];
+
+						/* fetch and check -> decode only if read word differs */
+
+						stats.inc_refetches();
+						uint32_t mem_word = fetch_raw(addr);
+
+						if (unlikely(mem_word != e->mem_word)) {
+							/* repair */
+							stats.inc_redecodes();
+
+							/* block content changed -> invalidate links */
+							if (invalidate_links_once) {
+								curBlock->invalidate_links();
+								block_jit_drop(curBlock);
+								invalidate_links_once = false;
+
+								/*
+								 * superblock: the target of the next fused jump may change too (pc relative)
+								 * -> cut after this jump
+								 */
+								for (unsigned int i = idx; i < curBlock->len; i++) {
+									if (curBlock->entries[i].is_fused()) {
+										superblock_cut(i);
+										break;
+									}
+								}
+							}
+
+							instr = Instruction(mem_word);
+
+							decode_update_entry(e, addr, instr);
+						} else {
+							addr += e->pc_increment;
+
+							/* superblock: continue with the entries of the fused target */
+							if (e->is_fused()) {
+								addr = (e + 1)->pc;
+							}
+						}
+					}
 
-					/* fetch and check -> decode only if read word differs */
+					/* success -> block is now coherent */
+					curBlock->coherence_cnt = coherence_cnt;
+					block_pages_rebuild(curBlock);
+					/* entries repaired -> pairs may have changed */
+					if (!invalidate_links_once) {
+						block_fusion_update(curBlock);
+					}
 
-					stats.inc_refetches();
-					uint32_t mem_word = fetch_raw(addr);
+					/* superblock was cut before the current entry -> leave */
+					if (unlikely(nextEntryIdx >= curBlock->len)) {
+						return superblock_leave(pc, instr, cycles, ninstr);
+					}
 
-					if (unlikely(mem_word != e->mem_word)) {
-						/* repair */
-						stats.inc_redecodes();
+					/* since we are sure, the current block is coherent, we can now switch to fast for next call */
+					fast_path_raw_enable(curEntry);
 
-						/* block content changed -> invalidate links */
-						if (invalidate_links_once) {
-							curBlock->invalidate_links();
-							invalidate_links_once = false;
-						}
+				} catch (SimulationTrap &e) {
+					stats.inc_refetch_exceptions();
 
-						instr = Instruction(mem_word);
+					/* exception on load */
 
-						decode_update_entry(e, addr, instr);
-					} else {
-						addr += e->pc_increment;
+					/* entries repaired so far -> pairs may have changed */
+					if (!invalidate_links_once) {
+						block_fusion_update(curBlock);
 					}
-				}
-
-				/* success -> block is now coherent */
-				curBlock->coherence_cnt = coherence_cnt;
-
-				/* since we are sure, the current block is coherent, we can now switch to fast for next call */
-				fast_path_raw_enable(curEntry);
 
-			} catch (SimulationTrap &e) {
-				stats.inc_refetch_exceptions();
+					/* superblock was cut before the current entry -> leave */
+					if (unlikely(nextEntryIdx >= curBlock->len)) {
+						return superblock_leave(pc, instr, cycles, ninstr);
+					}
 
-				/* exception on load */
+					/* if current instruction is affected -> re-throw -> trap in ISS */
+					if (idx == nextEntryIdx) {
+						instr = Instruction(0);
+						/* safe pc for get_last_pc_exception_safe */
+						dummyBlock.entries[0].pc = pc;
+						exception = true;
+						throw;
+					}
 
-				/* if current instruction is affected -> re-throw -> trap in ISS */
-				if (idx == nextEntryIdx) {
-					instr = Instruction(0);
-					/* safe pc for get_last_pc_exception_safe */
-					dummyBlock.entries[0].pc = pc;
-					exception = true;
-					throw;
-				}
+					/* if instructions before current are affected
+					 * -> try to get instruction directly
+					 * (this may also cause a exception, which is then re-thrown (see fetch) -> trap in ISS)
+					 */
+					if (idx < nextEntryIdx) {
+						// TODO: count!!!
+						block_jit_drop(curBlock);
+						fetch(pc, instr);
+						decode_update_entry(curEntry, pc, instr);
+						entry_fusion_update(curEntry - 1);
+						entry_fusion_update(curEntry);
+						curEntryIdx = nextEntryIdx;
+						return curEntry->opLabelPtr;
+					}
 
-				/* if instructions before current are affected
-				 * -> try to get instruction directly
-				 * (this may also cause a exception, which is then re-thrown (see fetch) -> trap in ISS)
-				 */
-				if (idx < nextEntryIdx) {
-					// TODO: count!!!
-					fetch(pc, instr);
-					decode_update_entry(curEntry, pc, instr);
+					/* if instructions after current are affected
+					 * -> cache entry is coherent, but block is not yet
+					 * -> continue and try block update next time
+					 */
+					stats.inc_slow_hit();
 					curEntryIdx = nextEntryIdx;
+					instr = Instruction(curEntry->instr);
+					pc += curEntry->pc_increment;
 					return curEntry->opLabelPtr;
 				}
-
-				/* if instructions after current are affected
-				 * -> cache entry is coherent, but block is not yet
-				 * -> continue and try block update next time
-				 */
-				stats.inc_slow_hit();
-				curEntryIdx = nextEntryIdx;
-				instr = Instruction(curEntry->instr);
-				pc += curEntry->pc_increment;
-				return curEntry->opLabelPtr;
 			}
 		}
 
@@ -1293,26 +2673,34 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 		return curBlock->entries[curEntryIdx].pc;
 	}
 
+	/* pc after execution of entry (for fused jumps the pc of the appended target entry) */
+	static __always_inline T_uxlen_t get_entry_next_pc(Entry *e) {
+		if (unlikely(e->is_fused())) {
+			return (e + 1)->pc;
+		}
+		return e->pc + e->pc_increment;
+	}
+
 	/* TODO: UNUSED - REMOVE? */
 	__always_inline T_uxlen_t get_pc_before_callback() {
 		/* taken hit fast */
 		if (likely(in_fast_path())) {
-			return fastEntry->pc + fastEntry->pc_increment;
+			return get_entry_next_pc(fastEntry);
 		}
 
-		return curBlock->entries[curEntryIdx].pc + curBlock->entries[curEntryIdx].pc_increment;
+		return get_entry_next_pc(&curBlock->entries[curEntryIdx]);
 	}
 
 	__always_inline T_uxlen_t get_pc_maybe_after_callback() {
 		if (likely(in_fast_path())) {
 			if (likely(fastEntry != &curBlock->entries[-1])) {
-				return fastEntry->pc + fastEntry->pc_increment;
+				return get_entry_next_pc(fastEntry);
 			}
 			return (fastEntry + 1)->pc;
 		}
 
 		if (likely(curEntryIdx != -1)) {
-			return curBlock->entries[curEntryIdx].pc + curBlock->entries[curEntryIdx].pc_increment;
+			return get_entry_next_pc(&curBlock->entries[curEntryIdx]);
 		}
 
 		return curBlock->entries[curEntryIdx + 1].pc;
@@ -1326,6 +2714,22 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 		return cycle_counter_raw + curBlock->entries[curEntryIdx + 1].cycle_counter_raw;
 	}
 
+	/*
+	 * cycles accounted on the last block switch (without the current block)
+	 * -> cheap, but lags behind get_cycle_counter_raw by up to one (super)block
+	 */
+	__always_inline uint64_t get_cycle_counter_raw_accounted() {
+		return cycle_counter_raw;
+	}
+
+	/* number of executed instructions (including the current one, like get_cycle_counter_raw) */
+	__always_inline uint64_t get_instr_counter() {
+		if (likely(in_fast_path())) {
+			return instr_counter + (fastEntry + 1)->idx;
+		}
+		return instr_counter + curBlock->entries[curEntryIdx + 1].idx;
+	}
+
 	uint32_t get_mem_word() {
 		if (likely(in_fast_path())) {
 			return fastEntry->mem_word;
@@ -1349,11 +2753,11 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
  * CACHE SELECT
  ******************************************************************************/
 
-template <enum Architecture arch, typename T_uxlen_t, typename T_instr_memory_if>
+template <enum Architecture arch, typename T_uxlen_t, typename T_instr_memory_if, bool forced_enabled = false>
 #ifdef DBBCACHE_ENABLED
-using DBBCacheDefault_T = DBBCache_T<arch, T_uxlen_t, T_instr_memory_if>;
+using DBBCacheDefault_T = DBBCache_T<arch, T_uxlen_t, T_instr_memory_if, forced_enabled>;
 #else
-using DBBCacheDefault_T = DBBCacheDummy_T<arch, T_uxlen_t, T_instr_memory_if>;
+using DBBCacheDefault_T = DBBCacheDummy_T<arch, T_uxlen_t, T_instr_memory_if, forced_enabled>;
 #endif
 
 /******************************************************************************
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2024-2026 Manfred Schlaegl <manfred.schlaegl@gmx.at>
+ * see dbbcache.h
+ */
+
+#ifndef RISCV_ISA_DBBCACHE_ARENA_H
+#define RISCV_ISA_DBBCACHE_ARENA_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+/*
+ * Arena allocator for the DBBCache (one per hart)
+ *  * Memory is taken from large chunks (bump allocation) -> no per object malloc overhead
+ *  * Objects allocated with alloc (e.g. blocks) live until reset
+ *  * Arrays allocated with alloc_array (e.g. entries) can be freed (free_array) and are re-used via
+ *    free lists of power-of-two size classes
+ *  * reset releases all memory at once (no destructors are called!)
+ */
+class DBBCacheArena {
+	const static size_t CHUNK_SIZE = 1 << 20;
+	const static size_t ALIGN = 16;
+	/* smallest array size class: 64 bytes */
+	const static unsigned int MIN_CLASS = 6;
+	const static unsigned int N_CLASSES = 64;
+
+	struct FreeArray {
+		FreeArray *next;
+	};
+
+	std::vector<void *> chunks;
+	uint8_t *cur = nullptr;
+	uint8_t *end = nullptr;
+	FreeArray *free_lists[N_CLASSES];
+
+	/* bytes allocated from the system */
+	uint64_t size = 0;
+	uint64_t peak_size = 0;
+
+	static unsigned int size_class(size_t size) {
+		unsigned int c = MIN_CLASS;
+		while (((size_t)1 << c) < size) {
+			c++;
+		}
+		return c;
+	}
+
+	void *bump(size_t size) {
+		size = (size + ALIGN - 1) & ~(ALIGN - 1);
+		if ((size_t)(end - cur) < size) {
+			/* new chunk (the rest of the current one is wasted) */
+			size_t chunk_size = size > CHUNK_SIZE ? size : CHUNK_SIZE;
+			void *chunk = malloc(chunk_size);
+			if (chunk == nullptr) {
+				throw std::bad_alloc();
+			}
+			chunks.push_back(chunk);
+			cur = (uint8_t *)chunk;
+			end = cur + chunk_size;
+			this->size += chunk_size;
+			if (this->size > peak_size) {
+				peak_size = this->size;
+			}
+		}
+		void *ret = cur;
+		cur += size;
+		return ret;
+	}
+
+   public:
+	DBBCacheArena() {
+		memset(free_lists, 0, sizeof(free_lists));
+	}
+
+	~DBBCacheArena() {
+		reset();
+	}
+
+	DBBCacheArena(const DBBCacheArena &) = delete;
+	DBBCacheArena &operator=(const DBBCacheArena &) = delete;
+
+	void *alloc(size_t size) {
+		return bump(size);
+	}
+
+	/*
+	 * allocate array of at least size bytes
+	 * size is updated to the usable size (size class) of the returned array
+	 */
+	void *alloc_array(size_t &size) {
+		unsigned int c = size_class(size);
+		size = (size_t)1 << c;
+		FreeArray *array = free_lists[c];
+		if (array != nullptr) {
+			free_lists[c] = array->next;
+			return array;
+		}
+		return bump(size);
+	}
+
+	/* size must be greater than half of the size returned by alloc_array */
+	void free_array(void *ptr, size_t size) {
+		FreeArray *array = (FreeArray *)ptr;
+		unsigned int c = size_class(size);
+		array->next = free_lists[c];
+		free_lists[c] = array;
+	}
+
+	/* release all memory */
+	void reset() {
+		for (void *chunk : chunks) {
+			free(chunk);
+		}
+		chunks.clear();
+		cur = nullptr;
+		end = nullptr;
+		memset(free_lists, 0, sizeof(free_lists));
+		size = 0;
+	}
+
+	uint64_t get_size() const {
+		return size;
+	}
+
+	uint64_t get_peak_size() const {
+		return peak_size;
+	}
+};
+
+#endif /* RISCV_ISA_DBBCACHE_ARENA_H */
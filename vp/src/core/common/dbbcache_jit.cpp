@@ -0,0 +1,460 @@
+#include "dbbcache_jit.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+/* x86-64 opcode extensions (group 1: alu with immediate, group 2: shifts) */
+#define X86_EXT_ADD 0
+#define X86_EXT_OR 1
+#define X86_EXT_AND 4
+#define X86_EXT_XOR 6
+#define X86_EXT_CMP 7
+#define X86_EXT_SHL 4
+#define X86_EXT_SHR 5
+#define X86_EXT_SAR 7
+
+/* x86-64 opcodes (alu: r/m = rax, reg = rcx) */
+#define X86_OP_ADD 0x01
+#define X86_OP_OR 0x09
+#define X86_OP_AND 0x21
+#define X86_OP_SUB 0x29
+#define X86_OP_XOR 0x31
+#define X86_OP_CMP 0x39
+
+/* x86-64 condition codes (setcc) */
+#define X86_CC_B 0x92
+#define X86_CC_L 0x9c
+
+DBBCacheJIT::~DBBCacheJIT() {
+	if (buf != nullptr) {
+		munmap(buf, CODE_BUFFER_SIZE);
+	}
+}
+
+bool DBBCacheJIT::is_available() {
+#if defined(__x86_64__)
+	if (buf == nullptr && !unavailable) {
+		long ps = sysconf(_SC_PAGESIZE);
+		void *mem = MAP_FAILED;
+		if (ps > 0 && CODE_BUFFER_SIZE % ps == 0) {
+			/* not executable before anything is emitted (see W^X) */
+			mem = mmap(nullptr, CODE_BUFFER_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		}
+		if (mem == MAP_FAILED) {
+			unavailable = true;
+		} else {
+			buf = (uint8_t *)mem;
+			page_size = ps;
+		}
+	}
+	return buf != nullptr;
+#else
+	return false;
+#endif
+}
+
+bool DBBCacheJIT::protect(size_t from, size_t to, int prot) {
+	from -= from % page_size;
+	to = std::min(to + (page_size - 1 - (to + page_size - 1) % page_size), CODE_BUFFER_SIZE);
+	if (from >= to) {
+		return true;
+	}
+	return mprotect(&buf[from], to - from, prot) == 0;
+}
+
+bool DBBCacheJIT::is_supported(Architecture arch, Operation::OpId opId) {
+	using namespace Operation;
+
+	switch (opId) {
+		case LUI:
+		case LUI_NOP:
+		case AUIPC:
+		case AUIPC_NOP:
+		case ADDI:
+		case ADDI_NOP:
+		case SLTI:
+		case SLTI_NOP:
+		case SLTIU:
+		case SLTIU_NOP:
+		case XORI:
+		case XORI_NOP:
+		case ORI:
+		case ORI_NOP:
+		case ANDI:
+		case ANDI_NOP:
+		case SLLI:
+		case SLLI_NOP:
+		case SRLI:
+		case SRLI_NOP:
+		case SRAI:
+		case SRAI_NOP:
+		case ADD:
+		case ADD_NOP:
+		case SUB:
+		case SUB_NOP:
+		case SLL:
+		case SLL_NOP:
+		case SLT:
+		case SLT_NOP:
+		case SLTU:
+		case SLTU_NOP:
+		case XOR:
+		case XOR_NOP:
+		case SRL:
+		case SRL_NOP:
+		case SRA:
+		case SRA_NOP:
+		case OR:
+		case OR_NOP:
+		case AND:
+		case AND_NOP:
+		case MUL:
+		case MUL_NOP:
+		case MULH_NOP:
+		case MULHSU_NOP:
+		case MULHU_NOP:
+		case DIV_NOP:
+		case DIVU_NOP:
+		case REM_NOP:
+		case REMU_NOP:
+			return true;
+
+		case ADDIW:
+		case ADDIW_NOP:
+		case SLLIW:
+		case SLLIW_NOP:
+		case SRLIW:
+		case SRLIW_NOP:
+		case SRAIW:
+		case SRAIW_NOP:
+		case ADDW:
+		case ADDW_NOP:
+		case SUBW:
+		case SUBW_NOP:
+		case SLLW:
+		case SLLW_NOP:
+		case SRLW:
+		case SRLW_NOP:
+		case SRAW:
+		case SRAW_NOP:
+		case MULW:
+		case MULW_NOP:
+		case DIVW_NOP:
+		case DIVUW_NOP:
+		case REMW_NOP:
+		case REMUW_NOP:
+			return arch == RV64;
+
+		default:
+			return false;
+	}
+}
+
+void DBBCacheJIT::rex_w(bool w64) {
+	if (w64) {
+		put8(0x48);
+	}
+}
+
+/* mov hreg, [rdi + reg * XLEN/8] (x0 -> xor hreg, hreg) */
+void DBBCacheJIT::load(unsigned int hreg, unsigned int reg) {
+	if (reg == 0) {
+		put8(0x31);
+		put8(0xc0 | (hreg << 3) | hreg);
+		return;
+	}
+	rex_w(arch == RV64);
+	put8(0x8b);
+	put8(0x80 | (hreg << 3) | 7);
+	put32(reg * (arch == RV64 ? 8 : 4));
+}
+
+/* mov [rdi + reg * XLEN/8], rax */
+void DBBCacheJIT::store(unsigned int reg) {
+	rex_w(arch == RV64);
+	put8(0x89);
+	put8(0x80 | 7);
+	put32(reg * (arch == RV64 ? 8 : 4));
+}
+
+/* <op> rax, imm32 (sign extended) */
+void DBBCacheJIT::alu_imm(unsigned int ext, bool w64, int32_t imm) {
+	rex_w(w64);
+	put8(0x81);
+	put8(0xc0 | (ext << 3));
+	put32(imm);
+}
+
+/* <op> rax, rcx */
+void DBBCacheJIT::alu_reg(uint8_t opcode, bool w64) {
+	rex_w(w64);
+	put8(opcode);
+	put8(0xc0 | (1 << 3));
+}
+
+/* <shift> rax, shamt */
+void DBBCacheJIT::shift_imm(unsigned int ext, bool w64, unsigned int shamt) {
+	rex_w(w64);
+	put8(0xc1);
+	put8(0xc0 | (ext << 3));
+	put8(shamt);
+}
+
+/* <shift> rax, cl (masked to 5/6 bits by the host, same as the shamt of RISC-V) */
+void DBBCacheJIT::shift_reg(unsigned int ext, bool w64) {
+	rex_w(w64);
+	put8(0xd3);
+	put8(0xc0 | (ext << 3));
+}
+
+/* set<cc> al; movzx eax, al */
+void DBBCacheJIT::setcc(uint8_t cc) {
+	put8(0x0f);
+	put8(cc);
+	put8(0xc0);
+	put8(0x0f);
+	put8(0xb6);
+	put8(0xc0);
+}
+
+/* movsxd rax, eax */
+void DBBCacheJIT::sign_extend_32() {
+	put8(0x48);
+	put8(0x63);
+	put8(0xc0);
+}
+
+void DBBCacheJIT::begin(Architecture arch) {
+	this->arch = arch;
+	start = pos;
+	/* pages of the translation (the first one may hold previous translations, which are not executed meanwhile) */
+	overflow = !protect(start, CODE_BUFFER_SIZE, PROT_READ | PROT_WRITE);
+}
+
+bool DBBCacheJIT::emit(Operation::OpId opId, Instruction instr, uint64_t pc) {
+	using namespace Operation;
+
+	if (!is_supported(arch, opId)) {
+		return false;
+	}
+
+	/* x0 is never written (*_NOP operations have rd = x0) */
+	unsigned int rd = instr.rd();
+	if (rd == 0) {
+		return true;
+	}
+
+	/* XLEN operations (on RV32 all operations are 32 bit) */
+	bool wx = arch == RV64;
+
+	switch (opId) {
+		case LUI:
+			if (wx) {
+				/* mov rax, imm32 (sign extended) */
+				put8(0x48);
+				put8(0xc7);
+				put8(0xc0);
+			} else {
+				/* mov eax, imm32 */
+				put8(0xb8);
+			}
+			put32(instr.U_imm());
+			break;
+		case AUIPC:
+			if (wx) {
+				/* mov rax, imm64 */
+				put8(0x48);
+				put8(0xb8);
+				put64(pc + (int64_t)instr.U_imm());
+			} else {
+				put8(0xb8);
+				put32(pc + instr.U_imm());
+			}
+			break;
+
+		case ADDI:
+			load(0, instr.rs1());
+			alu_imm(X86_EXT_ADD, wx, instr.I_imm());
+			break;
+		case SLTI:
+			load(0, instr.rs1());
+			alu_imm(X86_EXT_CMP, wx, instr.I_imm());
+			setcc(X86_CC_L);
+			break;
+		case SLTIU:
+			load(0, instr.rs1());
+			alu_imm(X86_EXT_CMP, wx, instr.I_imm());
+			setcc(X86_CC_B);
+			break;
+		case XORI:
+			load(0, instr.rs1());
+			alu_imm(X86_EXT_XOR, wx, instr.I_imm());
+			break;
+		case ORI:
+			load(0, instr.rs1());
+			alu_imm(X86_EXT_OR, wx, instr.I_imm());
+			break;
+		case ANDI:
+			load(0, instr.rs1());
+			alu_imm(X86_EXT_AND, wx, instr.I_imm());
+			break;
+		case SLLI:
+			load(0, instr.rs1());
+			shift_imm(X86_EXT_SHL, wx, instr.shamt());
+			break;
+		case SRLI:
+			load(0, instr.rs1());
+			shift_imm(X86_EXT_SHR, wx, instr.shamt());
+			break;
+		case SRAI:
+			load(0, instr.rs1());
+			shift_imm(X86_EXT_SAR, wx, instr.shamt());
+			break;
+
+		case ADD:
+		case SUB:
+		case XOR:
+		case OR:
+		case AND:
+		case SLT:
+		case SLTU:
+		case SLL:
+		case SRL:
+		case SRA:
+		case MUL:
+			load(0, instr.rs1());
+			load(1, instr.rs2());
+			switch (opId) {
+				case ADD:
+					alu_reg(X86_OP_ADD, wx);
+					break;
+				case SUB:
+					alu_reg(X86_OP_SUB, wx);
+					break;
+				case XOR:
+					alu_reg(X86_OP_XOR, wx);
+					break;
+				case OR:
+					alu_reg(X86_OP_OR, wx);
+					break;
+				case AND:
+					alu_reg(X86_OP_AND, wx);
+					break;
+				case SLT:
+					alu_reg(X86_OP_CMP, wx);
+					setcc(X86_CC_L);
+					break;
+				case SLTU:
+					alu_reg(X86_OP_CMP, wx);
+					setcc(X86_CC_B);
+					break;
+				case SLL:
+					shift_reg(X86_EXT_SHL, wx);
+					break;
+				case SRL:
+					shift_reg(X86_EXT_SHR, wx);
+					break;
+				case SRA:
+					shift_reg(X86_EXT_SAR, wx);
+					break;
+				default: /* MUL: imul rax, rcx */
+					rex_w(wx);
+					put8(0x0f);
+					put8(0xaf);
+					put8(0xc1);
+					break;
+			}
+			break;
+
+		/* RV64 only (see is_supported): 32 bit operation, result is sign extended */
+		case ADDIW:
+			load(0, instr.rs1());
+			alu_imm(X86_EXT_ADD, false, instr.I_imm());
+			sign_extend_32();
+			break;
+		case SLLIW:
+			load(0, instr.rs1());
+			shift_imm(X86_EXT_SHL, false, instr.shamt_w());
+			sign_extend_32();
+			break;
+		case SRLIW:
+			load(0, instr.rs1());
+			shift_imm(X86_EXT_SHR, false, instr.shamt_w());
+			sign_extend_32();
+			break;
+		case SRAIW:
+			load(0, instr.rs1());
+			shift_imm(X86_EXT_SAR, false, instr.shamt_w());
+			sign_extend_32();
+			break;
+		case ADDW:
+		case SUBW:
+		case SLLW:
+		case SRLW:
+		case SRAW:
+		case MULW:
+			load(0, instr.rs1());
+			load(1, instr.rs2());
+			switch (opId) {
+				case ADDW:
+					alu_reg(X86_OP_ADD, false);
+					break;
+				case SUBW:
+					alu_reg(X86_OP_SUB, false);
+					break;
+				case SLLW:
+					shift_reg(X86_EXT_SHL, false);
+					break;
+				case SRLW:
+					shift_reg(X86_EXT_SHR, false);
+					break;
+				case SRAW:
+					shift_reg(X86_EXT_SAR, false);
+					break;
+				default: /* MULW: imul eax, ecx */
+					put8(0x0f);
+					put8(0xaf);
+					put8(0xc1);
+					break;
+			}
+			sign_extend_32();
+			break;
+
+		default:
+			/* remaining supported operations are *_NOP (rd = x0, see above) */
+			return true;
+	}
+
+	store(rd);
+	return true;
+}
+
+DBBCacheJIT::Code DBBCacheJIT::end() {
+	/* ret */
+	put8(0xc3);
+	if (overflow || !protect(start, pos, PROT_READ | PROT_EXEC)) {
+		abort();
+		return nullptr;
+	}
+	Code code = (Code)&buf[start];
+	start = pos;
+	return code;
+}
+
+void DBBCacheJIT::abort() {
+	pos = start;
+	overflow = false;
+	/* previous translations in the first page */
+	if (!protect(start, start, PROT_READ | PROT_EXEC)) {
+		throw std::runtime_error("DBBCacheJIT: unable to restore the protection of the code buffer");
+	}
+}
+
+void DBBCacheJIT::reset() {
+	pos = 0;
+	start = 0;
+	overflow = false;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2024-2026 Manfred Schlaegl <manfred.schlaegl@gmx.at>
+ * see dbbcache.h
+ */
+
+#ifndef RISCV_ISA_DBBCACHE_JIT_H
+#define RISCV_ISA_DBBCACHE_JIT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core_defs.h"
+#include "instr.h"
+
+/*
+ * Host code translator for the DBBCache (second tier, see "Translation" in dbbcache.h)
+ *  * Translates runs of integer register operations (no memory access, no control flow, no csr access -> can not
+ *    trap) to x86-64 host code. A translated run is a function, which operates directly on the register file of the
+ *    ISS (array of XLEN bit registers, x0 is never written).
+ *  * Code is emitted to a buffer (one per hart), which is only released at once (reset).
+ *  * W^X: The buffer is never writable and executable at the same time. The pages of a translation are writable
+ *    while it is emitted (begin) and are switched to read/execute at its end (end, abort).
+ *  * On other hosts or if the buffer can not be allocated, nothing is translated (is_available).
+ * Usage: begin, emit for each instruction (until it fails), end or abort
+ */
+class DBBCacheJIT {
+   public:
+	typedef void (*Code)(void *regs);
+
+	const static size_t CODE_BUFFER_SIZE = 4 << 20;
+
+   private:
+	Architecture arch = RV64;
+	uint8_t *buf = nullptr;
+	size_t page_size = 0;
+	size_t pos = 0;
+	/* start of the current translation */
+	size_t start = 0;
+	bool overflow = false;
+	bool unavailable = false;
+
+	/* set the protection of all pages overlapping [from, to) -> false on error */
+	bool protect(size_t from, size_t to, int prot);
+
+	void put8(uint8_t b) {
+		if (pos < CODE_BUFFER_SIZE) {
+			buf[pos++] = b;
+		} else {
+			overflow = true;
+		}
+	}
+	void put32(uint32_t v) {
+		for (unsigned int i = 0; i < 4; i++) {
+			put8(v >> (i * 8));
+		}
+	}
+	void put64(uint64_t v) {
+		put32(v);
+		put32(v >> 32);
+	}
+
+	/* x86-64 helpers (host registers: 0 = rax, 1 = rcx; regs pointer in rdi) */
+	void rex_w(bool w64);
+	void load(unsigned int hreg, unsigned int reg);
+	void store(unsigned int reg);
+	void alu_imm(unsigned int ext, bool w64, int32_t imm);
+	void alu_reg(uint8_t opcode, bool w64);
+	void shift_imm(unsigned int ext, bool w64, unsigned int shamt);
+	void shift_reg(unsigned int ext, bool w64);
+	void setcc(uint8_t cc);
+	void sign_extend_32();
+
+   public:
+	DBBCacheJIT() = default;
+	~DBBCacheJIT();
+
+	DBBCacheJIT(const DBBCacheJIT &) = delete;
+	DBBCacheJIT &operator=(const DBBCacheJIT &) = delete;
+
+	/* translation possible on this host (allocates the code buffer on first call) */
+	bool is_available();
+
+	/* operation can be translated (independent of its operands) */
+	static bool is_supported(Architecture arch, Operation::OpId opId);
+
+	/* start a new translation */
+	void begin(Architecture arch);
+	/* append instr (decoded and expanded) at pc -> false, if not supported (translation can be ended anyway) */
+	bool emit(Operation::OpId opId, Instruction instr, uint64_t pc);
+	/* finish the current translation -> nullptr, if the buffer is full */
+	Code end();
+	/* discard the current translation */
+	void abort();
+
+	/* release all translated code */
+	void reset();
+
+	size_t get_size() const {
+		return pos;
+	}
+};
+
+#endif /* RISCV_ISA_DBBCACHE_JIT_H */
@@ -12,10 +12,12 @@
 // #define DBBCACHE_STATS_OUTPUT_CSV_ENABLED
 #undef DBBCACHE_STATS_OUTPUT_CSV_ENABLED
 
+#include <chrono>
 #include <climits>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <unordered_map>
 
 #include "util/histogram.h"
 
@@ -44,9 +46,20 @@ class DBBCacheStatsDummy_T {
 	void inc_refetches() {}
 	void inc_refetch_exceptions() {}
 	void inc_redecodes() {}
+	void inc_page_checks() {}
+	void inc_page_check_hits() {}
+	void inc_page_translate_skips() {}
+	void inc_page_track_fails() {}
 	void inc_blocks() {}
+	void inc_share_fills() {}
+	void inc_warm_fills() {}
 	void inc_map_search() {}
 	void inc_map_found() {}
+	uint64_t map_lookup_begin() {
+		return 0;
+	}
+	void map_clear() {}
+	void map_lookup_end(uint64_t begin, uint64_t pc) {}
 	void inc_branches_not_taken() {}
 	void inc_branch_list_full() {}
 	void inc_branches_taken() {}
@@ -55,9 +68,23 @@ class DBBCacheStatsDummy_T {
 	void inc_branch_sjump_slow_hits() {}
 	void inc_djumps() {}
 	void inc_djump_hits() {}
+	void inc_ras_rets() {}
+	void inc_ras_hits() {}
+	void inc_ras_link_hits() {}
 	void inc_trap_enters() {}
 	void inc_trap_enter_hits() {}
 	void inc_trap_rets() {}
+	void inc_trap_ret_hits() {}
+	void inc_request_exits() {}
+	void inc_superblock_fusions() {}
+	void inc_superblock_rejects() {}
+	void inc_superblock_jumps() {}
+	void inc_superblock_cuts() {}
+	void inc_jit_translations() {}
+	void inc_jit_rejects() {}
+	void inc_jit_drops() {}
+	void inc_jit_flushes() {}
+	void inc_pair_fusions() {}
 	void inc_swtch_same_fast() {}
 	void inc_swtch_same_slow() {}
 	void inc_swtch_other() {}
@@ -65,6 +92,7 @@ class DBBCacheStatsDummy_T {
 	void dec_hit() {}
 	void inc_fast_hit() {}
 	void dec_fast_hit() {}
+	void inc_pair_hit() {}
 	void inc_fast_abort() {}
 	void inc_med_hit() {}
 	void inc_slow_hit() {}
@@ -94,11 +122,19 @@ class DBBCacheStats_T : public DBBCacheStatsDummy_T<T_DBBCache, T_JUMPDYNLINKCAC
 		selem_t refetches;
 		selem_t refetch_exceptions;
 		selem_t redecodes;
+		selem_t page_checks;
+		selem_t page_check_hits;
+		selem_t page_translate_skips;
+		selem_t page_track_fails;
 
 		selem_t blocks;
+		selem_t share_fills;
+		selem_t warm_fills;
 
 		selem_t map_search;
 		selem_t map_found;
+		selem_t map_lookup_ns;
+		selem_t shadow_map_lookup_ns;
 
 		selem_t branches;
 		selem_t branches_not_taken;
@@ -110,9 +146,23 @@ class DBBCacheStats_T : public DBBCacheStatsDummy_T<T_DBBCache, T_JUMPDYNLINKCAC
 		selem_t branch_sjump_hits;
 		selem_t djumps;
 		selem_t djump_hits;
+		selem_t ras_rets;
+		selem_t ras_hits;
+		selem_t ras_link_hits;
 		selem_t trap_enters;
 		selem_t trap_enter_hits;
 		selem_t trap_rets;
+		selem_t trap_ret_hits;
+		selem_t request_exits;
+		selem_t superblock_fusions;
+		selem_t superblock_rejects;
+		selem_t superblock_jumps;
+		selem_t superblock_cuts;
+		selem_t jit_translations;
+		selem_t jit_rejects;
+		selem_t jit_drops;
+		selem_t jit_flushes;
+		selem_t pair_fusions;
 		selem_t swtch;
 		selem_t swtch_same;
 		selem_t swtch_same_fast;
@@ -121,6 +171,7 @@ class DBBCacheStats_T : public DBBCacheStatsDummy_T<T_DBBCache, T_JUMPDYNLINKCAC
 
 		selem_t hit;
 		selem_t fast_hit;
+		selem_t pair_hit;
 		selem_t fast_abort;
 		selem_t med_hit;
 		selem_t slow_hit;
@@ -132,6 +183,19 @@ class DBBCacheStats_T : public DBBCacheStatsDummy_T<T_DBBCache, T_JUMPDYNLINKCAC
 		selem_t overallCohMemSum;
 	} s;
 
+	/*
+	 * shadow of the block map in the previously used data structure (only contains the pcs)
+	 * -> used to compare the lookup latency of both
+	 * cleared together with the block map (see map_clear) -> bounded by the blocks of the memory budget
+	 */
+	std::unordered_map<uint64_t, bool> shadow_map;
+
+	static uint64_t now_ns() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		           std::chrono::steady_clock::now().time_since_epoch())
+		    .count();
+	}
+
 	DBBCacheStats_T(T_DBBCache &lscache) : DBBCacheStatsDummy_T<T_DBBCache, T_JUMPDYNLINKCACHE_SIZE>(lscache) {
 		reset();
 	}
@@ -181,15 +245,52 @@ class DBBCacheStats_T : public DBBCacheStatsDummy_T<T_DBBCache, T_JUMPDYNLINKCAC
 	void inc_redecodes() {
 		s.redecodes++;
 	}
+	void inc_page_checks() {
+		s.page_checks++;
+	}
+	void inc_page_check_hits() {
+		s.page_check_hits++;
+	}
+	void inc_page_translate_skips() {
+		s.page_translate_skips++;
+	}
+	void inc_page_track_fails() {
+		s.page_track_fails++;
+	}
 	void inc_blocks() {
 		s.blocks++;
 	}
+	void inc_share_fills() {
+		s.share_fills++;
+	}
+	void inc_warm_fills() {
+		s.warm_fills++;
+	}
 	void inc_map_search() {
 		s.map_search++;
 	}
 	void inc_map_found() {
 		s.map_found++;
 	}
+	uint64_t map_lookup_begin() {
+		return now_ns();
+	}
+	void map_lookup_end(uint64_t begin, uint64_t pc) {
+		uint64_t end = now_ns();
+		s.map_lookup_ns += end - begin;
+
+		/* same lookup (and insertion on miss) in the shadow map */
+		begin = now_ns();
+		auto it = shadow_map.find(pc);
+		if (it == shadow_map.end()) {
+			shadow_map[pc] = true;
+		}
+		end = now_ns();
+		s.shadow_map_lookup_ns += end - begin;
+	}
+	void map_clear() {
+		shadow_map.clear();
+	}
 	void inc_branches_not_taken() {
 		s.branches++;
 		s.branches_not_taken++;
@@ -217,6 +318,15 @@ class DBBCacheStats_T : public DBBCacheStatsDummy_T<T_DBBCache, T_JUMPDYNLINKCAC
 	void inc_djump_hits() {
 		s.djump_hits++;
 	}
+	void inc_ras_rets() {
+		s.ras_rets++;
+	}
+	void inc_ras_hits() {
+		s.ras_hits++;
+	}
+	void inc_ras_link_hits() {
+		s.ras_link_hits++;
+	}
 	void inc_trap_enters() {
 		s.trap_enters++;
 	}
@@ -226,6 +336,39 @@ class DBBCacheStats_T : public DBBCacheStatsDummy_T<T_DBBCache, T_JUMPDYNLINKCAC
 	void inc_trap_rets() {
 		s.trap_rets++;
 	}
+	void inc_trap_ret_hits() {
+		s.trap_ret_hits++;
+	}
+	void inc_request_exits() {
+		s.request_exits++;
+	}
+	void inc_superblock_fusions() {
+		s.superblock_fusions++;
+	}
+	void inc_superblock_rejects() {
+		s.superblock_rejects++;
+	}
+	void inc_superblock_jumps() {
+		s.superblock_jumps++;
+	}
+	void inc_superblock_cuts() {
+		s.superblock_cuts++;
+	}
+	void inc_jit_translations() {
+		s.jit_translations++;
+	}
+	void inc_jit_rejects() {
+		s.jit_rejects++;
+	}
+	void inc_jit_drops() {
+		s.jit_drops++;
+	}
+	void inc_jit_flushes() {
+		s.jit_flushes++;
+	}
+	void inc_pair_fusions() {
+		s.pair_fusions++;
+	}
 	void inc_swtch_same_fast() {
 		s.swtch++;
 		s.swtch_same++;
@@ -254,6 +397,10 @@ class DBBCacheStats_T : public DBBCacheStatsDummy_T<T_DBBCache, T_JUMPDYNLINKCAC
 		dec_hit();
 		s.fast_hit--;
 	}
+	void inc_pair_hit() {
+		inc_fast_hit();
+		s.pair_hit++;
+	}
 	void inc_fast_abort() {
 		dec_fast_hit();
 		s.fast_abort++;
@@ -290,9 +437,20 @@ class DBBCacheStats_T : public DBBCacheStatsDummy_T<T_DBBCache, T_JUMPDYNLINKCAC
 		std::cout << " refetches:                 " << DBBCACHE_STAT_RATE(s.refetches, s.cnt);
 		std::cout << "  refetch_exceptions:       " << DBBCACHE_STAT_RATE(s.refetch_exceptions, s.refetches);
 		std::cout << " redecodes:                 " << DBBCACHE_STAT_RATE(s.redecodes, s.cnt);
+		std::cout << " page_checks:               " << DBBCACHE_STAT_RATE(s.page_checks, s.cnt);
+		std::cout << "  page_check_hits:          " << DBBCACHE_STAT_RATE(s.page_check_hits, s.page_checks);
+		std::cout << "  page_translate_skips:     " << DBBCACHE_STAT_RATE(s.page_translate_skips, s.page_checks);
+		std::cout << " page_track_fails:          " << s.page_track_fails << "\n";
 		std::cout << " blocks:                    " << s.blocks << "\n";
+		std::cout << "  share_fills:              " << DBBCACHE_STAT_RATE(s.share_fills, s.blocks);
+		std::cout << "  warm_fills:               " << DBBCACHE_STAT_RATE(s.warm_fills, s.blocks);
 		std::cout << " map_search:                " << DBBCACHE_STAT_RATE(s.map_search, s.cnt);
 		std::cout << "  map_found:                " << DBBCACHE_STAT_RATE(s.map_found, s.map_search);
+		std::cout << "  map_lookup_ns:            " << DBBCACHE_STAT_RATE(s.map_lookup_ns, s.map_search);
+		std::cout << "  shadow_map_lookup_ns:     " << DBBCACHE_STAT_RATE(s.shadow_map_lookup_ns, s.map_search);
+		std::cout << " map_pages:                 " << this->dbbcache.blockmap.n_pages() << "\t\t("
+		          << (double)(this->dbbcache.blockmap.n_pages() * T_DBBCache::BlockMap::page_size()) / 1024.0
+		          << " KiB)\n";
 		std::cout << " branches:                  " << DBBCACHE_STAT_RATE(s.branches, s.cnt);
 		std::cout << " branches_not_taken:        " << DBBCACHE_STAT_RATE(s.branches_not_taken, s.cnt);
 		std::cout << " branches_taken:            " << DBBCACHE_STAT_RATE(s.branches_taken, s.cnt);
@@ -302,9 +460,23 @@ class DBBCacheStats_T : public DBBCacheStatsDummy_T<T_DBBCache, T_JUMPDYNLINKCAC
 		std::cout << " branch_sjump_hits:         " << DBBCACHE_STAT_RATE(s.branch_sjump_hits, s.branch_sjump);
 		std::cout << " djumps:                    " << DBBCACHE_STAT_RATE(s.djumps, s.cnt);
 		std::cout << "  djump_hits:               " << DBBCACHE_STAT_RATE(s.djump_hits, s.djumps);
+		std::cout << " ras_rets:                  " << DBBCACHE_STAT_RATE(s.ras_rets, s.cnt);
+		std::cout << "  ras_hits:                 " << DBBCACHE_STAT_RATE(s.ras_hits, s.ras_rets);
+		std::cout << "   ras_link_hits:           " << DBBCACHE_STAT_RATE(s.ras_link_hits, s.ras_hits);
 		std::cout << " trap_enters:               " << DBBCACHE_STAT_RATE(s.trap_enters, s.cnt);
 		std::cout << "  trap_enter_hits:          " << DBBCACHE_STAT_RATE(s.trap_enter_hits, s.trap_enters);
 		std::cout << " trap_rets:                 " << DBBCACHE_STAT_RATE(s.trap_rets, s.cnt);
+		std::cout << "  trap_ret_hits:            " << DBBCACHE_STAT_RATE(s.trap_ret_hits, s.trap_rets);
+		std::cout << " request_exits:             " << DBBCACHE_STAT_RATE(s.request_exits, s.swtch);
+		std::cout << " superblock_fusions:        " << s.superblock_fusions << "\n";
+		std::cout << "  superblock_rejects:       " << s.superblock_rejects << "\n";
+		std::cout << "  superblock_cuts:          " << s.superblock_cuts << "\n";
+		std::cout << " superblock_jumps:          " << DBBCACHE_STAT_RATE(s.superblock_jumps, s.sjumps);
+		std::cout << " jit_translations:          " << s.jit_translations << "\n";
+		std::cout << "  jit_rejects:              " << s.jit_rejects << "\n";
+		std::cout << "  jit_drops:                " << s.jit_drops << "\n";
+		std::cout << "  jit_flushes:              " << s.jit_flushes << "\n";
+		std::cout << " pair_fusions:              " << s.pair_fusions << "\n";
 		std::cout << " swtch:                     " << DBBCACHE_STAT_RATE(s.swtch, s.cnt);
 		std::cout << "  swtch_same:               " << DBBCACHE_STAT_RATE(s.swtch_same, s.swtch);
 		std::cout << "   swtch_same_fast:         " << DBBCACHE_STAT_RATE(s.swtch_same_fast, s.swtch_same);
@@ -312,6 +484,7 @@ class DBBCacheStats_T : public DBBCacheStatsDummy_T<T_DBBCache, T_JUMPDYNLINKCAC
 		std::cout << "  swtch_other:              " << DBBCACHE_STAT_RATE(s.swtch_other, s.swtch);
 		std::cout << " hit:                       " << DBBCACHE_STAT_RATE(s.hit, s.cnt);
 		std::cout << "  fast_hit:                 " << DBBCACHE_STAT_RATE(s.fast_hit, s.hit);
+		std::cout << "   pair_hit:                " << DBBCACHE_STAT_RATE(s.pair_hit, s.fast_hit);
 		std::cout << "  med_hit:                  " << DBBCACHE_STAT_RATE(s.med_hit, s.hit);
 		std::cout << "  slow_hit:                 " << DBBCACHE_STAT_RATE(s.slow_hit, s.hit);
 		std::cout << " fast_abort:                " << DBBCACHE_STAT_RATE(s.fast_abort, s.cnt);
@@ -338,20 +511,20 @@ class DBBCacheStats_T : public DBBCacheStatsDummy_T<T_DBBCache, T_JUMPDYNLINKCAC
 		selem_t n_coherent_alloc_entries = 0;
 		selem_t n_entries = 0;
 		selem_t n_coherent_entries = 0;
-		for (const auto &it : this->dbbcache.blockmap) {
+		this->dbbcache.blockmap.for_each([&](auto *block) {
 			n_blocks++;
-			n_alloc_entries += it.second->alloc_len;
-			n_entries += it.second->len;
-			if (it.second->coherence_cnt == this->dbbcache.coherence_cnt) {
+			n_alloc_entries += block->alloc_len;
+			n_entries += block->len;
+			if (block->coherence_cnt == this->dbbcache.coherence_cnt) {
 				n_coherent_blocks++;
-				n_coherent_alloc_entries += it.second->alloc_len;
-				n_coherent_entries += it.second->len;
+				n_coherent_alloc_entries += block->alloc_len;
+				n_coherent_entries += block->len;
 			}
-			blkAllocLenHist.iteration(it.second->alloc_len);
-			blkLenHist.iteration(it.second->len);
-			jumpDynLinkCacheHist.iteration(it.second->jumpDynLinkCache.n_dirty());
-			branchLinkListHist.iteration(it.second->n_links_dirty());
-		}
+			blkAllocLenHist.iteration(block->alloc_len);
+			blkLenHist.iteration(block->len);
+			jumpDynLinkCacheHist.iteration(block->jumpDynLinkCache.n_dirty());
+			branchLinkListHist.iteration(block->n_links_dirty());
+		});
 		blkAllocLenHist.print(true);
 		blkLenHist.print(true);
 		jumpDynLinkCacheHist.print(true);
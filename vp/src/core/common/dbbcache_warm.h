@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2024-2026 Manfred Schlaegl <manfred.schlaegl@gmx.at>
+ * see dbbcache.h
+ */
+
+#ifndef RISCV_ISA_DBBCACHE_WARM_H
+#define RISCV_ISA_DBBCACHE_WARM_H
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Persistent store of the blocks discovered by the DBBCache (warm start)
+ * The store holds the start pc and the instruction words of blocks of a previous run. It is keyed by a hash of the
+ * loaded images (see hash_files) -> the file is only used, if the images did not change.
+ * On creation of a new block the DBBCache fills the block with the recorded instructions at once, after it has
+ * re-validated them (fetch and compare, see DBBCache_T::block_warm_fill).
+ * One store is used for all harts of a platform.
+ */
+class DBBCacheWarmStore {
+   public:
+	/*
+	 * max number of words of a record
+	 * Blocks have no max length -> longer blocks are recorded with their first BLOCK_WORDS_MAX words (a prefix of a
+	 * block is a valid record, see DBBCache_T::warm_store_collect and block_warm_fill)
+	 */
+	const static uint32_t BLOCK_WORDS_MAX = 1024;
+
+   private:
+	const static uint32_t MAGIC = 0x57424244; /* "DBBW" */
+	const static uint32_t VERSION = 1;
+
+	const std::string filename;
+	const uint64_t image_hash;
+	const uint32_t xlen;
+	std::unordered_map<uint64_t, std::vector<uint32_t>> blocks;
+
+	struct Header {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t xlen;
+		uint32_t reserved;
+		uint64_t image_hash;
+		uint64_t n_blocks;
+	};
+
+	void load() {
+		std::ifstream f(filename, std::ios::binary | std::ios::ate);
+		if (!f) {
+			return;
+		}
+		const uint64_t file_size = f.tellg();
+		f.seekg(0);
+		Header h;
+		if (!f.read((char *)&h, sizeof(h)) || h.magic != MAGIC || h.version != VERSION || h.xlen != xlen ||
+		    h.image_hash != image_hash) {
+			std::cout << "DBBCache: warm start file \"" << filename << "\" does not match -> ignored" << std::endl;
+			return;
+		}
+		for (uint64_t i = 0; i < h.n_blocks; i++) {
+			uint64_t pc;
+			uint32_t n;
+			if (!f.read((char *)&pc, sizeof(pc)) || !f.read((char *)&n, sizeof(n))) {
+				break;
+			}
+			/* corrupt or truncated file -> keep the records read so far (they are re-validated before use) */
+			if (n == 0 || n * sizeof(uint32_t) > file_size - (uint64_t)f.tellg()) {
+				std::cout << "DBBCache: warm start file \"" << filename << "\" is corrupt -> stop loading" << std::endl;
+				break;
+			}
+			/* oversize record (e.g. other version of the writer) -> skip it */
+			if (n > BLOCK_WORDS_MAX) {
+				f.seekg(n * sizeof(uint32_t), std::ios::cur);
+				continue;
+			}
+			std::vector<uint32_t> &words = blocks[pc];
+			words.resize(n);
+			if (!f.read((char *)words.data(), n * sizeof(uint32_t))) {
+				blocks.erase(pc);
+				break;
+			}
+		}
+		std::cout << "DBBCache: warm start file \"" << filename << "\" loaded (" << blocks.size() << " blocks)"
+		          << std::endl;
+	}
+
+   public:
+	DBBCacheWarmStore(const std::string &filename, uint64_t image_hash, uint32_t xlen)
+	    : filename(filename), image_hash(image_hash), xlen(xlen) {
+		load();
+	}
+
+	/* FNV-1a hash of the contents of all given files (empty names are ignored) */
+	static uint64_t hash_files(const std::vector<std::string> &files) {
+		uint64_t hash = 0xcbf29ce484222325;
+		std::vector<char> buf(1 << 16);
+		for (const auto &file : files) {
+			if (file.empty()) {
+				continue;
+			}
+			std::ifstream f(file, std::ios::binary);
+			while (f.read(buf.data(), buf.size()) || f.gcount() > 0) {
+				for (std::streamsize i = 0; i < f.gcount(); i++) {
+					hash ^= (uint8_t)buf[i];
+					hash *= 0x100000001b3;
+				}
+			}
+		}
+		return hash;
+	}
+
+	/* recorded instruction words of the block starting at pc (nullptr, if not existent) */
+	const std::vector<uint32_t> *find(uint64_t pc) const {
+		auto it = blocks.find(pc);
+		if (it == blocks.end()) {
+			return nullptr;
+		}
+		return &it->second;
+	}
+
+	/* record block (the longest record of all harts is kept; words: at most BLOCK_WORDS_MAX) */
+	void add(uint64_t pc, const std::vector<uint32_t> &words) {
+		if (words.size() > BLOCK_WORDS_MAX) {
+			throw std::runtime_error("DBBCacheWarmStore: record exceeds BLOCK_WORDS_MAX");
+		}
+		std::vector<uint32_t> &cur = blocks[pc];
+		if (words.size() > cur.size()) {
+			cur = words;
+		}
+	}
+
+	void save() const {
+		std::ofstream f(filename, std::ios::binary | std::ios::trunc);
+		if (!f) {
+			std::cerr << "DBBCache: unable to write warm start file \"" << filename << "\"" << std::endl;
+			return;
+		}
+		Header h = {MAGIC, VERSION, xlen, 0, image_hash, blocks.size()};
+		f.write((const char *)&h, sizeof(h));
+		for (const auto &it : blocks) {
+			uint64_t pc = it.first;
+			uint32_t n = it.second.size();
+			f.write((const char *)&pc, sizeof(pc));
+			f.write((const char *)&n, sizeof(n));
+			f.write((const char *)it.second.data(), n * sizeof(uint32_t));
+		}
+		std::cout << "DBBCache: warm start file \"" << filename << "\" saved (" << blocks.size() << " blocks)"
+		          << std::endl;
+	}
+};
+
+#endif /* RISCV_ISA_DBBCACHE_WARM_H */
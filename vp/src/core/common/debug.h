@@ -42,6 +42,10 @@ struct debug_target_if {
 	virtual bool dbbcache_enabled(void) {
 		return false;
 	}
+	virtual void enable_dbbcache_jit(bool ena) {}
+	virtual bool dbbcache_jit_enabled(void) {
+		return false;
+	}
 	virtual void enable_lscache(bool ena) {}
 	virtual bool lscache_enabled(void) {
 		return false;
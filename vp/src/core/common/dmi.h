@@ -2,13 +2,18 @@
 
 #include <stdint.h>
 
+#include "code_page_tracker.h"
+
 class MemoryDMI {
 	uint8_t *const mem;
 	const uint64_t start;
 	const uint64_t size;
 	const uint64_t end;
+	/* shared by all copies and all MemoryDMI objects on the same memory */
+	CodePageTracker *const code_page_tracker;
 
-	MemoryDMI(uint8_t *mem, uint64_t start, uint64_t size) : mem(mem), start(start), size(size), end(start + size) {}
+	MemoryDMI(uint8_t *mem, uint64_t start, uint64_t size)
+	    : mem(mem), start(start), size(size), end(start + size), code_page_tracker(CodePageTracker::get(mem, size)) {}
 
    public:
 	static MemoryDMI create_start_end_mapping(uint8_t *mem, uint64_t start, uint64_t end) {
@@ -49,12 +54,40 @@ class MemoryDMI {
 		return ans;
 	}
 
+	/* returns true, if a code page was written (see CodePageTracker) */
 	template <typename T>
-	void store(uint64_t addr, T value) const {
+	bool store(uint64_t addr, T value) const {
 		static_assert(std::is_integral<T>::value, "integer type required");
 		T *dst = get_mem_ptr_to_global_addr<T>(addr);
 		/* memcpy -> see note in load */
 		memcpy(dst, &value, sizeof(value));
+		return code_page_tracker->write(dst, sizeof(value));
+	}
+
+	/* atomic load (host atomics, addr must be aligned) */
+	template <typename T>
+	T load_atomic(uint64_t addr) const {
+		static_assert(std::is_integral<T>::value, "integer type required");
+		return __atomic_load_n(get_mem_ptr_to_global_addr<T>(addr), __ATOMIC_SEQ_CST);
+	}
+
+	/*
+	 * atomic compare and exchange (host atomics, addr must be aligned)
+	 * returns true, if value was stored (expected is updated with the current value otherwise)
+	 */
+	template <typename T>
+	bool compare_exchange(uint64_t addr, T &expected, T value) const {
+		static_assert(std::is_integral<T>::value, "integer type required");
+		T *dst = get_mem_ptr_to_global_addr<T>(addr);
+		if (!__atomic_compare_exchange_n(dst, &expected, value, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+			return false;
+		}
+		code_page_tracker->write(dst, sizeof(value));
+		return true;
+	}
+
+	CodePageTracker *get_code_page_tracker() const {
+		return code_page_tracker;
 	}
 
 	uint64_t get_start() const {
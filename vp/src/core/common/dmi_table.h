@@ -0,0 +1,118 @@
+/*
+ * DMI Table
+ * Set of (non-overlapping) dmi ranges, used by the memory interfaces to find the dmi range of a physical address (see
+ * CombinedMemoryInterface_T in mem.h).
+ * The ranges are indexed by their start address (sorted) -> lookups are binary searches, which are preceded by a check
+ * of the range of the last hit (accesses of a hart are usually to the same range, e.g. main memory). The cost of a
+ * lookup is therefore independent of the number of dmi capable targets of the platform (e.g. memory, ROMs, MRAM, ...).
+ *
+ * Ranges may be removed (see invalidate, e.g. on invalidate_direct_mem_ptr of TLM). Pointers to ranges (returned by
+ * find) are valid until the range is removed.
+ */
+
+#ifndef RISCV_ISA_DMI_TABLE_H
+#define RISCV_ISA_DMI_TABLE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <stdexcept>
+#include <vector>
+
+#include "dmi.h"
+#include "util/common.h"
+
+class DMITable {
+	struct Index {
+		uint64_t start;
+		uint64_t end;
+		MemoryDMI *dmi;
+	};
+
+	/* MemoryDMI is not assignable -> list (stable pointers for index and last) */
+	std::list<MemoryDMI> ranges;
+	/* sorted by start */
+	std::vector<Index> index;
+	const Index *last = nullptr;
+
+	void rebuild_index() {
+		index.clear();
+		for (auto &e : ranges) {
+			index.push_back(Index{e.get_start(), e.get_end(), &e});
+		}
+		std::sort(index.begin(), index.end(), [](const Index &a, const Index &b) { return a.start < b.start; });
+		last = nullptr;
+	}
+
+	__attribute__((noinline)) MemoryDMI *find_slow(uint64_t addr) {
+		/* first range starting after addr -> the predecessor is the only candidate */
+		auto it = std::upper_bound(index.begin(), index.end(), addr,
+		                           [](uint64_t addr, const Index &e) { return addr < e.start; });
+		if (it == index.begin()) {
+			return nullptr;
+		}
+		--it;
+		if (addr >= it->end) {
+			return nullptr;
+		}
+		last = &(*it);
+		return it->dmi;
+	}
+
+   public:
+	DMITable() = default;
+	/* index and last point into ranges -> no copies (moves and swaps keep the list nodes) */
+	DMITable(const DMITable &) = delete;
+	DMITable &operator=(const DMITable &) = delete;
+
+	void add(const MemoryDMI &dmi) {
+		for (auto &e : index) {
+			if (dmi.get_start() < e.end && e.start < dmi.get_end()) {
+				throw std::runtime_error("DMITable: dmi range overlaps existing dmi range");
+			}
+		}
+		ranges.push_back(dmi);
+		rebuild_index();
+	}
+
+	/* remove all ranges overlapping [start, end] -> returns true, if a range was removed */
+	bool invalidate(uint64_t start, uint64_t end) {
+		size_t n = ranges.size();
+		ranges.remove_if(
+		    [start, end](const MemoryDMI &e) { return e.get_start() <= end && start < e.get_end(); });
+		if (ranges.size() == n) {
+			return false;
+		}
+		rebuild_index();
+		return true;
+	}
+
+	void swap(DMITable &other) {
+		ranges.swap(other.ranges);
+		index.swap(other.index);
+		std::swap(last, other.last);
+	}
+
+	/* returns the range containing addr, or nullptr */
+	__always_inline MemoryDMI *find(uint64_t addr) {
+		if (likely(last != nullptr && addr >= last->start && addr < last->end)) {
+			return last->dmi;
+		}
+		return find_slow(addr);
+	}
+
+	/* returns the range containing [addr, addr + len), or nullptr */
+	__always_inline MemoryDMI *find(uint64_t addr, uint64_t len) {
+		MemoryDMI *dmi = find(addr);
+		if (dmi == nullptr || addr + len > dmi->get_end()) {
+			return nullptr;
+		}
+		return dmi;
+	}
+
+	bool empty() const {
+		return ranges.empty();
+	}
+};
+
+#endif /* RISCV_ISA_DMI_TABLE_H */
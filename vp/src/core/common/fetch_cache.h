@@ -0,0 +1,158 @@
+/*
+ * Fetch Cache (instruction TLB)
+ * Caches the translation of virtual code pages (fetch, i.e. X permission) to dmi-capable host memory, to speed up
+ * instruction fetches of the DBBCache on block creation and coherence checks (see CombinedMemoryInterface_T in mem.h):
+ *  * load_instr: the instruction is read directly from host memory (no mmu/TLB and dmi range lookups)
+ *  * translate_pc: the physical address is taken from the entry
+ *  * track_code_page: the code page tracker, the host page and the size of the leaf page are taken from the entry
+ * This is the fetch counterpart of the LSCache (data accesses).
+ *
+ * Entries are tagged with the translation context of the fetch (privilege level or no translation, see
+ * fetch_translated in MMU_T), because the mmu translates fetches of user and supervisor mode independently.
+ * The cache is flushed (see CombinedMemoryInterface_T in mem.h)
+ *  * together with the TLB of the mmu (flush_tlb): on every sfence.vma of the hart (LSCache fence_vma), page-scoped or
+ *    not. A remote fence (SBI) is executed as a local sfence.vma by the target hart, there is no cross-hart flush.
+ *  * on changes of the dmi ranges: new range, dmi_enable and dmi_invalidate (e.g. TLM invalidate_direct_mem_ptr)
+ * Writes of satp do not flush the cache (as the TLB of the mmu, the software has to execute sfence.vma).
+ */
+
+#ifndef RISCV_ISA_FETCH_CACHE_H
+#define RISCV_ISA_FETCH_CACHE_H
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include "code_page_tracker.h"
+#include "util/common.h"
+
+/******************************************************************************
+ * BEGIN: CONFIG
+ ******************************************************************************/
+
+/*
+ * enable/disable cache
+ * if disabled, all lookups miss
+ */
+#define FETCH_CACHE_ENABLED
+// #undef FETCH_CACHE_ENABLED
+
+/* number of entries (power of two, direct-mapped) */
+#define FETCH_CACHE_ENTRIES 64
+
+/*
+ * enable statistics
+ * printed with the statistics of the ISS
+ */
+// #define FETCH_CACHE_STATS_ENABLED
+#undef FETCH_CACHE_STATS_ENABLED
+
+/******************************************************************************
+ * END: CONFIG
+ ******************************************************************************/
+
+class FetchCache {
+   public:
+	/* translation contexts: privilege levels of translated fetches (0 = user, 1 = supervisor) or no translation */
+	static constexpr unsigned int CTX_NO_TRANSLATION = 2;
+
+	struct Entry {
+		/* virtual page | (context + 1) (0 = invalid) */
+		uint64_t tag;
+		uint64_t ppage;
+		/* size (log2) of the leaf page of the translation (> 12 for pages inside of superpages, see MMU_T) */
+		unsigned int page_shift;
+		uint8_t *host_page;
+		CodePageTracker *code_page_tracker;
+	};
+
+   private:
+	static constexpr unsigned int PAGE_SHIFT = 12;
+	static constexpr uint64_t PAGE_MASK = (1 << PAGE_SHIFT) - 1;
+
+#ifdef FETCH_CACHE_ENABLED
+	Entry entries[FETCH_CACHE_ENTRIES];
+#else
+	/* returned by insert */
+	Entry entries[1];
+#endif
+
+#ifdef FETCH_CACHE_STATS_ENABLED
+	struct {
+		uint64_t lookups;
+		uint64_t hits;
+		uint64_t flushs;
+	} stats = {};
+#define FETCH_CACHE_STATS_INC(_name) (stats._name++)
+#else
+#define FETCH_CACHE_STATS_INC(_name)
+#endif
+
+	static __always_inline uint64_t tag(uint64_t vaddr, unsigned int ctx) {
+		return (vaddr & ~PAGE_MASK) | (ctx + 1);
+	}
+
+	static __always_inline unsigned int idx(uint64_t vaddr) {
+#ifdef FETCH_CACHE_ENABLED
+		return (vaddr >> PAGE_SHIFT) & (FETCH_CACHE_ENTRIES - 1);
+#else
+		return 0;
+#endif
+	}
+
+   public:
+	FetchCache() {
+		flush();
+	}
+
+	void flush() {
+		FETCH_CACHE_STATS_INC(flushs);
+		memset(entries, 0, sizeof(entries));
+	}
+
+	/* returns the entry of the page containing vaddr in context ctx, or nullptr on miss */
+	__always_inline const Entry *lookup(uint64_t vaddr, unsigned int ctx) {
+		FETCH_CACHE_STATS_INC(lookups);
+#ifdef FETCH_CACHE_ENABLED
+		const Entry &e = entries[idx(vaddr)];
+		if (likely(e.tag == tag(vaddr, ctx))) {
+			FETCH_CACHE_STATS_INC(hits);
+			return &e;
+		}
+#endif
+		return nullptr;
+	}
+
+	const Entry *insert(uint64_t vaddr, unsigned int ctx, uint64_t ppage, unsigned int page_shift, uint8_t *host_page,
+	                    CodePageTracker *code_page_tracker) {
+		Entry &e = entries[idx(vaddr)];
+#ifdef FETCH_CACHE_ENABLED
+		e.tag = tag(vaddr, ctx);
+#endif
+		e.ppage = ppage;
+		e.page_shift = page_shift;
+		e.host_page = host_page;
+		e.code_page_tracker = code_page_tracker;
+		return &e;
+	}
+
+	void print_stats(uint64_t hart_id) {
+#ifdef FETCH_CACHE_STATS_ENABLED
+		std::cout << "============================================================================================="
+		             "==============================\n";
+		std::cout << "Fetch Cache Stats (hartId: " << hart_id << "):\n" << std::dec;
+		std::cout << " entries:                   " << FETCH_CACHE_ENTRIES << "\n";
+		std::cout << " flushs:                    " << stats.flushs << "\n";
+		std::cout << " lookups:                   " << stats.lookups << "\n";
+		std::cout << " hits:                      " << stats.hits << "\t\t("
+		          << (double)stats.hits / stats.lookups << ")\n";
+		std::cout << "============================================================================================="
+		             "==============================\n";
+		std::cout << std::endl;
+#endif
+	}
+};
+
+#undef FETCH_CACHE_STATS_INC
+
+#endif /* RISCV_ISA_FETCH_CACHE_H */
@@ -0,0 +1,223 @@
+/*
+ * Host FPU fast path for F/D arithmetic (hybrid FP engine)
+ * add, sub, mul, div and sqrt of binary32/binary64 values are executed on the host FPU (SSE2), if the result and the
+ * exception flags are known to be bit-identical to softfloat (RISC-V specialization). Otherwise, the operation is
+ * executed by softfloat:
+ *  * rounding mode: only round to nearest, ties to even (the host FPU runs in its default mode)
+ *  * NaN and infinite results (canonical NaN, invalid, overflow, division by zero), results that may underflow
+ * The exception flags of the fast path are derived arithmetically (the host MXCSR flags are not used, since clearing
+ * them with ldmxcsr on every operation is slower than softfloat):
+ *  * inexact: the rounding error of the operation is not zero. The error is calculated exactly with TwoSum (add/sub),
+ *    in binary64 (binary32 mul/div/sqrt), or with a fused multiply-add (binary64 mul/div/sqrt, only if the host has
+ *    FMA instructions).
+ *  * no other flags possible (see above)
+ * binary32 mul/div/sqrt are calculated in binary64 and rounded to binary32 (double rounding is innocuous for these
+ * operations, since 53 >= 2 * 24 + 2).
+ * See vp/tests/unit/fp_host_test.cpp for the randomized differential test against softfloat.
+ */
+
+#ifndef RISCV_ISA_FP_HOST_H
+#define RISCV_ISA_FP_HOST_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <softfloat/softfloat.hpp>
+
+#include "util/common.h"
+
+/* CONFIG: use the host FPU for F/D arithmetic (only available on x86_64) */
+#define FP_HOST_ENABLED
+// #undef FP_HOST_ENABLED
+
+#if defined(FP_HOST_ENABLED) && !(defined(__x86_64__) && defined(__SSE2_MATH__))
+#undef FP_HOST_ENABLED
+#endif
+
+namespace FpHost {
+
+#ifdef FP_HOST_ENABLED
+
+/* smallest magnitudes, where no underflow is possible (binary32) or where remainders are exact (binary64) */
+constexpr double F32_NO_UNDERFLOW = 0x1p-126;
+constexpr double F64_EXACT_REMAINDER = 0x1p-968;
+
+__always_inline bool rne() {
+	return softfloat_roundingMode == softfloat_round_near_even;
+}
+
+__always_inline bool has_fma() {
+	static const bool fma = __builtin_cpu_supports("fma");
+	return fma;
+}
+
+/* branchless, inexact results are not predictable */
+__always_inline void set_inexact(bool inexact) {
+	softfloat_exceptionFlags |= inexact * softfloat_flag_inexact;
+}
+
+__always_inline float to_host(float32_t x) {
+	float f;
+	memcpy(&f, &x.v, sizeof(f));
+	return f;
+}
+
+__always_inline double to_host(float64_t x) {
+	double d;
+	memcpy(&d, &x.v, sizeof(d));
+	return d;
+}
+
+__always_inline float32_t from_host(float f) {
+	float32_t x;
+	memcpy(&x.v, &f, sizeof(f));
+	return x;
+}
+
+__always_inline float64_t from_host(double d) {
+	float64_t x;
+	memcpy(&x.v, &d, sizeof(d));
+	return x;
+}
+
+/* rounding error of r = x + y is zero (TwoSum, r must be finite) */
+template <typename T>
+__always_inline bool sum_is_exact(T x, T y, T r) {
+	T yv = r - x;
+	T xv = r - yv;
+	return ((x - xv) + (y - yv)) == 0;
+}
+
+/* add (y) or sub (-y) */
+template <typename T_sf, typename T>
+__always_inline bool add(T x, T y, T_sf &res) {
+	if (likely(rne())) {
+		T r = x + y;
+		if (likely(std::isfinite(r))) {
+			set_inexact(!sum_is_exact(x, y, r));
+			res = from_host(r);
+			return true;
+		}
+	}
+	return false;
+}
+
+inline float32_t f32_add(float32_t a, float32_t b) {
+	float32_t res;
+	return add(to_host(a), to_host(b), res) ? res : ::f32_add(a, b);
+}
+
+inline float32_t f32_sub(float32_t a, float32_t b) {
+	float32_t res;
+	return add(to_host(a), -to_host(b), res) ? res : ::f32_sub(a, b);
+}
+
+inline float64_t f64_add(float64_t a, float64_t b) {
+	float64_t res;
+	return add(to_host(a), to_host(b), res) ? res : ::f64_add(a, b);
+}
+
+inline float64_t f64_sub(float64_t a, float64_t b) {
+	float64_t res;
+	return add(to_host(a), -to_host(b), res) ? res : ::f64_sub(a, b);
+}
+
+inline float32_t f32_mul(float32_t a, float32_t b) {
+	if (likely(rne())) {
+		/* exact in binary64 */
+		double p = (double)to_host(a) * (double)to_host(b);
+		float r = p;
+		if (likely(std::isfinite(r) && (std::fabs(p) >= F32_NO_UNDERFLOW || p == 0))) {
+			set_inexact(r != p);
+			return from_host(r);
+		}
+	}
+	return ::f32_mul(a, b);
+}
+
+inline float32_t f32_div(float32_t a, float32_t b) {
+	if (likely(rne())) {
+		double x = to_host(a);
+		double y = to_host(b);
+		double q = x / y;
+		float r = q;
+		if (likely(std::isfinite(r) && (std::fabs(q) >= F32_NO_UNDERFLOW || (q == 0 && x == 0 && std::isfinite(y))))) {
+			/* r * y is exact in binary64 */
+			set_inexact((double)r * y != x);
+			return from_host(r);
+		}
+	}
+	return ::f32_div(a, b);
+}
+
+inline float32_t f32_sqrt(float32_t a) {
+	if (likely(rne())) {
+		double x = to_host(a);
+		float r = std::sqrt(x);
+		if (likely(std::isfinite(r) && x >= 0)) {
+			/* r * r is exact in binary64 */
+			set_inexact((double)r * r != x);
+			return from_host(r);
+		}
+	}
+	return ::f32_sqrt(a);
+}
+
+inline float64_t f64_mul(float64_t a, float64_t b) {
+	if (likely(rne() && has_fma())) {
+		double x = to_host(a);
+		double y = to_host(b);
+		double r = x * y;
+		if (likely(std::isfinite(r) && (std::fabs(r) >= F64_EXACT_REMAINDER || (r == 0 && (x == 0 || y == 0))))) {
+			set_inexact(std::fma(x, y, -r) != 0);
+			return from_host(r);
+		}
+	}
+	return ::f64_mul(a, b);
+}
+
+inline float64_t f64_div(float64_t a, float64_t b) {
+	if (likely(rne() && has_fma())) {
+		double x = to_host(a);
+		double y = to_host(b);
+		double r = x / y;
+		if (likely((std::isfinite(r) && std::fabs(r) >= F64_EXACT_REMAINDER && std::fabs(x) >= F64_EXACT_REMAINDER) ||
+		           (r == 0 && x == 0 && std::isfinite(y)))) {
+			set_inexact(std::fma(-r, y, x) != 0);
+			return from_host(r);
+		}
+	}
+	return ::f64_div(a, b);
+}
+
+inline float64_t f64_sqrt(float64_t a) {
+	if (likely(rne() && has_fma())) {
+		double x = to_host(a);
+		double r = std::sqrt(x);
+		if (likely((std::isfinite(r) && x >= F64_EXACT_REMAINDER) || x == 0)) {
+			set_inexact(std::fma(-r, r, x) != 0);
+			return from_host(r);
+		}
+	}
+	return ::f64_sqrt(a);
+}
+
+#else /* FP_HOST_ENABLED */
+
+/* host FPU not available -> softfloat */
+using ::f32_add;
+using ::f32_div;
+using ::f32_mul;
+using ::f32_sqrt;
+using ::f32_sub;
+using ::f64_add;
+using ::f64_div;
+using ::f64_mul;
+using ::f64_sqrt;
+using ::f64_sub;
+
+#endif /* FP_HOST_ENABLED */
+
+}  // namespace FpHost
+
+#endif /* RISCV_ISA_FP_HOST_H */
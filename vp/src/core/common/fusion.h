@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2024-2026 Manfred Schlaegl <manfred.schlaegl@gmx.at>
+ * see dbbcache.h
+ */
+
+#ifndef RISCV_ISA_FUSION_H
+#define RISCV_ISA_FUSION_H
+
+#include <array>
+
+#include "instr.h"
+
+/*
+ * Macro-op fusion: common pairs of consecutive instructions (idioms), which are dispatched at once by the DBBCache
+ * (see "Macro-op fusion" in dbbcache.h)
+ * The second instruction of all pairs depends on the result of the first one. The ISS executes the pair in one
+ * handler (first operation inline, then a direct jump to the second operation).
+ */
+namespace Fusion {
+
+enum Id {
+	NONE = 0,
+
+	/* li/la (32 bit immediates, pc relative addresses) */
+	LUI_ADDI,
+	LUI_ADDIW,
+	AUIPC_ADDI,
+
+	/* far calls and tail calls */
+	AUIPC_JALR,
+	AUIPC_JR,
+
+	/* pc relative loads (e.g. global variables) */
+	AUIPC_LW,
+	AUIPC_LD,
+
+	/* zero extension */
+	SLLI_SRLI,
+
+	/* loop counter and compare-and-branch */
+	ADDI_BNE,
+	ADDI_BLT,
+	ADDI_BLTU,
+	ADDIW_BNE,
+
+	NUMBER_OF_FUSIONS
+};
+
+const std::array<const char *, NUMBER_OF_FUSIONS> fusionStr = {
+    "NONE",     "LUI_ADDI", "LUI_ADDIW", "AUIPC_ADDI", "AUIPC_JALR", "AUIPC_JR",  "AUIPC_LW",
+    "AUIPC_LD", "SLLI_SRLI", "ADDI_BNE", "ADDI_BLT",   "ADDI_BLTU",  "ADDIW_BNE",
+};
+
+/* pair of the (decoded and expanded) instructions instr1 and instr2 (NONE, if they can not be fused) */
+inline Id match(Operation::OpId opId1, Instruction instr1, Operation::OpId opId2, Instruction instr2) {
+	using namespace Operation;
+
+	/* result of the first instruction is used by the second (rd != x0, see *_NOP operations) */
+	unsigned int rd = instr1.rd();
+	bool rs1 = instr2.rs1() == rd;
+	bool rs1_or_rs2 = rs1 || instr2.rs2() == rd;
+
+	switch (opId1) {
+		case LUI:
+			if (opId2 == ADDI && rs1) {
+				return LUI_ADDI;
+			}
+			if (opId2 == ADDIW && rs1) {
+				return LUI_ADDIW;
+			}
+			break;
+		case AUIPC:
+			if (!rs1) {
+				break;
+			}
+			switch (opId2) {
+				case ADDI:
+					return AUIPC_ADDI;
+				case JALR:
+					return AUIPC_JALR;
+				case JR:
+					return AUIPC_JR;
+				case LW:
+					return AUIPC_LW;
+				case LD:
+					return AUIPC_LD;
+				default:
+					break;
+			}
+			break;
+		case SLLI:
+			if (opId2 == SRLI && rs1 && instr1.shamt() == instr2.shamt()) {
+				return SLLI_SRLI;
+			}
+			break;
+		case ADDI:
+			if (!rs1_or_rs2) {
+				break;
+			}
+			switch (opId2) {
+				case BNE:
+					return ADDI_BNE;
+				case BLT:
+					return ADDI_BLT;
+				case BLTU:
+					return ADDI_BLTU;
+				default:
+					break;
+			}
+			break;
+		case ADDIW:
+			if (opId2 == BNE && rs1_or_rs2) {
+				return ADDIW_BNE;
+			}
+			break;
+		default:
+			break;
+	}
+	return NONE;
+}
+
+}  // namespace Fusion
+
+#endif /* RISCV_ISA_FUSION_H */
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <functional>
+
+/*
+ * Interface of an ISS to its host thread, if the hart runs in parallel to other harts (see parallel_runner.h)
+ * The ISS must not enter SystemC directly in this case (no wait, no transactions, no access to SystemC modules).
+ */
+struct hart_thread_if {
+	virtual ~hart_thread_if() {}
+
+	/* end of the quantum (instead of quantum_keeper.sync) -> blocks until all harts reached the quantum end */
+	virtual void sync() = 0;
+
+	/* wait for interrupt (instead of waiting for the wfi event) -> blocks until the next quantum */
+	virtual void idle() = 0;
+
+	/* execute fn in the SystemC context (e.g. transactions) -> blocks until fn was executed */
+	virtual void call(const std::function<void(void)> &fn) = 0;
+
+	/* true, if called by the host thread of the hart */
+	virtual bool is_current() const = 0;
+};
+
+/* thrown by hart_thread_if functions to unwind the ISS on the end of the simulation */
+struct HartThreadStop {};
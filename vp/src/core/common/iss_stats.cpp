@@ -75,6 +75,16 @@ void ISSStats::print() {
 		std::cout << "    " << tmp << ISSSTATS_STAT_RATE_ONLY(s.trap[trapnr], s.trap_sum);
 	}
 
+	std::cout << " fusion_sum:                " << ISSSTATS_STAT_RATE_CNT(s.fusion_sum);
+	for (unsigned int id = 0; id < Fusion::NUMBER_OF_FUSIONS; id++) {
+		if (s.fusion[id] == 0) {
+			continue;
+		}
+		char tmp[255];
+		sprintf(tmp, "%-14s:    %10lu", Fusion::fusionStr.at(id), s.fusion[id]);
+		std::cout << "    " << tmp << ISSSTATS_STAT_RATE_ONLY(s.fusion[id], s.fusion_sum);
+	}
+
 #ifdef ISS_STATS_OUTPUT_OPID_STATS_ENABLED
 	std::cout << " op_sum:                  " << s.op_sum << "\n";
 	for (unsigned int opId = 0; opId < Operation::OpId::NUMBER_OF_OPERATIONS; opId++) {
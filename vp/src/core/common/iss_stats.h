@@ -8,6 +8,7 @@
 #include <cstdint>
 #include <iostream>
 
+#include "fusion.h"
 #include "instr.h"
 #include "irq_if.h"
 
@@ -55,6 +56,7 @@ class ISSStatsDummy {
 	void inc_irq_trig_sw() {}
 	void inc_trap(unsigned int trapnr) {}
 	void inc_op(Operation::OpId opId) {}
+	void inc_fusion(Fusion::Id id) {}
 	void print() {}
 };
 
@@ -99,6 +101,8 @@ class ISSStats : public ISSStatsDummy {
 		selem_t trap[TRAPNR_MAX + 1];
 		selem_t op_sum;
 		selem_t op[Operation::OpId::NUMBER_OF_OPERATIONS];
+		selem_t fusion_sum;
+		selem_t fusion[Fusion::NUMBER_OF_FUSIONS];
 	} s;
 
    public:
@@ -202,6 +206,10 @@ class ISSStats : public ISSStatsDummy {
 		s.op_sum++;
 		s.op[opId]++;
 	}
+	void inc_fusion(Fusion::Id id) {
+		s.fusion_sum++;
+		s.fusion[id]++;
+	}
 	void inc_irq_trig_ext(PrivilegeLevel level) {
 		s.irq_trig_sum++;
 		s.irq_trig_ext[level + 1]++;
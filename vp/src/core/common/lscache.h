@@ -17,7 +17,10 @@
 
 #include <climits>
 #include <cstdint>
+#include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "lscache_stats.h"
 #include "mem_if.h"
@@ -48,6 +51,36 @@
 // #define LSCACHE_STATS_ENABLED
 #undef LSCACHE_STATS_ENABLED
 
+/*
+ * default geometry (see Cache configuration below)
+ * can be changed per hart with the PropertyTree (ISS.<name>.lscache_sets, lscache_ways, lscache_victims)
+ * sets and ways: power of two, victims: 0 = no victim buffer
+ * Measured with lscache-replay (vp/tests/unit/lscache_replay.cpp, host replay of synthetic access patterns, memory stub
+ * behind the cache, 4M accesses per pattern; miss rate in %, ns per access in brackets):
+ *   geometry    memcpy       segments     random-512   random-2048  zipf         zipf-flush
+ *   256x1+0     100.0 (36)   12.1 (17)    57.5 (74)    89.8 (106)   53.1 (126)   53.7 (93)
+ *   256x1+8       0.1 (15)    4.9 (15)    56.1 (65)    89.4 (150)   50.5 (117)   51.1 (118)
+ *   1024x1+0      0.0 (4)     0.0 (7)      0.0 (9)     57.5 (76)    34.4 (65)    38.8 (67)
+ *   256x4+8       0.0 (14)    0.0 (10)     0.0 (37)    57.1 (189)   25.9 (150)   30.2 (140)
+ *   512x2+8       0.0 (6)     0.0 (9)      0.0 (14)    57.1 (170)   28.0 (121)   32.3 (115)
+ *   1024x2+16     0.0 (6)     0.0 (9)      0.0 (14)     0.0 (62)    17.2 (103)   27.3 (117)
+ *   1024x4+16     0.0 (6)     0.0 (9)      0.0 (14)     0.0 (60)     5.1 (58)    24.4 (83)
+ * -> 1024x4+16 has the lowest miss rates of all patterns (no conflict misses of the direct-mapped 256x1+0 on buffers
+ * and segments at MiB aligned addresses, 16MiB working set). Hits in way 0 cost about the same as in the direct-mapped
+ * cache; hits in other ways (promotion) and flushes (64KiB per hart) are more expensive, 1024x1+0 is the alternative
+ * for workloads without conflicts. Times are from a single run on a loaded host (noisy), see vp/tests/lscache-bench for
+ * comparisons of geometries with the VPs.
+ */
+#define LSCACHE_DEFAULT_SETS 1024
+#define LSCACHE_DEFAULT_WAYS 4
+#define LSCACHE_DEFAULT_VICTIMS 16
+
+/*
+ * number of superpage entries (see Cache configuration below)
+ * 0 = no superpage entries
+ */
+#define LSCACHE_SUPERPAGES 8
+
 /******************************************************************************
  * END: CONFIG
  ******************************************************************************/
@@ -56,7 +89,11 @@
  * BEGIN: DUMMY/INTERFACE IMPLEMENTATION
  ******************************************************************************/
 
-template <typename T_sxlen_t, typename T_uxlen_t>
+/*
+ * forced_enabled: same as LSCACHE_FORCED_ENABLED, but only for this type (e.g. for an ISS with fixed configuration,
+ * see ISS_CT_CACHES_FORCED_ENABLED in the rv32/rv64 ISS)
+ */
+template <typename T_sxlen_t, typename T_uxlen_t, bool forced_enabled = false>
 class LSCache_IF_T {
    protected:
 	using dmemif_t = data_memory_if_T<T_sxlen_t, T_uxlen_t>;
@@ -81,13 +118,13 @@ class LSCache_IF_T {
 #ifdef LSCACHE_FORCED_ENABLED
 		ena = true;
 #endif
-		this->enabled = ena;
+		this->enabled = ena || forced_enabled;
 	}
 	__always_inline bool is_enabled() const {
 #ifdef LSCACHE_FORCED_ENABLED
 		return true;
 #else
-		return enabled;
+		return forced_enabled || enabled;
 #endif
 	}
 
@@ -101,6 +138,17 @@ class LSCache_IF_T {
 		return 0;
 	}
 
+	void set_geometry(unsigned int, unsigned int, unsigned int) {}
+	unsigned int get_sets() const {
+		return 0;
+	}
+	unsigned int get_ways() const {
+		return 0;
+	}
+	unsigned int get_victims() const {
+		return 0;
+	}
+
 	void print_stats() {}
 
 	__always_inline void fence() {
@@ -145,9 +193,21 @@ class LSCache_IF_T {
 	__always_inline void store_byte(uint64_t addr, uint8_t value) {
 		data_mem->store_byte(addr, value);
 	}
+
+	/*
+	 * bulk accesses (e.g. vector loads/stores, see v.h)
+	 * returns the host address of len bytes at addr (unaligned, within one page), or nullptr if not cached
+	 * (-> the caller has to use the load/store functions above, which fill the cache)
+	 */
+	__always_inline void *get_host_addr_load(uint64_t, uint64_t) {
+		return nullptr;
+	}
+	__always_inline void *get_host_addr_store(uint64_t, uint64_t) {
+		return nullptr;
+	}
 };
-template <typename T_sxlen_t, typename T_uxlen_t>
-using LSCacheDummy_T = LSCache_IF_T<T_sxlen_t, T_uxlen_t>;
+template <typename T_sxlen_t, typename T_uxlen_t, bool forced_enabled = false>
+using LSCacheDummy_T = LSCache_IF_T<T_sxlen_t, T_uxlen_t, forced_enabled>;
 
 /******************************************************************************
  * END: DUMMY/INTERFACE IMPLEMENTATION
@@ -163,29 +223,46 @@ using LSCacheDummy_T = LSCache_IF_T<T_sxlen_t, T_uxlen_t>;
  * 64 bit addr: 0xFFFF FFFF FFF|F F|FFF
  *                TAG          |IDX|OFFS (4KiB page)
  * OFF: 12 bit
- * IDX: 8 bit -> 256 pages
- * TAG: 64 - 12 - 8 = 44 bit -> uint64_t necessary, but
- * lowest bits is used as load/store valid
+ * IDX: log2(sets) bit (e.g. 8 bit -> 256 sets)
+ * TAG: page address (64 - 12 bit, includes the IDX bits -> independent of the number of sets) -> uint64_t necessary,
+ * but lowest bits is used as load/store valid
  * NOTE: we need a flag to indicate stores because a successful load on an address does not automatically mean, that
  * a store is allowed (permissions in page table)
  *
+ * Geometry: sets x ways + victims (see set_geometry and LSCACHE_DEFAULT_*)
+ * 1. Each set holds ways entries, ordered by the last use (way 0 = most recently used). The fast path only checks way
+ * 0, all other ways are checked on a miss in way 0. A hit in another way moves the entry to way 0.
+ * 2. Entries evicted from a set are moved to a small, fully associative victim buffer (round-robin replacement). The
+ * victim buffer is checked after all ways missed. A hit swaps the entry with the least recently used entry of the set.
+ * -> sets x 1 + 0 is the original direct-mapped cache (256 sets -> 1MiB working set). More ways and victims avoid
+ * ping-pong misses on pages mapping to the same set (e.g. stack, heap and data of a program), more sets increase the
+ * working set. See tests/lscache-bench to compare geometries and the statistics (conflict/capacity misses) in
+ * lscache_stats.h.
+ *
+ * Superpages: Accesses to superpages (e.g. Sv39 megapages and gigapages of the Linux kernel linear map) additionally
+ * create a superpage entry (fully associative, LSCACHE_SUPERPAGES, round-robin replacement), if the whole superpage is
+ * backed by a single dmi range (see get_last_dmi_superpage_host_addr in mem_if.h). Superpage entries are checked
+ * after ways and victims and refill the 4KiB entry of the set -> all 4KiB pages of a superpage are served without
+ * calls to the memory interface. Store permission is only given for superpages without code pages.
+ *
  * NOTES/TODOS:
  * We are using direct dereferencing of poiners without any costly checks, which leads to problem on unaligned accesses:
  * 1. See: dmi.h and https://blog.quarkslab.com/unaligned-accesses-in-cc-what-why-and-solutions-to-do-it-properly.html
  * 2. A unaligned access on a page boundary may leads to problems (address + length may be on different page) -> see
  * comment in mem.h CombinedMemoryInterface_T::load_instr However, load/stores are always aligned (see ISS), so we can
- * ignore this.
- * TODO: Check uses of load/stores in vector (v.h) -> implement dedicated load/stores for vector, that
- *  1. Properly handle unaligned access (will hurt performance)
- *  2. Are optimized for vector (load/store of multiple loads) (will improve performance)
- * TODO: check, if checks for bus lock on load are really necessary (atomic operations?)
+ * ignore this. Vector loads/stores (v.h) use get_host_addr_load/store (bulk accesses, unaligned, within one page)
+ * and fall back to element accesses of the memory interface for unaligned elements, which are not cached or cross a
+ * page boundary.
  * TODO: check inline vs __always_inline
+ *
+ * NOTE: The bus is only locked for atomics on memory without dmi (e.g. mmio, see CombinedMemoryInterface_T in mem.h),
+ * atomics on dmi memory do not bypass the cache.
  */
 
-template <typename T_sxlen_t, typename T_uxlen_t>
-class LSCache_T : public LSCache_IF_T<T_sxlen_t, T_uxlen_t> {
+template <typename T_sxlen_t, typename T_uxlen_t, bool forced_enabled = false>
+class LSCache_T : public LSCache_IF_T<T_sxlen_t, T_uxlen_t, forced_enabled> {
    protected:
-	using super = LSCache_IF_T<T_sxlen_t, T_uxlen_t>;
+	using super = LSCache_IF_T<T_sxlen_t, T_uxlen_t, forced_enabled>;
 	using dmemif_t = data_memory_if_T<T_sxlen_t, T_uxlen_t>;
 #ifdef LSCACHE_STATS_ENABLED
 	using lscachestats_t = LSCacheStats_T<LSCache_T>;
@@ -196,12 +273,12 @@ class LSCache_T : public LSCache_IF_T<T_sxlen_t, T_uxlen_t> {
 
 	lscachestats_t stats = lscachestats_t(*this);
 
-#define LSCACHE_SETS (1 << 8)
+#define LSCACHE_PAGE_SHIFT 12
 #define LSCACHE_OFF(_virt_page_addr) ((_virt_page_addr) & 0x00FFF)
-#define LSCACHE_IDX(_virt_page_addr) (((_virt_page_addr) & 0xFF000) >> 12)
-#define LSCACHE_TAG(_virt_page_addr) ((_virt_page_addr) & (~0xFFFFF))
+#define LSCACHE_TAG(_virt_page_addr) ((_virt_page_addr) & (~0xFFF))
 #define LSCACHE_LOAD_VALID_BITS (1 << 0)
 #define LSCACHE_STORE_VALID_BITS ((1 << 1) | LSCACHE_LOAD_VALID_BITS)  // load & store
+#define LSCACHE_STORE_ONLY_BITS (1 << 1)
 #define LSCACHE_IS_LOAD_VALID(_virt_page_addr) ((_virt_page_addr) & LOAD_VALID_BITS)
 #define LSCACHE_IS_STORE_VALID(_virt_page_addr) ((_virt_page_addr) & STORE_VALID_BITS)
 
@@ -209,45 +286,173 @@ class LSCache_T : public LSCache_IF_T<T_sxlen_t, T_uxlen_t> {
 		T_uxlen_t tag_valid;
 		void *host_page_addr;
 	};
-	struct Entry cache[LSCACHE_SETS];
+	/* page_mask: 4KiB page bits inside of the superpage */
+	struct SuperpageEntry {
+		uint64_t tag_valid;
+		uint64_t page_mask;
+		uint8_t *host_superpage_addr;
+	};
+	/* sets x ways entries (set i: entries i * ways .. i * ways + ways - 1) */
+	std::vector<Entry> cache;
+	std::vector<SuperpageEntry> superpages = std::vector<SuperpageEntry>(LSCACHE_SUPERPAGES);
+	unsigned int superpage_next = 0;
+	std::vector<Entry> victims;
+	unsigned int victim_next = 0;
+	uint64_t set_mask = 0;
+	unsigned int ways_log2 = 0;
+	unsigned int ways = 0;
+
+	static bool is_pow2(unsigned int val) {
+		return val != 0 && (val & (val - 1)) == 0;
+	}
 
 	unsigned int get_nentries_valid_masked(uint32_t valid_bits) const {
 		unsigned int n = 0;
-		for (unsigned int idx = 0; idx < LSCACHE_SETS; idx++) {
-			if ((cache[idx].tag_valid & valid_bits) == valid_bits) {
+		for (const Entry &e : cache) {
+			if ((e.tag_valid & valid_bits) == valid_bits) {
+				n++;
+			}
+		}
+		for (const Entry &e : victims) {
+			if ((e.tag_valid & valid_bits) == valid_bits) {
 				n++;
 			}
 		}
 		return n;
 	}
 
+	__always_inline Entry *get_set(uint64_t virt_addr) {
+		return &cache[((virt_addr >> LSCACHE_PAGE_SHIFT) & set_mask) << ways_log2];
+	}
+
+	static __always_inline bool is_same_page(const Entry &e, uint64_t tag) {
+		return (e.tag_valid & ~LSCACHE_STORE_VALID_BITS) == tag && (e.tag_valid & LSCACHE_LOAD_VALID_BITS);
+	}
+
+	/* move entry way of set to way 0 (most recently used) */
+	__always_inline void promote(Entry *set, unsigned int way) {
+		Entry e = set[way];
+		for (; way > 0; way--) {
+			set[way] = set[way - 1];
+		}
+		set[0] = e;
+	}
+
+	inline void evict(const Entry &e) {
+		if (victims.empty() || !(e.tag_valid & LSCACHE_LOAD_VALID_BITS)) {
+			return;
+		}
+		victims[victim_next] = e;
+		if (++victim_next == victims.size()) {
+			victim_next = 0;
+		}
+	}
+
 	inline void update(uint64_t virt_addr, void *host_page_addr, uint32_t valid_bits) {
-		int idx = LSCACHE_IDX(virt_addr);
-		uint64_t tag_valid = LSCACHE_TAG(virt_addr) | valid_bits;
-		cache[idx].tag_valid = tag_valid;
-		cache[idx].host_page_addr = host_page_addr;
+		Entry *set = get_set(virt_addr);
+		uint64_t tag = LSCACHE_TAG(virt_addr);
+
+		/* page already cached with other permissions (e.g. load only) -> replace, otherwise evict lru */
+		unsigned int way = 0;
+		while (way < ways - 1 && !is_same_page(set[way], tag)) {
+			way++;
+		}
+		if (!is_same_page(set[way], tag)) {
+			evict(set[way]);
+		}
+		set[way].tag_valid = tag | valid_bits;
+		set[way].host_page_addr = host_page_addr;
+		promote(set, way);
+
+		/* remove outdated copy from the victim buffer */
+		for (Entry &e : victims) {
+			if (is_same_page(e, tag)) {
+				e.tag_valid = 0;
+			}
+		}
+	}
+
+	/* way 0 missed -> check other ways and victims (ignore_bits: valid bits not needed for the access) */
+	__attribute__((noinline)) Entry *try_get_from_ways_victims(Entry *set, uint64_t tag_valid, T_uxlen_t ignore_bits) {
+		for (unsigned int way = 1; way < ways; way++) {
+			if (tag_valid == (set[way].tag_valid & ~ignore_bits)) {
+				promote(set, way);
+				stats.inc_hit_way();
+				return &set[0];
+			}
+		}
+		for (Entry &e : victims) {
+			if (tag_valid == (e.tag_valid & ~ignore_bits)) {
+				std::swap(e, set[ways - 1]);
+				promote(set, ways - 1);
+				stats.inc_hit_victim();
+				return &set[0];
+			}
+		}
+		for (SuperpageEntry &e : superpages) {
+			if ((tag_valid & ~e.page_mask) == (e.tag_valid & ~ignore_bits)) {
+				uint64_t virt_page_addr = tag_valid & ~LSCACHE_STORE_VALID_BITS;
+				update(virt_page_addr, e.host_superpage_addr + (virt_page_addr & e.page_mask),
+				       e.tag_valid & LSCACHE_STORE_VALID_BITS);
+				stats.inc_hit_superpage();
+				return &set[0];
+			}
+		}
+		return nullptr;
+	}
+
+	void try_add_superpage(uint64_t virt_addr, uint32_t valid_bits) {
+		unsigned int page_shift;
+		uint8_t *host_superpage_addr = (uint8_t *)this->data_mem->get_last_dmi_superpage_host_addr(
+		    valid_bits == LSCACHE_STORE_VALID_BITS, page_shift);
+		if (host_superpage_addr == nullptr) {
+			return;
+		}
+
+		uint64_t page_mask = ((uint64_t(1) << page_shift) - 1) & ~0xFFF;
+		uint64_t tag = LSCACHE_TAG(virt_addr) & ~page_mask;
+		/* replace entry of the same superpage (e.g. load only) or next entry */
+		SuperpageEntry *e = &superpages[superpage_next];
+		for (SuperpageEntry &cur : superpages) {
+			if ((cur.tag_valid & ~LSCACHE_STORE_VALID_BITS) == tag && (cur.tag_valid & LSCACHE_LOAD_VALID_BITS)) {
+				e = &cur;
+				break;
+			}
+		}
+		if (e == &superpages[superpage_next] && ++superpage_next == superpages.size()) {
+			superpage_next = 0;
+		}
+		e->tag_valid = tag | valid_bits;
+		e->page_mask = page_mask;
+		e->host_superpage_addr = host_superpage_addr;
 	}
 
 	__always_inline void *try_get_from_cache_load(uint64_t virt_addr) {
-		int idx = LSCACHE_IDX(virt_addr);
+		Entry *e = get_set(virt_addr);
 		uint64_t tag_valid = LSCACHE_TAG(virt_addr) | LSCACHE_LOAD_VALID_BITS;
 
-		if (likely(tag_valid == (cache[idx].tag_valid & ~(1 << 1)))) {
-			stats.inc_hit_load();
-			return (((uint8_t *)cache[idx].host_page_addr) + LSCACHE_OFF(virt_addr));
+		if (unlikely(tag_valid != (e->tag_valid & ~LSCACHE_STORE_ONLY_BITS))) {
+			e = try_get_from_ways_victims(e, tag_valid, LSCACHE_STORE_ONLY_BITS);
+			if (e == nullptr) {
+				return nullptr;
+			}
 		}
-		return nullptr;
+		stats.inc_hit_load(virt_addr);
+		return (((uint8_t *)e->host_page_addr) + LSCACHE_OFF(virt_addr));
 	}
 
 	__always_inline void *try_get_from_cache_store(uint64_t virt_addr) {
-		int idx = LSCACHE_IDX(virt_addr);
+		Entry *e = get_set(virt_addr);
 		uint64_t tag_valid = LSCACHE_TAG(virt_addr) | LSCACHE_STORE_VALID_BITS;
 
-		if (likely(tag_valid == cache[idx].tag_valid)) {
-			stats.inc_hit_store();
-			return (((uint8_t *)cache[idx].host_page_addr) + LSCACHE_OFF(virt_addr));
+		if (unlikely(tag_valid != e->tag_valid)) {
+			e = try_get_from_ways_victims(e, tag_valid, 0);
+			if (e == nullptr) {
+				return nullptr;
+			}
 		}
-		return nullptr;
+		stats.inc_hit_store(virt_addr);
+		return (((uint8_t *)e->host_page_addr) + LSCACHE_OFF(virt_addr));
 	}
 
 	void try_add_to_cache(uint64_t virt_addr, uint32_t valid_bits) {
@@ -256,7 +461,11 @@ class LSCache_T : public LSCache_IF_T<T_sxlen_t, T_uxlen_t> {
 			stats.inc_dmi();
 			// do not add to cache, if disabled
 			if (likely(this->is_enabled())) {
+				stats.inc_miss(virt_addr);
 				update(virt_addr, host_page_addr, valid_bits);
+				if (!superpages.empty()) {
+					try_add_superpage(virt_addr, valid_bits);
+				}
 			}
 		} else {
 			stats.inc_no_dmi();
@@ -308,16 +517,45 @@ class LSCache_T : public LSCache_IF_T<T_sxlen_t, T_uxlen_t> {
 
    public:
 	LSCache_T() {
+		set_geometry(LSCACHE_DEFAULT_SETS, LSCACHE_DEFAULT_WAYS, LSCACHE_DEFAULT_VICTIMS);
 		init(false, 0, nullptr);
 	}
 
+	/* change the geometry (see Cache configuration above) -> flushes the cache */
+	void set_geometry(unsigned int sets, unsigned int ways, unsigned int victims) {
+		if (!is_pow2(sets) || !is_pow2(ways)) {
+			throw std::runtime_error("LSCache: sets (" + std::to_string(sets) + ") and ways (" + std::to_string(ways) +
+			                         ") must be a power of two");
+		}
+		set_mask = sets - 1;
+		this->ways = ways;
+		ways_log2 = __builtin_ctz(ways);
+		cache.assign(sets * ways, Entry{});
+		this->victims.assign(victims, Entry{});
+		flush();
+	}
+	unsigned int get_sets() const {
+		return set_mask + 1;
+	}
+	unsigned int get_ways() const {
+		return ways;
+	}
+	unsigned int get_victims() const {
+		return victims.size();
+	}
+
 	void init(bool enabled, uint64_t hartId, dmemif_t *data_mem) {
 		flush();
 		super::init(enabled, hartId, data_mem);
 	}
 
 	inline void flush() {
-		memset(cache, 0, LSCACHE_SETS * sizeof(Entry));
+		memset(cache.data(), 0, cache.size() * sizeof(Entry));
+		memset(victims.data(), 0, victims.size() * sizeof(Entry));
+		victim_next = 0;
+		memset(superpages.data(), 0, superpages.size() * sizeof(SuperpageEntry));
+		superpage_next = 0;
+		stats.flush();
 	}
 
 	void enable(bool ena) {
@@ -338,7 +576,7 @@ class LSCache_T : public LSCache_IF_T<T_sxlen_t, T_uxlen_t> {
 	}
 
 	unsigned int get_nentries_max() const {
-		return LSCACHE_SETS;
+		return cache.size() + victims.size();
 	}
 	unsigned int get_nentries_valid_load() const {
 		return get_nentries_valid_masked(LSCACHE_LOAD_VALID_BITS);
@@ -391,6 +629,29 @@ class LSCache_T : public LSCache_IF_T<T_sxlen_t, T_uxlen_t> {
 	__always_inline void store_byte(uint64_t addr, uint8_t value) {
 		store<uint8_t, &dmemif_t::store_byte>(addr, value);
 	}
+
+	__always_inline void *get_host_addr_load(uint64_t addr, uint64_t len) {
+		if (unlikely(LSCACHE_OFF(addr) + len > (1 << LSCACHE_PAGE_SHIFT))) {
+			return nullptr;
+		}
+		stats.inc_loads();
+		if (unlikely(this->data_mem->is_bus_locked())) {
+			stats.inc_bus_locked();
+			return nullptr;
+		}
+		return try_get_from_cache_load(addr);
+	}
+	__always_inline void *get_host_addr_store(uint64_t addr, uint64_t len) {
+		if (unlikely(LSCACHE_OFF(addr) + len > (1 << LSCACHE_PAGE_SHIFT))) {
+			return nullptr;
+		}
+		stats.inc_stores();
+		if (unlikely(this->data_mem->is_bus_locked())) {
+			stats.inc_bus_locked();
+			return nullptr;
+		}
+		return try_get_from_cache_store(addr);
+	}
 };
 
 /******************************************************************************
@@ -401,11 +662,11 @@ class LSCache_T : public LSCache_IF_T<T_sxlen_t, T_uxlen_t> {
  * CACHE SELECT
  ******************************************************************************/
 
-template <typename T_sxlen_t, typename T_uxlen_t>
+template <typename T_sxlen_t, typename T_uxlen_t, bool forced_enabled = false>
 #ifdef LSCACHE_ENABLED
-using LSCacheDefault_T = LSCache_T<T_sxlen_t, T_uxlen_t>;
+using LSCacheDefault_T = LSCache_T<T_sxlen_t, T_uxlen_t, forced_enabled>;
 #else
-using LSCacheDefault_T = LSCacheDummy_T<T_sxlen_t, T_uxlen_t>;
+using LSCacheDefault_T = LSCacheDummy_T<T_sxlen_t, T_uxlen_t, forced_enabled>;
 #endif
 
 /******************************************************************************
@@ -16,6 +16,9 @@
 #include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
 
 /*
  * dummy implementation
@@ -38,8 +41,13 @@ class LSCacheStatsDummy_T {
 	void inc_bus_locked() {}
 	void inc_no_dmi() {}
 	void inc_dmi() {}
-	void inc_hit_load() {}
-	void inc_hit_store() {}
+	void inc_hit_load(uint64_t) {}
+	void inc_hit_store(uint64_t) {}
+	void inc_hit_way() {}
+	void inc_hit_victim() {}
+	void inc_hit_superpage() {}
+	void inc_miss(uint64_t) {}
+	void flush() {}
 	void print() {}
 };
 
@@ -66,8 +74,45 @@ class LSCacheStats_T : public LSCacheStatsDummy_T<T_LSCache> {
 		selem_t nentries_max;
 		selem_t nentries_valid_load;
 		selem_t nentries_valid_loadstore;
+		selem_t hit_way;
+		selem_t hit_victim;
+		selem_t miss;
+		selem_t miss_compulsory;
+		selem_t miss_capacity;
+		selem_t miss_conflict;
+		selem_t sets;
+		selem_t ways;
+		selem_t victims;
+		selem_t hit_superpage;
 	} s;
 
+	/*
+	 * classification of misses (of cacheable pages)
+	 *  * compulsory: first access of the page (since the last flush)
+	 *  * capacity: also a miss in a fully associative LRU cache with the same number of entries (shadow)
+	 *  * conflict: hit in the shadow -> caused by the geometry (sets/ways/victims)
+	 */
+	std::list<uint64_t> shadow_lru;
+	std::unordered_map<uint64_t, std::list<uint64_t>::iterator> shadow;
+	std::unordered_set<uint64_t> seen;
+
+	/* access page in the shadow cache, returns true on hit */
+	bool shadow_access(uint64_t virt_addr) {
+		uint64_t page = virt_addr >> 12;
+		auto it = shadow.find(page);
+		if (it != shadow.end()) {
+			shadow_lru.splice(shadow_lru.begin(), shadow_lru, it->second);
+			return true;
+		}
+		shadow_lru.push_front(page);
+		shadow[page] = shadow_lru.begin();
+		if (shadow_lru.size() > this->lscache.get_nentries_max()) {
+			shadow.erase(shadow_lru.back());
+			shadow_lru.pop_back();
+		}
+		return false;
+	}
+
 	LSCacheStats_T(T_LSCache &lscache) : LSCacheStatsDummy_T<T_LSCache>(lscache) {
 		reset();
 	}
@@ -110,13 +155,39 @@ class LSCacheStats_T : public LSCacheStatsDummy_T<T_LSCache> {
 	void inc_dmi() {
 		s.dmi++;
 	}
-	void inc_hit_load() {
+	void inc_hit_load(uint64_t virt_addr) {
 		s.hit++;
 		s.hit_load++;
+		shadow_access(virt_addr);
 	}
-	void inc_hit_store() {
+	void inc_hit_store(uint64_t virt_addr) {
 		s.hit++;
 		s.hit_store++;
+		shadow_access(virt_addr);
+	}
+	void inc_hit_way() {
+		s.hit_way++;
+	}
+	void inc_hit_victim() {
+		s.hit_victim++;
+	}
+	void inc_hit_superpage() {
+		s.hit_superpage++;
+	}
+	void inc_miss(uint64_t virt_addr) {
+		s.miss++;
+		if (shadow_access(virt_addr)) {
+			s.miss_conflict++;
+		} else if (seen.insert(virt_addr >> 12).second) {
+			s.miss_compulsory++;
+		} else {
+			s.miss_capacity++;
+		}
+	}
+	void flush() {
+		shadow_lru.clear();
+		shadow.clear();
+		seen.clear();
 	}
 
    public:
@@ -125,6 +196,9 @@ class LSCacheStats_T : public LSCacheStatsDummy_T<T_LSCache> {
 		s.nentries_max = this->lscache.get_nentries_max();
 		s.nentries_valid_load = this->lscache.get_nentries_valid_load();
 		s.nentries_valid_loadstore = this->lscache.get_nentries_valid_loadstore();
+		s.sets = this->lscache.get_sets();
+		s.ways = this->lscache.get_ways();
+		s.victims = this->lscache.get_victims();
 
 		std::cout << "============================================================================================="
 		             "==============================\n";
@@ -141,6 +215,15 @@ class LSCacheStats_T : public LSCacheStatsDummy_T<T_LSCache> {
 		std::cout << " hit_load:                  " << LSCACHE_STAT_RATE(s.hit_load, s.loads);
 		std::cout << " hit_store:                 " << LSCACHE_STAT_RATE(s.hit_store, s.stores);
 		std::cout << " hit:                       " << LSCACHE_STAT_RATE(s.hit, s.cnt);
+		std::cout << "  way 1..:                  " << LSCACHE_STAT_RATE(s.hit_way, s.hit);
+		std::cout << "  victim buffer:            " << LSCACHE_STAT_RATE(s.hit_victim, s.hit);
+		std::cout << "  superpages:               " << LSCACHE_STAT_RATE(s.hit_superpage, s.hit);
+		std::cout << " miss (cacheable):          " << LSCACHE_STAT_RATE(s.miss, s.cnt);
+		std::cout << "  compulsory:               " << LSCACHE_STAT_RATE(s.miss_compulsory, s.miss);
+		std::cout << "  capacity:                 " << LSCACHE_STAT_RATE(s.miss_capacity, s.miss);
+		std::cout << "  conflict:                 " << LSCACHE_STAT_RATE(s.miss_conflict, s.miss);
+		std::cout << " geometry:                  " << s.sets << " sets x " << s.ways << " ways + " << s.victims
+		          << " victims\n";
 		std::cout << " cache entries:             " << s.nentries_max << "\n";
 		std::cout << "  valid load:               " << LSCACHE_STAT_RATE(s.nentries_valid_load, s.nentries_max);
 		std::cout << "  valid load/store:         " << LSCACHE_STAT_RATE(s.nentries_valid_loadstore, s.nentries_max);
@@ -1,10 +1,15 @@
 #ifndef RISCV_ISA_MEM_H
 #define RISCV_ISA_MEM_H
 
+#include <mutex>
+
 #include "bus_lock_if.h"
 #include "dmi.h"
+#include "dmi_table.h"
+#include "fetch_cache.h"
 #include "mem_if.h"
 #include "mmu.h"
+#include "reservation_table.h"
 #include "util/propertytree.h"
 #include "util/tlm_ext_initiator.h"
 
@@ -40,6 +45,16 @@ struct InstrMemoryProxy_T : public instr_memory_if {
 		quantum_keeper.inc(access_delay);
 		return dmi.load<uint32_t>(pc);
 	}
+
+	virtual uint64_t translate_pc(uint64_t pc) override {
+		return pc;
+	}
+
+	virtual const uint32_t *track_code_page(uint64_t pc, uint64_t &paddr, unsigned int &page_shift) override {
+		paddr = pc;
+		page_shift = PGSHIFT;
+		return dmi.get_code_page_tracker()->mark_code_page(dmi.get_mem_ptr_to_global_addr<uint8_t>(pc));
+	}
 };
 
 template <typename T_RVX_ISS, typename T_sxlen_t, typename T_uxlen_t>
@@ -53,15 +68,22 @@ class CombinedMemoryInterface_T : public sc_core::sc_module,
 
 	T_RVX_ISS &iss;
 	uint64_t lr_addr = 0;
+	/* value based reservation of the last LR (see _atomic_load_reserved_data) */
+	uint64_t lr_paddr = 0;
+	uint64_t lr_value = 0;
+	uint64_t lr_reservation = 0;
+	bool lr_valid = false;
 
 	tlm_utils::tlm_quantumkeeper &quantum_keeper;
 
 	// optionally add DMI ranges for optimization
 	sc_core::sc_time dmi_access_delay;
 	bool _dmi_enabled;
-	std::vector<MemoryDMI> dmi_ranges, dmi_ranges_disabled;
+	DMITable dmi_ranges, dmi_ranges_disabled;
 	bool last_access_was_dmi = false;
 	void *last_dmi_page_host_addr = nullptr;
+	uint64_t last_dmi_paddr = 0;
+	FetchCache fetch_cache;
 
 	tlm::tlm_generic_payload trans;
 	tlm_ext_initiator *ext;
@@ -89,22 +111,54 @@ class CombinedMemoryInterface_T : public sc_core::sc_module,
 		ext = new tlm_ext_initiator(&owner);  // tlm_generic_payload frees all extension objects in destructor,
 		                                      // therefore dynamic allocation is needed
 		trans.set_extension<tlm_ext_initiator>(ext);
+
+		isock.register_invalidate_direct_mem_ptr(this, &CombinedMemoryInterface_T::invalidate_direct_mem_ptr);
 	}
 
 	void dmi_add(MemoryDMI dmi) {
+		/* new code pages must not be written via LSCache store entries anymore (see CodePageTracker) */
+		dmi.get_code_page_tracker()->add_new_code_page_listener([this]() { iss.request_lscache_flush(); });
+
 		if (_dmi_enabled) {
-			dmi_ranges.emplace_back(dmi);
+			dmi_ranges.add(dmi);
 		} else {
-			dmi_ranges_disabled.emplace_back(dmi);
+			dmi_ranges_disabled.add(dmi);
 		}
+		fetch_cache.flush();
 	}
 	void dmi_enable(bool ena) override {
 		if (ena != _dmi_enabled) {
 			/* just swap -> no additional check of _dmi_enabled for transcations necessary */
-			std::swap(dmi_ranges, dmi_ranges_disabled);
+			dmi_ranges.swap(dmi_ranges_disabled);
+			fetch_cache.flush();
 		}
 		_dmi_enabled = ena;
 	}
+
+	/*
+	 * remove all dmi ranges overlapping [start, end] -> accesses are done via transactions afterwards
+	 * all cached host addresses (LSCache, fetch cache) are dropped
+	 * NOTE: the DBBCache is not flushed (instructions are re-fetched on its coherence checks)
+	 * NOTE: must be called by the hart itself (other threads use request_dmi_invalidate of the ISS)
+	 */
+	void dmi_invalidate(uint64_t start, uint64_t end) override {
+		bool removed = dmi_ranges.invalidate(start, end);
+		removed |= dmi_ranges_disabled.invalidate(start, end);
+		if (!removed) {
+			return;
+		}
+		last_access_was_dmi = false;
+		fetch_cache.flush();
+		iss.request_lscache_flush();
+	}
+
+	/*
+	 * TLM backward path (e.g. target is remapped or removed)
+	 * -> called in the SystemC thread, executed by the hart (see request_dmi_invalidate)
+	 */
+	void invalidate_direct_mem_ptr(sc_dt::uint64 start, sc_dt::uint64 end) {
+		iss.request_dmi_invalidate(start, end);
+	}
 	bool dmi_enabled() const override {
 		return _dmi_enabled;
 	}
@@ -129,7 +183,8 @@ class CombinedMemoryInterface_T : public sc_core::sc_module,
 
 		sc_core::sc_time local_delay = quantum_keeper.get_local_time();
 
-		isock->b_transport(trans, local_delay);
+		/* hart running in parallel -> executed by the SystemC thread of the runner (see parallel_runner.h) */
+		iss.systemc_call([&]() { isock->b_transport(trans, local_delay); });
 
 		quantum_keeper.set(local_delay);
 
@@ -154,17 +209,17 @@ class CombinedMemoryInterface_T : public sc_core::sc_module,
 
 		T ans;
 
-		for (auto &e : dmi_ranges) {
-			if (e.contains(addr)) {
-				quantum_keeper.inc(dmi_access_delay);
-				ans = e.load<T>(addr);
+		MemoryDMI *e = dmi_ranges.find(addr);
+		if (likely(e != nullptr)) {
+			quantum_keeper.inc(dmi_access_delay);
+			ans = e->load<T>(addr);
 
-				/* save the host address of the start of the 4KiB page containing addr */
-				last_access_was_dmi = true;
-				last_dmi_page_host_addr = e.get_mem_ptr_to_global_addr<T>(addr & ~0xFFF);
+			/* save the host address of the start of the 4KiB page containing addr */
+			last_access_was_dmi = true;
+			last_dmi_page_host_addr = e->get_mem_ptr_to_global_addr<T>(addr & ~0xFFF);
+			last_dmi_paddr = addr;
 
-				return ans;
-			}
+			return ans;
 		}
 
 		_do_transaction(tlm::TLM_READ_COMMAND, addr, (uint8_t *)&ans, sizeof(T));
@@ -183,22 +238,25 @@ class CombinedMemoryInterface_T : public sc_core::sc_module,
 	inline void _raw_store_data(uint64_t addr, T value) {
 		bus_lock->wait_for_access_rights(iss.get_hart_id());
 
-		for (auto &e : dmi_ranges) {
-			if (e.contains(addr)) {
-				quantum_keeper.inc(dmi_access_delay);
-				e.store(addr, value);
-
+		MemoryDMI *e = dmi_ranges.find(addr);
+		if (likely(e != nullptr)) {
+			quantum_keeper.inc(dmi_access_delay);
+			if (unlikely(e->store(addr, value))) {
+				/* code page -> writes must be tracked -> do not provide the host address (LSCache) */
+				last_access_was_dmi = false;
+			} else {
 				/* save the host address of the start of the 4KiB page containing addr */
 				last_access_was_dmi = true;
-				last_dmi_page_host_addr = e.get_mem_ptr_to_global_addr<T>(addr & ~0xFFF);
-
-				atomic_unlock();
-				return;
+				last_dmi_page_host_addr = e->get_mem_ptr_to_global_addr<T>(addr & ~0xFFF);
+				last_dmi_paddr = addr;
 			}
+
+			bus_lock->unlock(iss.get_hart_id());
+			return;
 		}
 
 		_do_transaction(tlm::TLM_WRITE_COMMAND, addr, (uint8_t *)&value, sizeof(T));
-		atomic_unlock();
+		bus_lock->unlock(iss.get_hart_id());
 
 		/* see comment in _raw_load_data */
 		last_access_was_dmi = false;
@@ -225,12 +283,65 @@ class CombinedMemoryInterface_T : public sc_core::sc_module,
 	}
 
 	void flush_tlb() override {
+		fetch_cache.flush();
 		if (mmu == nullptr) {
 			return;
 		}
 		mmu->flush_tlb();
 	}
 
+	void print_stats() override {
+		fetch_cache.print_stats(iss.get_hart_id());
+		if (mmu == nullptr) {
+			return;
+		}
+		mmu->print_stats();
+	}
+
+	/*
+	 * get the fetch cache entry of the page containing vaddr (see FetchCache)
+	 * paddr: physical address of vaddr
+	 * returns nullptr, if the page is not dmi capable
+	 */
+	__always_inline const FetchCache::Entry *fetch_cache_get(uint64_t vaddr, uint64_t &paddr) {
+		unsigned int ctx =
+		    (mmu == nullptr || !mmu->fetch_translated()) ? FetchCache::CTX_NO_TRANSLATION : (unsigned int)iss.prv;
+		const FetchCache::Entry *e = fetch_cache.lookup(vaddr, ctx);
+		if (likely(e != nullptr)) {
+			/* same timing as translation via mmu */
+			if (ctx != FetchCache::CTX_NO_TRANSLATION) {
+				quantum_keeper.inc(mmu->mmu_access_delay);
+			}
+			paddr = e->ppage | (vaddr & 0xFFF);
+			return e;
+		}
+
+		paddr = v2p(vaddr, FETCH);
+		uint64_t ppage = paddr & ~((uint64_t)0xFFF);
+		MemoryDMI *dmi = dmi_ranges.find(ppage, 0x1000);
+		if (dmi == nullptr) {
+			return nullptr;
+		}
+		return fetch_cache.insert(vaddr, ctx, ppage, mmu == nullptr ? PGSHIFT : mmu->last_page_shift,
+		                          dmi->get_mem_ptr_to_global_addr<uint8_t>(ppage), dmi->get_code_page_tracker());
+	}
+
+	template <typename T>
+	inline T _load_instr(uint64_t addr) {
+		uint64_t paddr;
+		const FetchCache::Entry *e = fetch_cache_get(addr, paddr);
+		if (e == nullptr) {
+			return _raw_load_data<T>(paddr);
+		}
+
+		/* see _raw_load_data */
+		bus_lock->wait_for_access_rights(iss.get_hart_id());
+		quantum_keeper.inc(dmi_access_delay);
+		T ans;
+		memcpy(&ans, e->host_page + (addr & 0xFFF), sizeof(T));
+		return ans;
+	}
+
 	uint32_t load_instr(uint64_t addr) override {
 		/*
 		 * We have support for RISC-V Compressed C instructions.
@@ -255,11 +366,70 @@ class CombinedMemoryInterface_T : public sc_core::sc_module,
 		 *
 		 */
 		if ((addr & 0xFFF) == 0xFFE) {
-			return (_raw_load_data<uint16_t>(v2p(addr + 2, FETCH)) << 16) |
-			       (_raw_load_data<uint16_t>(v2p(addr + 0, FETCH)) << 0);
+			return (_load_instr<uint16_t>(addr + 2) << 16) | (_load_instr<uint16_t>(addr + 0) << 0);
 		}
 
-		return _raw_load_data<uint32_t>(v2p(addr, FETCH));
+		return _load_instr<uint32_t>(addr);
+	}
+
+	uint64_t translate_pc(uint64_t pc) override {
+		uint64_t paddr;
+		fetch_cache_get(pc, paddr);
+		return paddr;
+	}
+
+	const uint32_t *track_code_page(uint64_t pc, uint64_t &paddr, unsigned int &page_shift) override {
+		const FetchCache::Entry *e = fetch_cache_get(pc, paddr);
+		if (e == nullptr) {
+			return nullptr;
+		}
+		page_shift = e->page_shift;
+		return e->code_page_tracker->mark_code_page(e->host_page + (pc & 0xFFF));
+	}
+
+	/*
+	 * Atomics (LR/SC, AMOs)
+	 *  * dmi memory: host atomics without the bus lock -> the LSCache and the DBBCache stay on the fast path (see the
+	 *    bus lock checks in LSCache_T and the LR/SC handling in the ISS)
+	 *     * AMO: host compare-and-swap loop (atomic to plain stores of other harts, even if running in parallel)
+	 *     * LR: reserves the line (see ReservationTable) and the loaded value
+	 *     * SC: commits the line reservation and stores with a host compare-and-swap against the loaded value
+	 *  * other memory (e.g. mmio): the bus lock is held from the LR or the AMO load until the next store of the hart
+	 *    Harts running in parallel (see parallel_runner.h) can not hold the bus lock across host threads. They use a
+	 *    host mutex and value based reservations (as above) instead.
+	 */
+	static std::mutex &parallel_atomic_mutex() {
+		static std::mutex mutex;
+		return mutex;
+	}
+
+	MemoryDMI *find_dmi(uint64_t paddr) {
+		return dmi_ranges.find(paddr);
+	}
+
+	/* translate for load AND store (AMO) -> a load access fault is a store/amo access fault */
+	uint64_t v2p_amo(uint64_t addr) {
+		try {
+			v2p(addr, LOAD);
+			return v2p(addr, STORE);
+		} catch (SimulationTrap &e) {
+			if (e.reason == EXC_LOAD_ACCESS_FAULT) {
+				e.reason = EXC_STORE_AMO_ACCESS_FAULT;
+			}
+			throw e;
+		}
+	}
+
+	template <typename T>
+	T _host_atomic_execute_amo(MemoryDMI &dmi, uint64_t paddr, T value_rs2, std::function<T(T, T)> &operation) {
+		quantum_keeper.inc(dmi_access_delay * 2);
+		ReservationTable::invalidate(dmi.get_mem_ptr_to_global_addr<uint8_t>(paddr));
+		T value_last = dmi.load_atomic<T>(paddr);
+		while (!dmi.compare_exchange(paddr, value_last, operation(value_last, value_rs2))) {
+		}
+		/* no LSCache entries for atomics */
+		last_access_was_dmi = false;
+		return value_last;
 	}
 
 	template <typename T>
@@ -268,6 +438,19 @@ class CombinedMemoryInterface_T : public sc_core::sc_module,
 		T value_last, value_new;
 		unsigned int n_redos = 0;
 
+		paddr = v2p_amo(addr);
+		MemoryDMI *dmi = find_dmi(paddr);
+		if (likely(dmi != nullptr)) {
+			return _host_atomic_execute_amo(*dmi, paddr, value_rs2, operation);
+		}
+
+		if (iss.runs_parallel()) {
+			std::lock_guard<std::mutex> lock(parallel_atomic_mutex());
+			value_last = _raw_load_data<T>(paddr);
+			_raw_store_data(paddr, operation(value_last, value_rs2));
+			return value_last;
+		}
+
 		/* bus lock redo loop (see check below) */
 		while (1) {
 			bus_lock->lock(iss.get_hart_id());
@@ -319,12 +502,60 @@ class CombinedMemoryInterface_T : public sc_core::sc_module,
 
 	template <typename T>
 	T _atomic_load_reserved_data(uint64_t addr) {
-		bus_lock->lock(iss.get_hart_id());
+		uint64_t paddr = v2p(addr, LOAD);
+		MemoryDMI *dmi = find_dmi(paddr);
+		T value;
+
+		if (likely(dmi != nullptr)) {
+			quantum_keeper.inc(dmi_access_delay);
+			/* reserve before the load (see ReservationTable) */
+			lr_reservation = ReservationTable::reserve(dmi->get_mem_ptr_to_global_addr<uint8_t>(paddr));
+			value = dmi->load_atomic<T>(paddr);
+			last_access_was_dmi = false;
+		} else if (iss.runs_parallel()) {
+			value = _raw_load_data<T>(paddr);
+		} else {
+			lr_valid = false;
+			bus_lock->lock(iss.get_hart_id());
+			lr_addr = addr;
+			return _raw_load_data<T>(paddr);
+		}
+
 		lr_addr = addr;
-		return _load_data<T>(addr);
+		lr_paddr = paddr;
+		lr_value = value;
+		lr_valid = true;
+		return value;
 	}
 	template <typename T>
 	bool _atomic_store_conditional_data(uint64_t addr, T value) {
+		if (lr_valid) {
+			/* value based reservation (see above) */
+			lr_valid = false;
+			if (addr != lr_addr) {
+				return false;
+			}
+			uint64_t paddr = v2p(addr, STORE);
+			if (paddr != lr_paddr) {
+				return false;
+			}
+
+			MemoryDMI *dmi = find_dmi(paddr);
+			if (likely(dmi != nullptr)) {
+				quantum_keeper.inc(dmi_access_delay);
+				T expected = lr_value;
+				return ReservationTable::commit(dmi->get_mem_ptr_to_global_addr<uint8_t>(paddr), lr_reservation) &&
+				       dmi->compare_exchange(paddr, expected, value);
+			}
+
+			std::lock_guard<std::mutex> lock(parallel_atomic_mutex());
+			if (_raw_load_data<T>(paddr) != (T)lr_value) {
+				return false;
+			}
+			_raw_store_data(paddr, value);
+			return true;
+		}
+
 		/* According to the RISC-V ISA, an implementation can fail each LR/SC sequence that does not satisfy the forward
 		 * progress semantic.
 		 * The lock is established by the LR instruction and the lock is kept while forward progress is maintained. */
@@ -400,6 +631,7 @@ class CombinedMemoryInterface_T : public sc_core::sc_module,
 	}
 
 	void atomic_unlock() override {
+		lr_valid = false;
 		bus_lock->unlock(iss.get_hart_id());
 	}
 
@@ -407,6 +639,10 @@ class CombinedMemoryInterface_T : public sc_core::sc_module,
 		return bus_lock->is_locked();
 	}
 
+	bool holds_bus_lock() override {
+		return bus_lock->is_locked(iss.get_hart_id());
+	}
+
 	/* see comment in data_memory_if_T */
 	void *get_last_dmi_page_host_addr() override {
 		if (!last_access_was_dmi) {
@@ -414,6 +650,27 @@ class CombinedMemoryInterface_T : public sc_core::sc_module,
 		}
 		return last_dmi_page_host_addr;
 	}
+
+	/* see comment in data_memory_if_T */
+	void *get_last_dmi_superpage_host_addr(bool store, unsigned int &page_shift) override {
+		if (!last_access_was_dmi || mmu == nullptr || mmu->last_page_shift <= PGSHIFT) {
+			return nullptr;
+		}
+
+		page_shift = mmu->last_page_shift;
+		uint64_t size = uint64_t(1) << page_shift;
+		uint64_t base = last_dmi_paddr & ~(size - 1);
+		MemoryDMI *e = dmi_ranges.find(base, size);
+		if (e == nullptr) {
+			return nullptr;
+		}
+		uint8_t *host_addr = e->get_mem_ptr_to_global_addr<uint8_t>(base);
+		/* stores to code pages must be tracked (see CodePageTracker) */
+		if (store && e->get_code_page_tracker()->has_code_pages(host_addr, size)) {
+			return nullptr;
+		}
+		return host_addr;
+	}
 };
 
 #endif /* RISCV_ISA_MEM_H */
@@ -17,10 +17,20 @@ struct instr_memory_if {
 		assert(0);
 	}
 
-	/* for cheriv9 (optional for others) */
+	/* for cheriv9 and DBBCache (optional for others) */
 	virtual uint64_t translate_pc(uint64_t pc) {
 		assert(0);
 	}
+
+	/*
+	 * for DBBCache (optional)
+	 * translates pc to paddr and marks the containing page as code page (see CodePageTracker)
+	 * page_shift: size (log2) of the page (leaf) of the translation (12, or larger for pages inside of superpages)
+	 * returns a pointer to the state of the page, or nullptr if the page can not be tracked (e.g. no dmi)
+	 */
+	virtual const uint32_t *track_code_page(uint64_t pc, uint64_t &paddr, unsigned int &page_shift) {
+		return nullptr;
+	}
 };
 
 /*
@@ -33,6 +43,8 @@ struct data_memory_if_T {
 	virtual bool dmi_enabled() const {
 		return false;
 	}
+	/* remove all dmi ranges overlapping [start, end] (e.g. TLM invalidate_direct_mem_ptr) */
+	virtual void dmi_invalidate(uint64_t start, uint64_t end) {}
 
 	/* also used on RV32 for floating point D extension! */
 	virtual int64_t load_double(uint64_t addr) = 0;
@@ -76,6 +88,10 @@ struct data_memory_if_T {
 
 	/* returns true if the bus is locked */
 	virtual bool is_bus_locked() = 0;
+	/* returns true if the bus is locked by this hart (e.g. LR reservation on memory without dmi) */
+	virtual bool holds_bus_lock() {
+		return is_bus_locked();
+	}
 	/*
 	 * returns the host page start address, if the last access was using dmi
 	 * returns nullptr otherwise
@@ -83,8 +99,22 @@ struct data_memory_if_T {
 	 * a call of this method
 	 */
 	virtual void *get_last_dmi_page_host_addr() = 0;
+	/*
+	 * returns the host start address of the superpage (e.g. Sv39 megapage/gigapage) containing the last access, if
+	 *  * the last access was using dmi and
+	 *  * the whole superpage is backed by a single dmi range and
+	 *  * the superpage contains no code pages (only for store == true, see CodePageTracker)
+	 * returns nullptr otherwise (e.g. 4KiB page, no mmu)
+	 * page_shift: size (log2) of the superpage
+	 * CAUTION: same as get_last_dmi_page_host_addr
+	 */
+	virtual void *get_last_dmi_superpage_host_addr(bool store, unsigned int &page_shift) {
+		return nullptr;
+	}
 
 	virtual void flush_tlb() = 0;
+	/* print statistics of the memory interface (e.g. mmu) */
+	virtual void print_stats() {}
 
 	/*
 	 * cheriv9 helper interfaces
@@ -3,12 +3,20 @@
 #include <stdint.h>
 #include <tlm_utils/tlm_quantumkeeper.h>
 
+#include <iostream>
 #include <systemc>
 
 #include "irq_if.h"
 #include "mmu_mem_if.h"
 #include "util/propertytree.h"
 
+/*
+ * enable statistics (TLB hits, page walks)
+ * printed with the statistics of the ISS
+ */
+// #define MMU_STATS_ENABLED
+#undef MMU_STATS_ENABLED
+
 constexpr unsigned PTE_PPN_SHIFT = 10;
 constexpr unsigned PGSHIFT = 12;
 constexpr unsigned PGSIZE = 1 << PGSHIFT;
@@ -77,16 +85,50 @@ struct MMU_T {
 	mmu_memory_if *mem = nullptr;
 	bool page_fault_on_AD = false;
 
+	/*
+	 * TLB: 4KiB pages, direct-mapped
+	 * page_shift: size (log2) of the page of the translation, i.e. > PGSHIFT for pages inside of superpages
+	 */
 	struct tlb_entry_t {
 		uint64_t ppn = -1;
 		uint64_t vpn = -1;
+		unsigned int page_shift = PGSHIFT;
+	};
+
+	/*
+	 * superpage TLB: megapages, gigapages, ... (fully associative, round robin replacement)
+	 * Checked on TLB misses -> all 4KiB pages of a superpage are translated without page walk.
+	 */
+	struct stlb_entry_t {
+		uint64_t vbase = -1;
+		uint64_t pbase = -1;
+		uint64_t mask = -1;
 	};
 
 	static constexpr unsigned TLB_ENTRIES = 256;
+	static constexpr unsigned STLB_ENTRIES = 16;
 	static constexpr unsigned NUM_MODES = 2;         // User and Supervisor
 	static constexpr unsigned NUM_ACCESS_TYPES = 3;  // FETCH, LOAD, STORE
 
 	tlb_entry_t tlb[NUM_MODES][NUM_ACCESS_TYPES][TLB_ENTRIES];
+	stlb_entry_t stlb[NUM_MODES][NUM_ACCESS_TYPES][STLB_ENTRIES];
+	unsigned int stlb_next[NUM_MODES][NUM_ACCESS_TYPES];
+
+	/* size (log2) of the page of the last translation (e.g. for superpage entries in the LSCache) */
+	unsigned int last_page_shift = PGSHIFT;
+
+#ifdef MMU_STATS_ENABLED
+	struct {
+		uint64_t translations;
+		uint64_t tlb_hits;
+		uint64_t stlb_hits;
+		uint64_t walks;
+		uint64_t walks_superpage;
+	} stats = {};
+#define MMU_STATS_INC(_name) (stats._name++)
+#else
+#define MMU_STATS_INC(_name)
+#endif
 
 	MMU_T(T_RVX_ISS &core) : core(core), quantum_keeper(core.quantum_keeper) {
 		/*
@@ -103,9 +145,36 @@ struct MMU_T {
 
 	void flush_tlb() {
 		memset(&tlb[0], -1, NUM_MODES * NUM_ACCESS_TYPES * TLB_ENTRIES * sizeof(tlb_entry_t));
+		memset(&stlb[0], -1, NUM_MODES * NUM_ACCESS_TYPES * STLB_ENTRIES * sizeof(stlb_entry_t));
+		memset(&stlb_next[0], 0, sizeof(stlb_next));
+	}
+
+	void print_stats() {
+#ifdef MMU_STATS_ENABLED
+#define MMU_STAT_RATE(_val, _cnt) (_val) << "\t\t(" << (double)(_val) / (_cnt) << ")\n"
+		std::cout << "============================================================================================="
+		             "==============================\n";
+		std::cout << "MMU Stats (hartId: " << core.get_hart_id() << "):\n" << std::dec;
+		std::cout << " translations:              " << stats.translations << "\n";
+		std::cout << " tlb hits:                  " << MMU_STAT_RATE(stats.tlb_hits, stats.translations);
+		std::cout << " superpage tlb hits:        " << MMU_STAT_RATE(stats.stlb_hits, stats.translations);
+		std::cout << " page walks:                " << MMU_STAT_RATE(stats.walks, stats.translations);
+		std::cout << "  superpages:               " << MMU_STAT_RATE(stats.walks_superpage, stats.walks);
+		std::cout << "============================================================================================="
+		             "==============================\n";
+		std::cout << std::endl;
+#undef MMU_STAT_RATE
+#endif
+	}
+
+	/* returns true, if fetches are translated (see translate_virtual_to_physical_addr, FetchCache) */
+	__always_inline bool fetch_translated() const {
+		return core.csrs.satp.reg.fields.mode != SATP_MODE_BARE && core.prv != MachineMode;
 	}
 
 	uint64_t translate_virtual_to_physical_addr(uint64_t vaddr, MemoryAccessType type) {
+		last_page_shift = PGSHIFT;
+
 		if (core.csrs.satp.reg.fields.mode == SATP_MODE_BARE)
 			return vaddr;
 
@@ -125,21 +194,59 @@ struct MMU_T {
 		// optimization only, to void page walk
 		assert(mode == 0 || mode == 1);
 		assert(type == 0 || type == 1 || type == 2);
+		MMU_STATS_INC(translations);
 		auto vpn = (vaddr >> PGSHIFT);
 		auto idx = vpn % TLB_ENTRIES;
 		auto &x = tlb[mode][type][idx];
-		if (x.vpn == vpn)
+		if (x.vpn == vpn) {
+			MMU_STATS_INC(tlb_hits);
+			last_page_shift = x.page_shift;
 			return x.ppn | (vaddr & PGMASK);
+		}
 
-		uint64_t paddr = walk(vaddr, type, mode);
+		uint64_t paddr;
+		unsigned int page_shift;
+		if (!stlb_lookup(vaddr, mode, type, paddr, page_shift)) {
+			MMU_STATS_INC(walks);
+			paddr = walk(vaddr, type, mode, page_shift);
+			if (page_shift > PGSHIFT) {
+				MMU_STATS_INC(walks_superpage);
+				stlb_insert(vaddr, paddr, mode, type, page_shift);
+			}
+		}
 
 		// optimization only, to void page walk
 		x.ppn = (paddr & ~((uint64_t)PGMASK));
 		x.vpn = vpn;
+		x.page_shift = page_shift;
+		last_page_shift = page_shift;
 
 		return paddr;
 	}
 
+	bool stlb_lookup(uint64_t vaddr, PrivilegeLevel mode, MemoryAccessType type, uint64_t &paddr,
+	                 unsigned int &page_shift) {
+		for (auto &e : stlb[mode][type]) {
+			if ((vaddr & ~e.mask) == e.vbase) {
+				MMU_STATS_INC(stlb_hits);
+				paddr = e.pbase | (vaddr & e.mask);
+				page_shift = __builtin_ctzll(e.mask + 1);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void stlb_insert(uint64_t vaddr, uint64_t paddr, PrivilegeLevel mode, MemoryAccessType type,
+	                 unsigned int page_shift) {
+		unsigned int &next = stlb_next[mode][type];
+		auto &e = stlb[mode][type][next];
+		next = (next + 1) % STLB_ENTRIES;
+		e.mask = (uint64_t(1) << page_shift) - 1;
+		e.vbase = vaddr & ~e.mask;
+		e.pbase = paddr & ~e.mask;
+	}
+
 	vm_info decode_vm_info(PrivilegeLevel prv) {
 		assert(prv <= SupervisorMode);
 		uint64_t ptbase = (uint64_t)core.csrs.satp.reg.fields.ppn << PGSHIFT;
@@ -169,7 +276,8 @@ struct MMU_T {
 		return ok;
 	}
 
-	uint64_t walk(uint64_t vaddr, MemoryAccessType type, PrivilegeLevel mode) {
+	/* page_shift: size (log2) of the page of the translation (PGSHIFT or superpage) */
+	uint64_t walk(uint64_t vaddr, MemoryAccessType type, PrivilegeLevel mode, unsigned int &page_shift) {
 		bool s_mode = mode == SupervisorMode;
 		bool sum = core.csrs.mstatus.reg.fields.sum;
 		bool mxr = core.csrs.mstatus.reg.fields.mxr;
@@ -254,6 +362,7 @@ struct MMU_T {
 			uint64_t vpn = vaddr >> PGSHIFT;
 			uint64_t pgoff = vaddr & (PGSIZE - 1);
 			uint64_t paddr = (((ppn & ~mask) | (vpn & mask)) << PGSHIFT) | pgoff;
+			page_shift = PGSHIFT + ptshift;
 			return paddr;
 		}
 
@@ -0,0 +1,266 @@
+#ifndef RISCV_PARALLEL_RUNNER
+#define RISCV_PARALLEL_RUNNER
+
+#include <cassert>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <systemc>
+#include <thread>
+#include <vector>
+
+#include <softfloat/softfloat.hpp>
+
+#include "core_defs.h"
+#include "hart_thread_if.h"
+
+/*
+ * Parallel hart execution (alternative to one DirectCoreRunner per hart, see --parallel-harts)
+ * Each hart runs on its own host thread. The harts execute a quantum in parallel, while SystemC is not entered
+ * (barrier at quantum boundaries):
+ *  1. Parallel phase: The SystemC thread of the runner releases all harts and waits (host) until all harts reached the
+ *     end of the quantum (sync), are idle (wfi) or terminated. Everything a hart has to do in SystemC (transactions,
+ *     mtime, syscalls, ...) is queued to the runner and executed one after the other in the SystemC thread of the runner
+ *     (call) -> peripherals stay single-threaded.
+ *  2. Serial phase: The runner advances the SystemC time by the largest local time of the harts (or waits for an
+ *     interrupt, if all harts are idle). Peripherals run, while all harts are parked.
+ * Requirements of the harts (see hart_thread_if.h):
+ *  * Cross-hart accesses of the execution state only via requests (see post_request in the ISS)
+ *  * LR/SC and AMOs with host atomics instead of the bus lock (see CombinedMemoryInterface_T)
+ *  * DMI for data accesses (transactions are calls -> slow)
+ *  * Softfloat state (rounding mode, exception flags) per host thread (THREAD_LOCAL, see vendor/softfloat) -> checked
+ *    on construction
+ * Not supported: debug runner (gdb), sharing of DBBCache blocks between harts
+ */
+template <class T_ISS>
+class ParallelCoreRunner : public sc_core::sc_module {
+	enum State {
+		/* waiting for the start of the next quantum */
+		PARKED,
+		RUNNING,
+		/* waiting for the execution of a call */
+		CALL,
+		/* end of quantum reached */
+		SYNC,
+		/* waiting for interrupt */
+		IDLE,
+		/* run returned (or failed) */
+		EXITED,
+	};
+
+	struct Hart : public hart_thread_if {
+		ParallelCoreRunner &runner;
+		T_ISS &core;
+		std::thread thread;
+		/* protected by runner.mutex */
+		State state = PARKED;
+		std::condition_variable cv;
+		const std::function<void(void)> *call_fn = nullptr;
+		std::exception_ptr call_exception = nullptr;
+		std::exception_ptr exit_exception = nullptr;
+
+		Hart(ParallelCoreRunner &runner, T_ISS &core) : runner(runner), core(core) {}
+
+		void sync() override {
+			runner.hart_park(*this, SYNC);
+		}
+
+		void idle() override {
+			runner.hart_park(*this, IDLE);
+		}
+
+		void call(const std::function<void(void)> &fn) override {
+			call_fn = &fn;
+			runner.hart_park(*this, CALL);
+			if (call_exception != nullptr) {
+				std::exception_ptr e = call_exception;
+				call_exception = nullptr;
+				std::rethrow_exception(e);
+			}
+		}
+
+		bool is_current() const override {
+			return std::this_thread::get_id() == thread.get_id();
+		}
+	};
+
+	std::vector<std::unique_ptr<Hart>> harts;
+	std::mutex mutex;
+	/* runner waits for state changes of the harts */
+	std::condition_variable cv;
+	bool stopping = false;
+
+	/* called by the host thread of hart: set state and wait until the hart is released again */
+	void hart_park(Hart &hart, State state) {
+		std::unique_lock<std::mutex> lock(mutex);
+		hart.state = state;
+		cv.notify_one();
+		hart.cv.wait(lock, [&] { return hart.state == RUNNING || stopping; });
+		if (stopping) {
+			throw HartThreadStop();
+		}
+	}
+
+	void hart_main(Hart &hart) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			hart.cv.wait(lock, [&] { return hart.state == RUNNING || stopping; });
+			if (stopping) {
+				return;
+			}
+		}
+
+		try {
+			hart.core.run();
+		} catch (HartThreadStop &) {
+			return;
+		} catch (...) {
+			hart.exit_exception = std::current_exception();
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		hart.state = EXITED;
+		cv.notify_one();
+	}
+
+	/* parallel phase (see above): release all harts, execute their calls until all are parked */
+	void run_quantum() {
+		std::unique_lock<std::mutex> lock(mutex);
+		for (auto &hart : harts) {
+			if (hart->state != EXITED) {
+				hart->state = RUNNING;
+				hart->cv.notify_one();
+			}
+		}
+
+		while (true) {
+			Hart *caller = nullptr;
+			bool running = false;
+			for (auto &hart : harts) {
+				if (hart->state == CALL) {
+					caller = hart.get();
+					break;
+				}
+				running |= hart->state == RUNNING;
+			}
+
+			if (caller != nullptr) {
+				/* execute without lock -> other harts can continue */
+				lock.unlock();
+				try {
+					(*caller->call_fn)();
+				} catch (...) {
+					caller->call_exception = std::current_exception();
+				}
+				lock.lock();
+				caller->state = RUNNING;
+				caller->cv.notify_one();
+				continue;
+			}
+
+			if (!running) {
+				return;
+			}
+			cv.wait(lock);
+		}
+	}
+
+	void stop_harts() {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			stopping = true;
+			for (auto &hart : harts) {
+				hart->cv.notify_one();
+			}
+		}
+		for (auto &hart : harts) {
+			if (hart->thread.joinable()) {
+				hart->thread.join();
+			}
+		}
+	}
+
+	void run() {
+		for (auto &hart : harts) {
+			hart->thread = std::thread(&ParallelCoreRunner::hart_main, this, std::ref(*hart));
+		}
+
+		while (true) {
+			run_quantum();
+
+			/* all harts are parked (no lock needed below) */
+
+			bool all_idle = true;
+			sc_core::sc_time advance = sc_core::SC_ZERO_TIME;
+			sc_core::sc_event_or_list wfi_events;
+			for (auto &hart : harts) {
+				if (hart->state == EXITED) {
+					/* same as DirectCoreRunner: the first hart leaving run stops the simulation */
+					if (hart->exit_exception != nullptr) {
+						std::rethrow_exception(hart->exit_exception);
+					}
+					if (hart->core.get_status() == CoreExecStatus::HitBreakpoint) {
+						throw std::runtime_error(
+						    "Breakpoints are not supported in the parallel runner, use the debug runner instead.");
+					}
+					assert(hart->core.get_status() == CoreExecStatus::Terminated);
+					sc_core::sc_stop();
+					return;
+				}
+				if (hart->state == SYNC) {
+					all_idle = false;
+					advance = std::max(advance, hart->core.quantum_keeper.get_local_time());
+				}
+				wfi_events |= hart->core.get_wfi_event();
+			}
+
+			/* serial phase (see above) */
+			if (all_idle) {
+				sc_core::wait(wfi_events);
+			} else {
+				sc_core::wait(advance);
+			}
+			for (auto &hart : harts) {
+				hart->core.quantum_keeper.reset();
+			}
+		}
+	}
+
+	/* false, if softfloat was built without THREAD_LOCAL (state shared by all harts) */
+	static bool softfloat_state_is_thread_local() {
+		uint_fast8_t flags = softfloat_exceptionFlags;
+		softfloat_exceptionFlags = 0;
+		std::thread([] { softfloat_exceptionFlags = softfloat_flag_invalid; }).join();
+		bool ret = softfloat_exceptionFlags == 0;
+		softfloat_exceptionFlags = flags;
+		return ret;
+	}
+
+   public:
+	SC_HAS_PROCESS(ParallelCoreRunner);
+
+	ParallelCoreRunner(sc_core::sc_module_name name, const std::vector<T_ISS *> &cores) : sc_module(name) {
+		if (!softfloat_state_is_thread_local()) {
+			throw std::runtime_error(
+			    "Parallel hart execution requires softfloat with per-thread state (THREAD_LOCAL, see "
+			    "vendor/softfloat/CMakeLists.txt).");
+		}
+		for (T_ISS *core : cores) {
+			harts.emplace_back(new Hart(*this, *core));
+			core->set_hart_thread(harts.back().get());
+		}
+		SC_THREAD(run);
+	}
+
+	~ParallelCoreRunner() {
+		stop_harts();
+	}
+
+	void end_of_simulation() override {
+		stop_harts();
+	}
+};
+
+#endif
@@ -0,0 +1,126 @@
+#include "predecode.h"
+
+#include <map>
+#include <mutex>
+#include <utility>
+
+static_assert(Operation::OpId::NUMBER_OF_OPERATIONS <= UINT16_MAX, "opId does not fit into NormalEntry");
+
+void Predecoder::init(Architecture arch, const RV_ISA_Config *isa_config) {
+	this->arch = arch;
+	this->isa_config = isa_config;
+	if (isa_config != nullptr) {
+		compressed_table = get_compressed_table(arch, *isa_config);
+		normal_table = get_normal_table(arch, *isa_config);
+	} else {
+		compressed_table.reset();
+		normal_table.reset();
+	}
+}
+
+std::shared_ptr<const Predecoder::CompressedEntry[]> Predecoder::get_compressed_table(
+    Architecture arch, const RV_ISA_Config &isa_config) {
+	static std::mutex lock;
+	static std::map<std::pair<Architecture, uint64_t>, std::shared_ptr<const CompressedEntry[]>> tables;
+
+	std::lock_guard<std::mutex> guard(lock);
+	auto &table = tables[std::make_pair(arch, isa_config.cfg)];
+	if (table) {
+		return table;
+	}
+
+	std::shared_ptr<CompressedEntry[]> t(new CompressedEntry[COMPRESSED_TABLE_SIZE]);
+	for (uint32_t i = 0; i < COMPRESSED_TABLE_SIZE; i++) {
+		CompressedEntry &e = t[i];
+		if ((i & 0x3) == 0x3) {
+			/* no compressed encoding */
+			e = {0, Operation::OpId::UNDEF, FLAG_FALLBACK};
+			continue;
+		}
+		Instruction instr(i);
+		try {
+			e.opId = instr.decode_and_expand_compressed(arch, isa_config);
+		} catch (std::exception &) {
+			e = {0, Operation::OpId::UNDEF, FLAG_FALLBACK};
+			continue;
+		}
+		/* an expanded instruction is never compressed */
+		if (instr.is_compressed()) {
+			e.instr = 0;
+			e.flags = 0;
+		} else {
+			e.instr = instr.data();
+			e.flags = FLAG_EXPANDED;
+		}
+	}
+	table = t;
+	return table;
+}
+
+/*
+ * decode all combinations of representative register fields of the encoding at index
+ *  * rd: 0 (-> opId_rdzero), 1, 31 (-> opId)
+ *  * rs1, rs2: 0, 1, 2, 3, 31 (sub-operations are selected by small values, e.g. fcvt.*, vector unary operations)
+ * -> fallback, if the operation depends on rs1/rs2 or on rd other than rd == 0, or if the decoder throws
+ */
+Predecoder::NormalEntry Predecoder::normal_probe(Architecture arch, const RV_ISA_Config &isa_config,
+                                                 uint32_t index) {
+	const NormalEntry fallback = {Operation::OpId::UNDEF, Operation::OpId::UNDEF, FLAG_FALLBACK};
+	const uint32_t rds[] = {0, 1, 31};
+	const uint32_t rss[] = {0, 1, 2, 3, 31};
+
+	uint32_t base = 0x3 | ((index & 0x1f) << 2) | (((index >> 5) & 0x7) << 12) | ((index >> 8) << 25);
+	NormalEntry e = {};
+	bool first_rdzero = true, first = true;
+	for (uint32_t rd : rds) {
+		for (uint32_t rs1 : rss) {
+			for (uint32_t rs2 : rss) {
+				Instruction instr(base | (rd << 7) | (rs1 << 15) | (rs2 << 20));
+				Operation::OpId opId;
+				try {
+					opId = instr.decode_normal(arch, isa_config);
+				} catch (std::exception &) {
+					return fallback;
+				}
+				uint16_t &op = (rd == 0) ? e.opId_rdzero : e.opId;
+				bool &first_op = (rd == 0) ? first_rdzero : first;
+				if (first_op) {
+					op = opId;
+					first_op = false;
+				} else if (op != opId) {
+					return fallback;
+				}
+			}
+		}
+	}
+	return e;
+}
+
+std::shared_ptr<const Predecoder::NormalEntry[]> Predecoder::get_normal_table(Architecture arch,
+                                                                              const RV_ISA_Config &isa_config) {
+	static std::mutex lock;
+	static std::map<std::pair<Architecture, uint64_t>, std::shared_ptr<const NormalEntry[]>> tables;
+
+	std::lock_guard<std::mutex> guard(lock);
+	auto &table = tables[std::make_pair(arch, isa_config.cfg)];
+	if (table) {
+		return table;
+	}
+
+	std::shared_ptr<NormalEntry[]> t(new NormalEntry[NORMAL_TABLE_SIZE]);
+	for (uint32_t i = 0; i < NORMAL_TABLE_SIZE; i++) {
+		t[i] = normal_probe(arch, isa_config, i);
+	}
+	table = t;
+	return table;
+}
+
+unsigned int Predecoder::get_normal_fallbacks() const {
+	unsigned int n = 0;
+	for (unsigned int i = 0; normal_table && i < NORMAL_TABLE_SIZE; i++) {
+		if (normal_table[i].flags & FLAG_FALLBACK) {
+			n++;
+		}
+	}
+	return n;
+}
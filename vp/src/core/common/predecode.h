@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2024-2026 Manfred Schlaegl <manfred.schlaegl@gmx.at>
+ * see dbbcache.h
+ */
+
+#ifndef RISCV_ISA_PREDECODE_H
+#define RISCV_ISA_PREDECODE_H
+
+#include <cstdint>
+#include <memory>
+
+#include "core_defs.h"
+#include "instr.h"
+#include "util/common.h"
+
+/*
+ * Table-driven instruction decoder (used by the DBBCache for all decodes)
+ * Results are identical to Instruction::decode_and_expand_compressed/decode_normal, since all tables are generated
+ * with these reference decoders.
+ *  * Compressed: One table with an entry (expanded instruction + opId) for each of the 64K encodings.
+ *  * Normal (32 bit): Dispatch table indexed by opcode (bits 6..2), funct3 and funct7 (32K entries). An entry holds
+ *    the opId for rd != 0 and rd == 0 (e.g. ADD/ADD_NOP), if the operation of the encoding does not depend on the
+ *    remaining fields (rs1, rs2). Otherwise (e.g. system instructions, fcvt.*, lr.*, unit-stride vector loads/stores,
+ *    vector unary operations), the entry refers to the reference decoder (FLAG_FALLBACK).
+ *    The dependency is determined on generation by probing the reference decoder with representative values of rd,
+ *    rs1 and rs2 (see normal_probe). predecode-bench (vp/tests/unit) verifies the result against the reference decoder
+ *    (optionally for all 2^30 normal encodings).
+ * The tables are generated on init once for each architecture and ISA config and are shared by all harts using them.
+ * The ISA config must not be changed after init.
+ */
+class Predecoder {
+   public:
+	struct CompressedEntry {
+		/* expanded instruction */
+		uint32_t instr;
+		Operation::OpId opId;
+		/* see FLAG_* */
+		uint32_t flags;
+	};
+
+	/* instruction was expanded (instr is valid) */
+	const static uint32_t FLAG_EXPANDED = 1 << 0;
+	/* reference decoder failed on generation (exception) -> has to be called on decode */
+	const static uint32_t FLAG_FALLBACK = 1 << 1;
+
+	struct NormalEntry {
+		/* operation for rd != 0 and rd == 0 */
+		uint16_t opId;
+		uint16_t opId_rdzero;
+		/* see FLAG_* */
+		uint32_t flags;
+	};
+
+	const static unsigned int COMPRESSED_TABLE_SIZE = 1 << 16;
+	/* opcode (bits 6..2) | funct3 << 5 | funct7 << 8 */
+	const static unsigned int NORMAL_TABLE_SIZE = 1 << 15;
+
+   private:
+	Architecture arch = RV32;
+	const RV_ISA_Config *isa_config = nullptr;
+	std::shared_ptr<const CompressedEntry[]> compressed_table;
+	std::shared_ptr<const NormalEntry[]> normal_table;
+
+	static __always_inline unsigned int normal_index(uint32_t instr) {
+		return ((instr >> 2) & 0x1f) | (((instr >> 12) & 0x7) << 5) | ((instr >> 25) << 8);
+	}
+
+	static NormalEntry normal_probe(Architecture arch, const RV_ISA_Config &isa_config, uint32_t index);
+
+   public:
+	Predecoder() {
+		init(RV32, nullptr);
+	}
+
+	Predecoder(const Predecoder &) = delete;
+	Predecoder &operator=(const Predecoder &) = delete;
+
+	/* (re-)initialize for arch and isa_config (nullptr -> uninitialized) */
+	void init(Architecture arch, const RV_ISA_Config *isa_config);
+
+	/* generate the compressed/normal table for arch and isa_config (shared, see above) */
+	static std::shared_ptr<const CompressedEntry[]> get_compressed_table(Architecture arch,
+	                                                                    const RV_ISA_Config &isa_config);
+	static std::shared_ptr<const NormalEntry[]> get_normal_table(Architecture arch, const RV_ISA_Config &isa_config);
+
+	/* number of normal table entries using the reference decoder (see FLAG_FALLBACK) */
+	unsigned int get_normal_fallbacks() const;
+
+	/* decode (and expand, if compressed) instr -> same as the reference decoders */
+	__always_inline Operation::OpId decode(Instruction &instr) {
+		if (instr.is_compressed()) {
+			const CompressedEntry &e = compressed_table[instr.data() & 0xffff];
+			if (likely(e.flags == FLAG_EXPANDED)) {
+				instr = Instruction(e.instr);
+				return e.opId;
+			} else if (unlikely(e.flags & FLAG_FALLBACK)) {
+				return instr.decode_and_expand_compressed(arch, *isa_config);
+			}
+			/* not expanded (e.g. illegal) -> instr is not changed */
+			return e.opId;
+		}
+
+		const NormalEntry &e = normal_table[normal_index(instr.data())];
+		if (likely(e.flags == 0)) {
+			return (Operation::OpId)(instr.rd() != 0 ? e.opId : e.opId_rdzero);
+		}
+		return instr.decode_normal(arch, *isa_config);
+	}
+};
+
+#endif /* RISCV_ISA_PREDECODE_H */
@@ -0,0 +1,56 @@
+/*
+ * Reservation Table
+ * Reservation sets of LR/SC on dmi memory, which are implemented with host atomics instead of the bus lock (see
+ * CombinedMemoryInterface_T in mem.h).
+ * A reservation set is a 64 byte line of host memory. Lines are hashed to slots, each slot holds a generation, which
+ * is incremented (atomically) by every successful SC and every AMO on the lines of the slot:
+ *  * LR: remembers the generation of the slot (and the loaded value, see mem.h)
+ *  * SC: succeeds, if the generation of the slot is unchanged (commit) and the memory still holds the loaded value
+ *    (compare-and-swap). Plain stores (e.g. via LSCache) are not tracked, but detected by the value compare (ABA is
+ *    tolerated, like e.g. in QEMU).
+ * Lines sharing a slot lead to spurious SC failures, which are allowed by the RISC-V ISA.
+ *
+ * There is one table for all harts (and memories), since it is keyed by host addresses.
+ */
+
+#ifndef RISCV_ISA_RESERVATION_TABLE_H
+#define RISCV_ISA_RESERVATION_TABLE_H
+
+#include <cstdint>
+
+#include "util/common.h"
+
+class ReservationTable {
+	const static unsigned int LINE_SHIFT = 6;
+	const static unsigned int SLOTS = 4096;
+
+	uint64_t gen[SLOTS] = {};
+
+	static ReservationTable &table() {
+		static ReservationTable table;
+		return table;
+	}
+
+	static __always_inline uint64_t &slot(const void *host_addr) {
+		return table().gen[((uintptr_t)host_addr >> LINE_SHIFT) & (SLOTS - 1)];
+	}
+
+   public:
+	/* LR: returns the reservation for the line containing host_addr */
+	static __always_inline uint64_t reserve(const void *host_addr) {
+		return __atomic_load_n(&slot(host_addr), __ATOMIC_ACQUIRE);
+	}
+
+	/* SC: returns true, if the reservation is still valid (reservations of other harts are invalidated) */
+	static __always_inline bool commit(const void *host_addr, uint64_t reservation) {
+		return __atomic_compare_exchange_n(&slot(host_addr), &reservation, reservation + 1, false, __ATOMIC_ACQ_REL,
+		                                   __ATOMIC_RELAXED);
+	}
+
+	/* AMO: invalidate all reservations for the line containing host_addr */
+	static __always_inline void invalidate(const void *host_addr) {
+		__atomic_fetch_add(&slot(host_addr), 1, __ATOMIC_RELEASE);
+	}
+};
+
+#endif /* RISCV_ISA_RESERVATION_TABLE_H */
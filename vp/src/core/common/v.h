@@ -717,6 +717,130 @@ class VExtension {
 		return std::make_pair(vec_idx, elem_num);
 	}
 
+	/*
+	 * element load/store via LSCache
+	 * misaligned elements (not supported by the LSCache load/store functions) are accessed via the LSCache bulk
+	 * functions or, if not cached or crossing a page boundary, with a single access of the memory interface (as before
+	 * the LSCache was used) -> an element is never split into several accesses (no partially committed store of an
+	 * element, if a later part of it traps)
+	 */
+	op_reg_t vElementLoad(xlen_reg_t numBits, xlen_reg_t addr) {
+		xlen_reg_t numBytes = numBits >> 3;
+		if (likely((addr & (numBytes - 1)) == 0)) {
+			switch (numBits) {
+				case 8:
+					return iss.lscache.load_ubyte(addr);
+				case 16:
+					return iss.lscache.load_uhalf(addr);
+				case 32:
+					return iss.lscache.load_uword(addr);
+				case 64:
+					return iss.lscache.load_double(addr);
+			}
+		}
+
+		op_reg_t value = 0;
+		void* haddr = iss.lscache.get_host_addr_load(addr, numBytes);
+		if (haddr != nullptr) {
+			memcpy(&value, haddr, numBytes);
+			return value;
+		}
+		switch (numBits) {
+			case 16:
+				return iss.mem->load_uhalf(addr);
+			case 32:
+				return iss.mem->load_uword(addr);
+			default: /* 64 (8 bit elements are always aligned) */
+				return iss.mem->load_double(addr);
+		}
+	}
+
+	void vElementStore(xlen_reg_t numBits, xlen_reg_t addr, op_reg_t value) {
+		xlen_reg_t numBytes = numBits >> 3;
+		if (likely((addr & (numBytes - 1)) == 0)) {
+			switch (numBits) {
+				case 8:
+					iss.lscache.store_byte(addr, value);
+					return;
+				case 16:
+					iss.lscache.store_half(addr, value);
+					return;
+				case 32:
+					iss.lscache.store_word(addr, value);
+					return;
+				case 64:
+					iss.lscache.store_double(addr, value);
+					return;
+			}
+		}
+
+		void* haddr = iss.lscache.get_host_addr_store(addr, numBytes);
+		if (haddr != nullptr) {
+			memcpy(haddr, &value, numBytes);
+			return;
+		}
+		switch (numBits) {
+			case 16:
+				iss.mem->store_half(addr, value);
+				return;
+			case 32:
+				iss.mem->store_word(addr, value);
+				return;
+			default: /* 64 (8 bit elements are always aligned) */
+				iss.mem->store_double(addr, value);
+				return;
+		}
+	}
+
+	/*
+	 * contiguous loads/stores: nelem elements of numBits are contiguous in memory (starting at rs1) and in the register
+	 * file (starting at rd), all elements are active (starting at vstart)
+	 * Runs of elements within a page are copied directly between host memory (LSCache) and the register file, element
+	 * accesses (which fill the LSCache) are only used on LSCache misses, page boundaries and memory without dmi.
+	 * NOTE: the register file is stored in host byte order -> little-endian host required (see get_reg)
+	 */
+	void vLoadStoreContiguous(load_store_t ldst, xlen_reg_t numBits, xlen_reg_t nelem) {
+		xlen_reg_t numBytes = numBits >> 3;
+		xlen_reg_t base = iss_reg_read_unsigned(iss.instr.rs1());
+		uint8_t* reg = (uint8_t*)v_regs + iss.instr.rd() * VLENB;
+
+		for (xlen_reg_t i = iss.csrs.vstart.reg.val; i < nelem;) {
+			iss.csrs.vstart.reg.val = i;
+			xlen_reg_t addr = base + i * numBytes;
+
+			/* elements in the page of addr */
+			xlen_reg_t run = std::min(nelem - i, (0x1000 - (addr & 0xFFF)) / numBytes);
+			if (run > 0) {
+				xlen_reg_t len = run * numBytes;
+				if (ldst == load_store_t::load) {
+					void* haddr = iss.lscache.get_host_addr_load(addr, len);
+					if (haddr != nullptr) {
+						memcpy(reg + i * numBytes, haddr, len);
+						i += run;
+						continue;
+					}
+				} else {
+					void* haddr = iss.lscache.get_host_addr_store(addr, len);
+					if (haddr != nullptr) {
+						memcpy(haddr, reg + i * numBytes, len);
+						i += run;
+						continue;
+					}
+				}
+			}
+
+			if (ldst == load_store_t::load) {
+				op_reg_t value = vElementLoad(numBits, addr);
+				memcpy(reg + i * numBytes, &value, numBytes);
+			} else {
+				op_reg_t value = 0;
+				memcpy(&value, reg + i * numBytes, numBytes);
+				vElementStore(numBits, addr, value);
+			}
+			i++;
+		}
+	}
+
 	void vLoadStore(load_store_t ldst, xlen_reg_t numBits, load_store_type_t ldstType) {
 		auto [effective_mul_idx, evl] = vLoadReqs(ldstType, true, numBits);
 		bool break_loop = false;
@@ -771,6 +895,17 @@ class VExtension {
 			v_assert(v_is_aligned(vd, vd_emul), "vd is not aligned");
 		}
 
+		/* unmasked unit-stride (also whole register, mask and strided with stride = element size) -> contiguous */
+		if (iss.instr.vm() &&
+		    ((ldstType == load_store_type_t::standard && iss.instr.nf() == 0) ||
+		     ldstType == load_store_type_t::whole || ldstType == load_store_type_t::masked ||
+		     (ldstType == load_store_type_t::standard_reg && iss.instr.nf() == 0 &&
+		      iss_reg_read(iss.instr.rs2()) == (numBits >> 3)))) {
+			xlen_reg_t nelem = (ldstType == load_store_type_t::whole) ? evl * (iss.instr.nf() + 1) : evl;
+			vLoadStoreContiguous(ldst, numBits, nelem);
+			return;
+		}
+
 		for (xlen_reg_t i = 0; i < evl; ++i) {
 			bool is_inactive = vInactiveHandling(i, evl);
 			if (!is_inactive) {
@@ -783,21 +918,7 @@ class VExtension {
 					op_reg_t value;
 
 					if (ldst == load_store_t::load) {
-						// TODO: implement loads in LSCache able to handle unaligned access and optimized for vector
-						switch (switchElem) {
-							case 8:
-								value = iss.mem->load_byte(addr);
-								break;
-							case 16:
-								value = iss.mem->load_half(addr);
-								break;
-							case 32:
-								value = iss.mem->load_word(addr);
-								break;
-							case 64:
-								value = iss.mem->load_double(addr);
-								break;
-						}
+						value = vElementLoad(switchElem, addr);
 
 						if (ldstType == load_store_type_t::fofl) {
 							try {
@@ -817,21 +938,7 @@ class VExtension {
 
 					} else {
 						value = getSewSingleOperand(switchElem, vec_idx, elem_num, false);
-						// TODO: implement stores in LSCache able to handle unaligned access and optimized for vector
-						switch (switchElem) {
-							case 8:
-								iss.mem->store_byte(addr, value);
-								break;
-							case 16:
-								iss.mem->store_half(addr, value);
-								break;
-							case 32:
-								iss.mem->store_word(addr, value);
-								break;
-							case 64:
-								iss.mem->store_double(addr, value);
-								break;
-						}
+						vElementStore(switchElem, addr, value);
 					}
 				}
 				if (break_loop) {
@@ -32,6 +32,14 @@ ISS_CT::ISS_CT(RV_ISA_Config *isa_config, uxlen_t hart_id)
     : isa_config(isa_config), stats(hart_id), v_ext(*this), systemc_name("Core-" + std::to_string(hart_id)) {
 	csrs.mhartid.reg.val = hart_id;
 	csrs.misa.reg.fields.extensions = isa_config->get_misa_extensions();
+#ifdef ISS_CT_FIXED_ISA_CFG
+	if (isa_config->cfg != (ISS_CT_FIXED_ISA_CFG)) {
+		std::stringstream ss;
+		ss << "ISS: ISA config (0x" << std::hex << isa_config->cfg << ") does not match the fixed ISA config (0x"
+		   << (ISS_CT_FIXED_ISA_CFG) << ") of this ISS build (see ISS_FIXED_CONFIG)";
+		throw std::runtime_error(ss.str());
+	}
+#endif
 
 	/* get config properties from global property tree (or use default) */
 	VPPP_PROPERTY_GET("ISS." + name(), "clock_cycle_period", sc_core::sc_time, prop_clock_cycle_period);
@@ -41,6 +49,20 @@ ISS_CT::ISS_CT(RV_ISA_Config *isa_config, uxlen_t hart_id)
 	assert(qt >= prop_clock_cycle_period);
 	assert(qt % prop_clock_cycle_period == sc_core::SC_ZERO_TIME);
 
+	/* max memory used by the DBBCache of this hart in bytes (0 = unlimited) */
+	uint64_t dbbcache_memory_budget = dbbcache.get_memory_budget();
+	VPPP_PROPERTY_GET("ISS." + name(), "dbbcache_memory_budget", uint64_t, dbbcache_memory_budget);
+	dbbcache.set_memory_budget(dbbcache_memory_budget);
+
+	/* geometry of the LSCache of this hart (see lscache.h) */
+	uint64_t lscache_sets = lscache.get_sets();
+	uint64_t lscache_ways = lscache.get_ways();
+	uint64_t lscache_victims = lscache.get_victims();
+	VPPP_PROPERTY_GET("ISS." + name(), "lscache_sets", uint64_t, lscache_sets);
+	VPPP_PROPERTY_GET("ISS." + name(), "lscache_ways", uint64_t, lscache_ways);
+	VPPP_PROPERTY_GET("ISS." + name(), "lscache_victims", uint64_t, lscache_victims);
+	lscache.set_geometry(lscache_sets, lscache_ways, lscache_victims);
+
 	/*
 	 * NOTE: The cycle model below is a static cycle model -> Value changes at
 	 * runtime may have no effect (since cycles may be cached)
@@ -221,20 +243,35 @@ void ISS_CT::print_trace() {
 #define OP_LABLE_ENTRIES_SEC_STR M_DEFINE2STR(OP_LABEL_ENTRIES_SECNAME)
 #define OP_LABEL_ENTIRES_SEC_START M_JOIN(__start_, OP_LABEL_ENTRIES_SECNAME)
 #define OP_LABEL_ENTIRES_SEC_STOP M_JOIN(__stop_, OP_LABEL_ENTRIES_SECNAME)
+/* fused instruction pair entry section handling (see Fusion) */
+#define OP_FUSION_LABEL_ENTRIES_SECNAME M_JOIN(OP_PREFIX, op_fusion_label_entries)
+#define OP_FUSION_LABEL_ENTRIES_SEC_STR M_DEFINE2STR(OP_FUSION_LABEL_ENTRIES_SECNAME)
+#define OP_FUSION_LABEL_ENTRIES_SEC_START M_JOIN(__start_, OP_FUSION_LABEL_ENTRIES_SECNAME)
+#define OP_FUSION_LABEL_ENTRIES_SEC_STOP M_JOIN(__stop_, OP_FUSION_LABEL_ENTRIES_SECNAME)
 /* fast_abort_and_fdd_labelPtr handling */
 #define OP_GLOBAL_FAST_ABORT_AND_FDD_LABEL_NAME M_JOIN(OP_PREFIX, op_global_fast_abort_and_fdd_labelPtr)
 #define OP_GLOBAL_FAST_ABORT_AND_FDD_LABEL_STR M_DEFINE2STR(OP_GLOBAL_FAST_ABORT_AND_FDD_LABEL_NAME)
 #define OP_GLOBAL_FAST_ABORT_AND_FDD_LABEL_START M_JOIN(__start_, OP_GLOBAL_FAST_ABORT_AND_FDD_LABEL_NAME)
+/* jit_labelPtr handling (see DBBCache::jit_exec) */
+#define OP_GLOBAL_JIT_LABEL_NAME M_JOIN(OP_PREFIX, op_global_jit_labelPtr)
+#define OP_GLOBAL_JIT_LABEL_STR M_DEFINE2STR(OP_GLOBAL_JIT_LABEL_NAME)
+#define OP_GLOBAL_JIT_LABEL_START M_JOIN(__start_, OP_GLOBAL_JIT_LABEL_NAME)
 /* explicitly defined labels */
 #define OP_LABEL(_name) M_JOIN(OP_PREFIX, M_JOIN(op_label_, _name))
 #define OP_LABEL_ENTRY(_name) M_JOIN(OP_PREFIX, M_JOIN(op_label_, _name))
 /* for labels generated in OP_CASE */
 #define OP_LABEL_OP(_op) M_JOIN(OP_LABEL(op_), _op)
 #define OP_LABEL_ENTRY_OP(_op) M_JOIN(OP_LABEL(entry_), _op)
+/* for labels generated in OP_FUSION_CASE */
+#define OP_LABEL_FUSION(_fusion) M_JOIN(OP_LABEL(fusion_), _fusion)
+#define OP_LABEL_ENTRY_FUSION(_fusion) M_JOIN(OP_LABEL(fusion_entry_), _fusion)
 
 extern void *const OP_GLOBAL_FAST_ABORT_AND_FDD_LABEL_START;
+extern void *const OP_GLOBAL_JIT_LABEL_START;
 extern const struct op_label_entry OP_LABEL_ENTIRES_SEC_START;
 extern const struct op_label_entry OP_LABEL_ENTIRES_SEC_STOP;
+extern const struct op_fusion_label_entry OP_FUSION_LABEL_ENTRIES_SEC_START;
+extern const struct op_fusion_label_entry OP_FUSION_LABEL_ENTRIES_SEC_STOP;
 
 namespace rv32 {
 void *ISS_CT::genOpMap() {
@@ -274,6 +311,22 @@ void *ISS_CT::genOpMap() {
 		throw std::runtime_error("[ISS] Unimplemented operation(s) (see above)");
 	}
 
+	// fill fused pair labels (pairs are optional -> not implemented ones stay nullptr)
+	for (unsigned int id = 0; id < Fusion::NUMBER_OF_FUSIONS; id++) {
+		fusionMap[id] = nullptr;
+	}
+	struct op_fusion_label_entry *fusion_entry = (struct op_fusion_label_entry *)&OP_FUSION_LABEL_ENTRIES_SEC_START;
+	struct op_fusion_label_entry *fusion_end = (struct op_fusion_label_entry *)&OP_FUSION_LABEL_ENTRIES_SEC_STOP;
+	for (; fusion_entry < fusion_end; fusion_entry++) {
+		if (fusion_entry->id == Fusion::NONE || (unsigned int)fusion_entry->id >= Fusion::NUMBER_OF_FUSIONS ||
+		    fusionMap[fusion_entry->id] != nullptr) {
+			std::cerr << "[ISS] Error: Invalid or multiple implementations for fused pair " << fusion_entry->id
+			          << std::endl;
+			throw std::runtime_error("[ISS] Invalid fused pair implementation (see above)");
+		}
+		fusionMap[fusion_entry->id] = fusion_entry->labelPtr;
+	}
+
 	return OP_GLOBAL_FAST_ABORT_AND_FDD_LABEL_START;
 }
 
@@ -301,10 +354,8 @@ void *ISS_CT::genOpMap() {
 
 #define GOTO_OP_GLOBAL_FDD() goto OP_LABEL(op_global_fdd);
 
-/* fast operation finalization and fdd (TODO: move ninstr check to control flow ops?) */
-#define OP_FAST_FINALIZE_AND_FDD() \
-	ninstr++;                      \
-	GOTO_OP_FAST_FDD();
+/* fast operation finalization and fdd (instructions and cycles are accounted by the DBBCache) */
+#define OP_FAST_FINALIZE_AND_FDD() GOTO_OP_FAST_FDD();
 
 #define OP_GLOBAL_FDD() OP_LABEL(op_global_fdd) :
 
@@ -316,10 +367,25 @@ void *ISS_CT::genOpMap() {
 	    : static void * OP_GLOBAL_FAST_ABORT_AND_FDD_LABEL_NAME                    \
 	      __attribute__((used, section(OP_GLOBAL_FAST_ABORT_AND_FDD_LABEL_STR))) = \
 	    &&OP_LABEL(op_global_fast_abort_and_fdd);                                  \
-	dbbcache.abort_fetch_decode_fast();                                            \
+	if (unlikely(dbbcache.abort_fetch_decode_fast())) {                            \
+		/* stopped before breakpoint -> check in slow path */                      \
+		force_slow_path();                                                         \
+	}                                                                              \
 	stats.dec_cnt();                                                               \
 	stats.inc_fast_fdd_abort();                                                    \
 	GOTO_OP_GLOBAL_FDD();                                                          \
+	OP_LABEL(op_global_jit)                                                        \
+	    : static void * OP_GLOBAL_JIT_LABEL_NAME                                   \
+	      __attribute__((used, section(OP_GLOBAL_JIT_LABEL_STR))) =                \
+	    &&OP_LABEL(op_global_jit);                                                 \
+	{                                                                              \
+		/* translated block: executed -> continue with next entry */               \
+		void *fallbackLabelPtr = dbbcache.jit_exec(regs.regs);                     \
+		if (unlikely(fallbackLabelPtr != nullptr)) {                               \
+			/* not on fast path -> operation of the entry */                       \
+			goto *fallbackLabelPtr;                                                \
+		}                                                                          \
+	}                                                                              \
 	OP_LABEL(op_global_fast_finalize_and_fdd) : __attribute__((unused));           \
 	{OP_FAST_FINALIZE_AND_FDD()}
 
@@ -329,6 +395,28 @@ void *ISS_CT::genOpMap() {
 	          __attribute__((used, section(OP_LABLE_ENTRIES_SEC_STR))) = {Operation::OpId::_op, &&OP_LABEL_OP(_op)}; \
 	stats.inc_op(Operation::OpId::_op);
 
+/*
+ * handler of the fused pair _fusion with the first operation _op (see Fusion)
+ * not on the fast path (e.g. trace, single step) -> only _op is executed
+ */
+#define OP_FUSION_CASE(_fusion, _op)                                                                          \
+	OP_LABEL_FUSION(_fusion)                                                                                  \
+	    : static struct op_fusion_label_entry OP_LABEL_ENTRY_FUSION(_fusion)                                  \
+	          __attribute__((used, section(OP_FUSION_LABEL_ENTRIES_SEC_STR))) = {Fusion::_fusion,             \
+	                                                                             &&OP_LABEL_FUSION(_fusion)}; \
+	if (unlikely(!dbbcache.in_fast_path())) {                                                                 \
+		goto OP_LABEL_OP(_op);                                                                                \
+	}                                                                                                         \
+	stats.inc_fusion(Fusion::_fusion);                                                                        \
+	stats.inc_op(Operation::OpId::_op);
+
+/* end of the first operation of a fused pair -> continue directly with the second operation _op */
+#define OP_FUSION_END(_op)       \
+	stats.inc_cnt();             \
+	stats.inc_fast_fdd();        \
+	dbbcache.fusion_next(instr); \
+	goto OP_LABEL_OP(_op);
+
 #define OP_INVALID_END()                                                                                             \
 	if (trace) {                                                                                                     \
 		std::cout << "[ISS] WARNING: RV64 instruction not supported on RV32 " << std::to_string(instr.data())        \
@@ -373,14 +461,6 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 	// TODO: remove?
 	assert(regs.read(0) == 0);
 
-	/*
-	 * Check quantum in fast path roughly every tenth of a quantum (heuristic)
-	 * Uncertainties: time is also increasing outside of ISS; not every instruction has cycle_time
-	 */
-	const uint64_t fast_quantum_ins_granularity =
-	    quantum_keeper.get_global_quantum().value() / prop_clock_cycle_period.value() / 10;
-	uint64_t ninstr = 0;
-	ninstr_last = ninstr;
 
 	// TODO: remove?
 	assert(((pc & ~pc_alignment_mask()) == 0) && "misaligned instruction");
@@ -394,12 +474,16 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 			OP_GLOBAL_FDD() {
 				pc = dbbcache.get_pc_maybe_after_callback();
 
-				if (unlikely(iss_slow_path)) {
+				if (unlikely(iss_slow_path || dbbcache.requests_pending())) {
 					iss_slow_path = false;
 
-					/* update instr and cycle counters by local fast counters, update quantum_keeper and reset fast
-					 * quantum */
-					commit_all_and_reset_fast_quantum(ninstr);
+					/* requests of other harts, devices or the debugger (interrupts, halts, ...) */
+					if (dbbcache.requests_pending()) {
+						handle_requests();
+					}
+
+					/* update instr and cycle counters, update quantum_keeper and the quantum budget */
+					commit_all();
 
 					/* call interrupt handling */
 					handle_interrupt();
@@ -431,15 +515,21 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 						stats.inc_qk_need_sync();
 						if (quantum_keeper.need_sync()) {
 							stats.inc_qk_sync();
-							quantum_keeper.sync();
+							sync_quantum();
 						}
 					}
 
 					/* speeds up the execution performance (non debug mode) significantly by */
 					/* checking the additional flag first */
 					if (debug_mode) {
-						/* always stay in slow path if debug enabled */
-						force_slow_path();
+						/*
+						 * stay in slow path only for single steps
+						 * breakpoints are signaled by the DBBCache (see abort_fetch_decode_fast) -> fast path
+						 * between breakpoints
+						 */
+						if (debug_single_step) {
+							force_slow_path();
+						}
 
 						/* stop after single step */
 						if (debug_single_step && debug_single_step_done) {
@@ -459,17 +549,17 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 					assert(false);
 				}
 
-				if (unlikely(ninstr > fast_quantum_ins_granularity)) {
-					/* update instr and cycle counters by local fast counters, update quantum_keeper and reset fast
-					 * quantum */
-					commit_all_and_reset_fast_quantum(ninstr);
+				/* exact check (incl. current block) -> also covers the dummyBlock path of a disabled DBBCache */
+				if (unlikely(dbbcache.get_cycle_counter_raw() >= cycle_counter_raw_quantum_end)) {
+					/* update instr and cycle counters, update quantum_keeper and the quantum budget */
+					commit_all();
 					stats.inc_qk_need_sync();
 					if (quantum_keeper.need_sync()) {
 						// TODO: must also be done for transactions (keeper in common/mem.h) ?!
 						/* sync pc member variable before potential SysC context switch */
 						// pc = dbbcache.get_pc_maybe_after_callback();
 						stats.inc_qk_sync();
-						quantum_keeper.sync();
+						sync_quantum();
 					}
 				}
 
@@ -708,8 +798,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(J) {
 					stats.inc_j();
 					dbbcache.jump(instr.J_imm());
-					if (unlikely(ninstr > fast_quantum_ins_granularity)) {
-						ninstr++;
+					if (unlikely(quantum_budget_exhausted())) {
 						GOTO_OP_GLOBAL_FDD();
 					}
 				}
@@ -718,8 +807,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(JAL) {
 					stats.inc_jal();
 					regs[instr.rd()] = dbbcache.jump_and_link(instr.J_imm());
-					if (unlikely(ninstr > fast_quantum_ins_granularity)) {
-						ninstr++;
+					if (unlikely(quantum_budget_exhausted())) {
 						GOTO_OP_GLOBAL_FDD();
 					}
 				}
@@ -729,15 +817,19 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 					stats.inc_jr();
 					uxlen_t pc = (regs[instr.rs1()] + instr.I_imm()) & ~1;
 
-					if (unlikely((pc & 0x3) && (!csrs.misa.has_C_extension()))) {
+					if (unlikely((pc & 0x3) && (!has_isa_ext(csr_misa::C)))) {
 						// NOTE: misaligned instruction address not possible on machines supporting compressed
 						// instructions
 						raise_trap(EXC_INSTR_ADDR_MISALIGNED, pc);
 					}
 
-					dbbcache.jump_dyn(pc);
-					if (unlikely(ninstr > fast_quantum_ins_granularity)) {
-						ninstr++;
+					/* jump via link register -> return (see return-address stack of DBBCache) */
+					if (likely(instr.rs1() == RegFile::ra || instr.rs1() == RegFile::t0)) {
+						dbbcache.jump_dyn_ret(pc);
+					} else {
+						dbbcache.jump_dyn(pc);
+					}
+					if (unlikely(quantum_budget_exhausted())) {
 						GOTO_OP_GLOBAL_FDD();
 					}
 				}
@@ -747,15 +839,14 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 					stats.inc_jalr();
 					uxlen_t pc = (regs[instr.rs1()] + instr.I_imm()) & ~1;
 
-					if (unlikely((pc & 0x3) && (!csrs.misa.has_C_extension()))) {
+					if (unlikely((pc & 0x3) && (!has_isa_ext(csr_misa::C)))) {
 						// NOTE: misaligned instruction address not possible on machines supporting compressed
 						// instructions
 						raise_trap(EXC_INSTR_ADDR_MISALIGNED, pc);
 					}
 
 					regs[instr.rd()] = dbbcache.jump_dyn_and_link(pc);
-					if (unlikely(ninstr > fast_quantum_ins_granularity)) {
-						ninstr++;
+					if (unlikely(quantum_budget_exhausted())) {
 						GOTO_OP_GLOBAL_FDD();
 					}
 				}
@@ -827,8 +918,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(BEQ) {
 					if (regs[instr.rs1()] == regs[instr.rs2()]) {
 						dbbcache.branch_taken(instr.B_imm());
-						if (unlikely(ninstr > fast_quantum_ins_granularity)) {
-							ninstr++;
+						if (unlikely(quantum_budget_exhausted())) {
 							GOTO_OP_GLOBAL_FDD();
 						}
 					} else {
@@ -840,8 +930,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(BNE) {
 					if (regs[instr.rs1()] != regs[instr.rs2()]) {
 						dbbcache.branch_taken(instr.B_imm());
-						if (unlikely(ninstr > fast_quantum_ins_granularity)) {
-							ninstr++;
+						if (unlikely(quantum_budget_exhausted())) {
 							GOTO_OP_GLOBAL_FDD();
 						}
 					} else {
@@ -853,8 +942,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(BLT) {
 					if (regs[instr.rs1()] < regs[instr.rs2()]) {
 						dbbcache.branch_taken(instr.B_imm());
-						if (unlikely(ninstr > fast_quantum_ins_granularity)) {
-							ninstr++;
+						if (unlikely(quantum_budget_exhausted())) {
 							GOTO_OP_GLOBAL_FDD();
 						}
 					} else {
@@ -866,8 +954,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(BGE) {
 					if (regs[instr.rs1()] >= regs[instr.rs2()]) {
 						dbbcache.branch_taken(instr.B_imm());
-						if (unlikely(ninstr > fast_quantum_ins_granularity)) {
-							ninstr++;
+						if (unlikely(quantum_budget_exhausted())) {
 							GOTO_OP_GLOBAL_FDD();
 						}
 					} else {
@@ -879,8 +966,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(BLTU) {
 					if ((uxlen_t)regs[instr.rs1()] < (uxlen_t)regs[instr.rs2()]) {
 						dbbcache.branch_taken(instr.B_imm());
-						if (unlikely(ninstr > fast_quantum_ins_granularity)) {
-							ninstr++;
+						if (unlikely(quantum_budget_exhausted())) {
 							GOTO_OP_GLOBAL_FDD();
 						}
 					} else {
@@ -892,8 +978,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(BGEU) {
 					if ((uxlen_t)regs[instr.rs1()] >= (uxlen_t)regs[instr.rs2()]) {
 						dbbcache.branch_taken(instr.B_imm());
-						if (unlikely(ninstr > fast_quantum_ins_granularity)) {
-							ninstr++;
+						if (unlikely(quantum_budget_exhausted())) {
 							GOTO_OP_GLOBAL_FDD();
 						}
 					} else {
@@ -902,6 +987,55 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				}
 				OP_END();
 
+				/*
+				 * fused instruction pairs (see Fusion and Macro-op fusion in dbbcache.h)
+				 * the first operation is executed inline, the second one via OP_FUSION_END
+				 */
+				OP_FUSION_CASE(LUI_ADDI, LUI) {
+					regs[instr.rd()] = instr.U_imm();
+				}
+				OP_FUSION_END(ADDI);
+
+				OP_FUSION_CASE(AUIPC_ADDI, AUIPC) {
+					regs[instr.rd()] = dbbcache.get_last_pc_before_callback() + instr.U_imm();
+				}
+				OP_FUSION_END(ADDI);
+
+				OP_FUSION_CASE(AUIPC_JALR, AUIPC) {
+					regs[instr.rd()] = dbbcache.get_last_pc_before_callback() + instr.U_imm();
+				}
+				OP_FUSION_END(JALR);
+
+				OP_FUSION_CASE(AUIPC_JR, AUIPC) {
+					regs[instr.rd()] = dbbcache.get_last_pc_before_callback() + instr.U_imm();
+				}
+				OP_FUSION_END(JR);
+
+				OP_FUSION_CASE(AUIPC_LW, AUIPC) {
+					regs[instr.rd()] = dbbcache.get_last_pc_before_callback() + instr.U_imm();
+				}
+				OP_FUSION_END(LW);
+
+				OP_FUSION_CASE(SLLI_SRLI, SLLI) {
+					regs[instr.rd()] = regs[instr.rs1()] << instr.shamt();
+				}
+				OP_FUSION_END(SRLI);
+
+				OP_FUSION_CASE(ADDI_BNE, ADDI) {
+					regs[instr.rd()] = regs[instr.rs1()] + instr.I_imm();
+				}
+				OP_FUSION_END(BNE);
+
+				OP_FUSION_CASE(ADDI_BLT, ADDI) {
+					regs[instr.rd()] = regs[instr.rs1()] + instr.I_imm();
+				}
+				OP_FUSION_END(BLT);
+
+				OP_FUSION_CASE(ADDI_BLTU, ADDI) {
+					regs[instr.rd()] = regs[instr.rs1()] + instr.I_imm();
+				}
+				OP_FUSION_END(BLTU);
+
 				/* rd != x0/zero variants */
 				OP_CASE(FENCE) {
 					lscache.fence();
@@ -916,7 +1050,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 
 				OP_CASE(ECALL) {
 					if (sys) {
-						sys->execute_syscall(this);
+						systemc_call([&]() { sys->execute_syscall(this); });
 					} else {
 						uxlen_t last_pc = dbbcache.get_last_pc_before_callback();
 						switch (prv) {
@@ -955,7 +1089,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 						auto rd = instr.rd();
 						auto rs1_val = regs[instr.rs1()];
 						if (rd != RegFile::zero) {
-							commit_instructions(ninstr);
+							commit_instructions_retired();
 							regs[instr.rd()] = get_csr_value(addr);
 						}
 						set_csr_value(addr, rs1_val);
@@ -973,7 +1107,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 					} else {
 						auto rd = instr.rd();
 						auto rs1_val = regs[rs1];
-						commit_instructions(ninstr);
+						commit_instructions_retired();
 						auto csr_val = get_csr_value(addr);
 						if (rd != RegFile::zero)
 							regs[rd] = csr_val;
@@ -993,7 +1127,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 					} else {
 						auto rd = instr.rd();
 						auto rs1_val = regs[rs1];
-						commit_instructions(ninstr);
+						commit_instructions_retired();
 						auto csr_val = get_csr_value(addr);
 						if (rd != RegFile::zero)
 							regs[rd] = csr_val;
@@ -1011,7 +1145,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 					} else {
 						auto rd = instr.rd();
 						if (rd != RegFile::zero) {
-							commit_instructions(ninstr);
+							commit_instructions_retired();
 							regs[rd] = get_csr_value(addr);
 						}
 						set_csr_value(addr, instr.zimm());
@@ -1027,7 +1161,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 					if (is_invalid_csr_access(addr, write)) {
 						RAISE_ILLEGAL_INSTRUCTION();
 					} else {
-						commit_instructions(ninstr);
+						commit_instructions_retired();
 						auto csr_val = get_csr_value(addr);
 						auto rd = instr.rd();
 						if (rd != RegFile::zero)
@@ -1046,7 +1180,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 					if (is_invalid_csr_access(addr, write)) {
 						RAISE_ILLEGAL_INSTRUCTION();
 					} else {
-						commit_instructions(ninstr);
+						commit_instructions_retired();
 						auto csr_val = get_csr_value(addr);
 						auto rd = instr.rd();
 						if (rd != RegFile::zero)
@@ -1141,7 +1275,8 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 					uxlen_t addr = regs[instr.rs1()];
 					trap_check_addr_alignment<4, true>(addr);
 					regs[instr.rd()] = mem->atomic_load_reserved_word(addr);
-					if (lr_sc_counter == 0) {
+					/* reservation held by the bus lock (no dmi, see CombinedMemoryInterface_T) -> release it again */
+					if (lr_sc_counter == 0 && mem->holds_bus_lock()) {
 						lr_sc_counter = 17;  // this instruction + 16 additional ones, (an over-approximation) to cover
 						                     // the RISC-V forward progress property
 						force_slow_path();
@@ -1521,7 +1656,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FADD_S) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f32_add(fp_regs.f32(RS1), fp_regs.f32(RS2)));
+					fp_regs.write(RD, FpHost::f32_add(fp_regs.f32(RS1), fp_regs.f32(RS2)));
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1529,7 +1664,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FSUB_S) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f32_sub(fp_regs.f32(RS1), fp_regs.f32(RS2)));
+					fp_regs.write(RD, FpHost::f32_sub(fp_regs.f32(RS1), fp_regs.f32(RS2)));
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1537,7 +1672,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FMUL_S) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f32_mul(fp_regs.f32(RS1), fp_regs.f32(RS2)));
+					fp_regs.write(RD, FpHost::f32_mul(fp_regs.f32(RS1), fp_regs.f32(RS2)));
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1545,7 +1680,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FDIV_S) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f32_div(fp_regs.f32(RS1), fp_regs.f32(RS2)));
+					fp_regs.write(RD, FpHost::f32_div(fp_regs.f32(RS1), fp_regs.f32(RS2)));
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1553,7 +1688,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FSQRT_S) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f32_sqrt(fp_regs.f32(RS1)));
+					fp_regs.write(RD, FpHost::f32_sqrt(fp_regs.f32(RS1)));
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1772,7 +1907,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FADD_D) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f64_add(fp_regs.f64(RS1), fp_regs.f64(RS2)));
+					fp_regs.write(RD, FpHost::f64_add(fp_regs.f64(RS1), fp_regs.f64(RS2)));
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1780,7 +1915,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FSUB_D) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f64_sub(fp_regs.f64(RS1), fp_regs.f64(RS2)));
+					fp_regs.write(RD, FpHost::f64_sub(fp_regs.f64(RS1), fp_regs.f64(RS2)));
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1788,7 +1923,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FMUL_D) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f64_mul(fp_regs.f64(RS1), fp_regs.f64(RS2)));
+					fp_regs.write(RD, FpHost::f64_mul(fp_regs.f64(RS1), fp_regs.f64(RS2)));
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1796,7 +1931,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FDIV_D) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f64_div(fp_regs.f64(RS1), fp_regs.f64(RS2)));
+					fp_regs.write(RD, FpHost::f64_div(fp_regs.f64(RS1), fp_regs.f64(RS2)));
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1804,7 +1939,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FSQRT_D) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f64_sqrt(fp_regs.f64(RS1)));
+					fp_regs.write(RD, FpHost::f64_sqrt(fp_regs.f64(RS1)));
 					fp_finish_instr();
 				}
 				OP_END();
@@ -6712,13 +6847,18 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 					if (s_mode() && csrs.mstatus.reg.fields.tw)
 						RAISE_ILLEGAL_INSTRUCTION();
 
-					if (u_mode() && csrs.misa.has_supervisor_mode_extension())
+					if (u_mode() && has_isa_ext(csr_misa::S))
 						RAISE_ILLEGAL_INSTRUCTION();
 
 					stats.inc_wfi();
 					if (!ignore_wfi) {
 						while (!has_local_pending_enabled_interrupts()) {
-							sc_core::wait(wfi_event);
+							if (hart_thread != nullptr) {
+								hart_thread->idle();
+								handle_dmi_invalidate();
+							} else {
+								sc_core::wait(wfi_event);
+							}
 						}
 					}
 				}
@@ -6727,14 +6867,18 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(SFENCE_VMA) {
 					if (s_mode() && csrs.mstatus.reg.fields.tvm)
 						RAISE_ILLEGAL_INSTRUCTION();
-					dbbcache.fence_vma(pc);
+					if (instr.rs1() != 0) {
+						dbbcache.fence_vma(pc, regs[instr.rs1()]);
+					} else {
+						dbbcache.fence_vma(pc);
+					}
 					lscache.fence_vma();
 					stats.inc_fence_vma();
 				}
 				OP_END();
 
 				OP_CASE(URET) {
-					if (!csrs.misa.has_user_mode_extension())
+					if (!has_isa_ext(csr_misa::U))
 						RAISE_ILLEGAL_INSTRUCTION();
 					return_from_trap_handler(UserMode);
 					stats.inc_uret();
@@ -6742,7 +6886,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_END();
 
 				OP_CASE(SRET) {
-					if (!csrs.misa.has_supervisor_mode_extension() || (s_mode() && csrs.mstatus.reg.fields.tsr))
+					if (!has_isa_ext(csr_misa::S) || (s_mode() && csrs.mstatus.reg.fields.tsr))
 						RAISE_ILLEGAL_INSTRUCTION();
 					return_from_trap_handler(SupervisorMode);
 					stats.inc_sret();
@@ -6767,16 +6911,15 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 			stats.inc_trap(e.reason);
 
 			/*
-			 * If a instruction traps, the number of instructions and cycles are
-			 * not updated by the above flow.
-			 * This is definitly wrong behavior, e.g. for ECALL, EBREAK, etc.
-			 * where trapping is their intended behavior, but it difficult e.g.
-			 * for faulting load/store instructions (e.g. page fault) and
-			 * similar cases.
+			 * Instructions and cycles of a trapping instruction are accounted
+			 * by the DBBCache like for any other executed instruction.
+			 * This is the intended behavior e.g. for ECALL, EBREAK, etc., but
+			 * it is difficult e.g. for faulting load/store instructions (e.g.
+			 * page fault) and similar cases.
 			 * There is no perfect solution for this, but for the moment, we decide
-			 * to count faulting instructions.
+			 * to count faulting instructions (except instructions with faulting
+			 * fetches, which are never executed).
 			 */
-			ninstr++;
 
 			handle_trap(e, last_pc);
 		}
@@ -6789,12 +6932,12 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 	/* update pc member variable */
 	pc = dbbcache.get_pc_maybe_after_callback();
 
-	/* update instr and cycle counters by local fast counters, update quantum_keeper and reset fast quantum */
-	commit_all_and_reset_fast_quantum(ninstr);
+	/* update instr and cycle counters, update quantum_keeper and the quantum budget */
+	commit_all();
 
 	/* sync quantum: make sure that no action is missed */
 	stats.inc_qk_sync();
-	quantum_keeper.sync();
+	sync_quantum();
 }
 /*
  * end of exec_steps
@@ -6822,8 +6965,8 @@ bool ISS_CT::is_invalid_csr_access(uxlen_t csr_addr, bool is_write) {
 	}
 	PrivilegeLevel csr_prv = (0x300 & csr_addr) >> 8;
 	bool csr_readonly = ((0xC00 & csr_addr) >> 10) == 3;
-	bool s_invalid = (csr_prv == SupervisorMode) && !csrs.misa.has_supervisor_mode_extension();
-	bool u_invalid = (csr_prv == UserMode) && !csrs.misa.has_user_mode_extension();
+	bool s_invalid = (csr_prv == SupervisorMode) && !has_isa_ext(csr_misa::S);
+	bool u_invalid = (csr_prv == UserMode) && !has_isa_ext(csr_misa::U);
 	return (is_write && csr_readonly) || (prv < csr_prv) || s_invalid || u_invalid;
 }
 
@@ -6849,13 +6992,15 @@ uxlen_t ISS_CT::get_csr_value(uxlen_t addr) {
 
 	switch (addr) {
 		case TIME_ADDR: {
-			uint64_t time = clint->update_and_get_mtime();
+			uint64_t time;
+			systemc_call([&]() { time = clint->update_and_get_mtime(); });
 			csrs.time.reg.val = time;
 			return csrs.time.reg.words.low;
 		}
 
 		case TIMEH_ADDR: {
-			uint64_t time = clint->update_and_get_mtime();
+			uint64_t time;
+			systemc_call([&]() { time = clint->update_and_get_mtime(); });
 			csrs.time.reg.val = time;
 			return csrs.time.reg.words.high;
 		}
@@ -6998,13 +7143,13 @@ void ISS_CT::set_csr_value(uxlen_t addr, uxlen_t value) {
 			break;
 
 		case MIP_ADDR:
-			write(csrs.mip, MIP_WRITE_MASK);
+			update_mip(MIP_WRITE_MASK, value & MIP_WRITE_MASK);
 			break;
 		case SIP_ADDR:
-			write(csrs.mip, SIP_MASK);
+			update_mip(SIP_MASK, value & SIP_MASK);
 			break;
 		case UIP_ADDR:
-			write(csrs.mip, UIP_MASK);
+			update_mip(UIP_MASK, value & UIP_MASK);
 			break;
 
 		case MIE_ADDR:
@@ -7118,6 +7263,8 @@ void ISS_CT::init(instr_memory_if *instr_mem, bool use_dbbcache, data_memory_if
 
 	uint64_t hartId = get_hart_id();
 	dbbcache.init(use_dbbcache, isa_config, hartId, instr_mem, opMap, fast_abort_and_fdd_labelPtr, entrypoint);
+	dbbcache.jit_init(OP_GLOBAL_JIT_LABEL_START);
+	dbbcache.fusion_init(fusionMap);
 	lscache.init(use_lscache, hartId, data_mem);
 	cycle_counter_raw_last = 0;
 	ninstr_last = 0;
@@ -7129,7 +7276,7 @@ void ISS_CT::sys_exit() {
 }
 
 unsigned ISS_CT::get_syscall_register_index() {
-	if (csrs.misa.has_E_base_isa())
+	if (has_isa_ext(csr_misa::E))
 		return RegFile::a5;
 	else
 		return RegFile::a7;
@@ -7160,20 +7307,22 @@ void ISS_CT::block_on_wfi(bool block) {
 
 void ISS_CT::set_status(CoreExecStatus s) {
 	status = s;
-	force_slow_path();
+	post_request(REQUEST_HALT);
 }
 
 void ISS_CT::enable_debug(void) {
 	debug_mode = true;
-	force_slow_path();
+	post_request(REQUEST_SLOW_PATH);
 }
 
 void ISS_CT::insert_breakpoint(uint64_t addr) {
 	breakpoints.insert(addr);
+	dbbcache.insert_breakpoint(addr);
 }
 
 void ISS_CT::remove_breakpoint(uint64_t addr) {
 	breakpoints.erase(addr);
+	dbbcache.remove_breakpoint(addr);
 }
 
 uint64_t ISS_CT::get_hart_id() {
@@ -7188,36 +7337,19 @@ std::vector<uint64_t> ISS_CT::get_registers(void) {
 	return regvals;
 }
 
-void ISS_CT::fp_finish_instr() {
-	fp_set_dirty();
-	fp_update_exception_flags();
-}
-
-void ISS_CT::fp_prepare_instr() {
-	assert(softfloat_exceptionFlags == 0);
-	fp_require_not_off();
-}
-
-void ISS_CT::fp_set_dirty() {
+void ISS_CT::fp_set_dirty_slow() {
 	csrs.mstatus.reg.fields.sd = 1;
 	csrs.mstatus.reg.fields.fs = FS_DIRTY;
 }
 
-void ISS_CT::fp_update_exception_flags() {
-	if (softfloat_exceptionFlags) {
-		fp_set_dirty();
-		csrs.fcsr.reg.fields.fflags |= softfloat_exceptionFlags;
-		softfloat_exceptionFlags = 0;
-	}
+void ISS_CT::fp_update_exception_flags_slow() {
+	fp_set_dirty();
+	csrs.fcsr.reg.fields.fflags |= softfloat_exceptionFlags;
+	softfloat_exceptionFlags = 0;
 }
 
-void ISS_CT::fp_setup_rm() {
-	auto rm = instr.frm();
-	if (rm == FRM_DYN)
-		rm = csrs.fcsr.reg.fields.frm;
-	if (rm > FRM_RMM)
-		RAISE_ILLEGAL_INSTRUCTION();
-	softfloat_roundingMode = rm;
+void ISS_CT::fp_invalid_rm() {
+	RAISE_ILLEGAL_INSTRUCTION();
 }
 
 void ISS_CT::fp_require_not_off() {
@@ -7232,7 +7364,7 @@ void ISS_CT::return_from_trap_handler(PrivilegeLevel return_mode) {
 			csrs.mstatus.reg.fields.mie = csrs.mstatus.reg.fields.mpie;
 			csrs.mstatus.reg.fields.mpie = 1;
 			pc = csrs.mepc.reg.val;
-			if (csrs.misa.has_user_mode_extension())
+			if (has_isa_ext(csr_misa::U))
 				csrs.mstatus.reg.fields.mpp = UserMode;
 			else
 				csrs.mstatus.reg.fields.mpp = MachineMode;
@@ -7243,7 +7375,7 @@ void ISS_CT::return_from_trap_handler(PrivilegeLevel return_mode) {
 			csrs.mstatus.reg.fields.sie = csrs.mstatus.reg.fields.spie;
 			csrs.mstatus.reg.fields.spie = 1;
 			pc = csrs.sepc.reg.val;
-			if (csrs.misa.has_user_mode_extension())
+			if (has_isa_ext(csr_misa::U))
 				csrs.mstatus.reg.fields.spp = UserMode;
 			else
 				csrs.mstatus.reg.fields.spp = SupervisorMode;
@@ -7274,36 +7406,42 @@ void ISS_CT::trigger_external_interrupt(PrivilegeLevel level) {
 	if (trace)
 		std::cout << "[vp::iss] trigger external interrupt, " << sc_core::sc_time_stamp() << std::endl;
 
+	csr_mip bits;
 	switch (level) {
 		case UserMode:
-			csrs.mip.reg.fields.ueip = true;
+			bits.reg.fields.ueip = true;
 			break;
 		case SupervisorMode:
-			csrs.mip.reg.fields.seip = true;
+			bits.reg.fields.seip = true;
 			break;
 		case MachineMode:
-			csrs.mip.reg.fields.meip = true;
+			bits.reg.fields.meip = true;
 			break;
 	}
 
-	maybe_interrupt_pending();
+	update_mip(0, bits.reg.val);
+
+	request_interrupt();
 }
 
 void ISS_CT::clear_external_interrupt(PrivilegeLevel level) {
 	if (trace)
 		std::cout << "[vp::iss] clear external interrupt, " << sc_core::sc_time_stamp() << std::endl;
 
+	csr_mip bits;
 	switch (level) {
 		case UserMode:
-			csrs.mip.reg.fields.ueip = false;
+			bits.reg.fields.ueip = true;
 			break;
 		case SupervisorMode:
-			csrs.mip.reg.fields.seip = false;
+			bits.reg.fields.seip = true;
 			break;
 		case MachineMode:
-			csrs.mip.reg.fields.meip = false;
+			bits.reg.fields.meip = true;
 			break;
 	}
+
+	update_mip(bits.reg.val, 0);
 }
 
 void ISS_CT::trigger_timer_interrupt() {
@@ -7311,14 +7449,18 @@ void ISS_CT::trigger_timer_interrupt() {
 
 	if (trace)
 		std::cout << "[vp::iss] trigger timer interrupt, " << sc_core::sc_time_stamp() << std::endl;
-	csrs.mip.reg.fields.mtip = true;
-	maybe_interrupt_pending();
+	csr_mip bits;
+	bits.reg.fields.mtip = true;
+	update_mip(0, bits.reg.val);
+	request_interrupt();
 }
 
 void ISS_CT::clear_timer_interrupt() {
 	if (trace)
 		std::cout << "[vp::iss] clear timer interrupt, " << sc_core::sc_time_stamp() << std::endl;
-	csrs.mip.reg.fields.mtip = false;
+	csr_mip bits;
+	bits.reg.fields.mtip = true;
+	update_mip(bits.reg.val, 0);
 }
 
 void ISS_CT::trigger_software_interrupt() {
@@ -7326,19 +7468,25 @@ void ISS_CT::trigger_software_interrupt() {
 
 	if (trace)
 		std::cout << "[vp::iss] trigger software interrupt, " << sc_core::sc_time_stamp() << std::endl;
-	csrs.mip.reg.fields.msip = true;
-	maybe_interrupt_pending();
+	csr_mip bits;
+	bits.reg.fields.msip = true;
+	update_mip(0, bits.reg.val);
+	request_interrupt();
 }
 
 void ISS_CT::clear_software_interrupt() {
 	if (trace)
 		std::cout << "[vp::iss] clear software interrupt, " << sc_core::sc_time_stamp() << std::endl;
-	csrs.mip.reg.fields.msip = false;
+	csr_mip bits;
+	bits.reg.fields.msip = true;
+	update_mip(bits.reg.val, 0);
 }
 
 void ISS_CT::halt() {
 	if (debug_mode) {
-		this->status = CoreExecStatus::HitBreakpoint;
+		set_status(CoreExecStatus::HitBreakpoint);
+		/* called by this hart (e.g. break on transaction) -> leave the fast path immediately */
+		force_slow_path();
 	}
 }
 
@@ -7528,6 +7676,23 @@ void ISS_CT::switch_to_trap_handler(PrivilegeLevel target_mode) {
 	dbbcache.enter_trap(pc);
 }
 
+void ISS_CT::handle_requests() {
+	uint32_t req = dbbcache.take_requests();
+
+	if (req & REQUEST_LSCACHE_FLUSH) {
+		lscache.flush();
+	}
+
+	if (req & REQUEST_DMI_INVALIDATE) {
+		handle_dmi_invalidate();
+	}
+
+	/*
+	 * REQUEST_INTERRUPT, REQUEST_HALT and REQUEST_SLOW_PATH need no further action: pending interrupts, status,
+	 * debug and trace flags are checked in the slow path anyway
+	 */
+}
+
 void ISS_CT::handle_interrupt() {
 	auto x = compute_pending_interrupts();
 	if (x.target_mode != NoneMode) {
@@ -10,6 +10,8 @@
 #include <iostream>
 #include <stdexcept>
 
+#include "core/common/code_page_tracker.h"
+
 namespace rv32 {
 
 // see: riscv-gnu-toolchain/riscv-newlib/libgloss/riscv/
@@ -174,6 +176,9 @@ int sys_read(SyscallHandler *sys, int fd, void *buf, size_t count) {
 
 	assert(ans >= 0);
 
+	/* direct write to guest memory -> report (see CodePageTracker) */
+	CodePageTracker::host_write(p, ans);
+
 	return ans;
 }
 
@@ -11,6 +11,7 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <systemc>
 #include <unordered_set>
@@ -21,6 +22,8 @@
 #include "core/common/dbbcache.h"
 #include "core/common/debug.h"
 #include "core/common/fp.h"
+#include "core/common/fp_host.h"
+#include "core/common/hart_thread_if.h"
 #include "core/common/instr.h"
 #include "core/common/irq_if.h"
 #include "core/common/iss_stats.h"
@@ -15,6 +15,13 @@
 #define PROP_METHOD_VIRTUAL virtual
 #endif
 
+/* see ISS_CT_CACHES_FORCED_ENABLED in iss_ctemplate_handle.h */
+#ifdef ISS_CT_CACHES_FORCED_ENABLED
+#define PROP_CACHES_FORCED_ENABLED true
+#else
+#define PROP_CACHES_FORCED_ENABLED false
+#endif
+
 /* see NOTE RVxx.1 and NOTE RVxx.2 in iss_ctemplate_handle.h */
 class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
                                 public clint_interrupt_target,
@@ -29,12 +36,19 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 	RV_ISA_Config *isa_config = nullptr;
 	uxlen_t pc = 0;
 	uint64_t cycle_counter_raw_last = 0;
+	/* end of the cycle budget of the current quantum (see commit_cycles and quantum_budget_exhausted) */
+	uint64_t cycle_counter_raw_quantum_end = 0;
 	uint64_t ninstr_last = 0;
 	int64_t lr_sc_counter = 0;
 	bool iss_slow_path = false;
 	bool trace = false;
 	bool shall_exit = false;
 	sc_core::sc_event wfi_event;
+	/* host thread of the hart, if it runs in parallel to other harts (see parallel_runner.h) */
+	hart_thread_if *hart_thread = nullptr;
+	/* dmi invalidations of other threads, executed by the hart (see request_dmi_invalidate) */
+	std::mutex dmi_invalidate_mutex;
+	std::vector<std::pair<uint64_t, uint64_t>> dmi_invalidate_pending;
 	CoreExecStatus status = CoreExecStatus::Runnable;
 	std::unordered_set<uxlen_t> breakpoints;
 	bool debug_mode = false;
@@ -45,6 +59,11 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 		void *labelPtr;
 	};
 
+	struct op_fusion_label_entry {
+		Fusion::Id id;
+		void *labelPtr;
+	};
+
 	void *genOpMap();
 
 	void exec_steps(const bool debug_single_step);
@@ -57,8 +76,8 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 #endif
 	clint_if *clint = nullptr;
 	instr_memory_if *instr_mem = nullptr;
-	LSCacheDefault_T<sxlen_t, uxlen_t> lscache;
-	DBBCacheDefault_T<ARCH, uxlen_t, instr_memory_if> dbbcache;
+	LSCacheDefault_T<sxlen_t, uxlen_t, PROP_CACHES_FORCED_ENABLED> lscache;
+	DBBCacheDefault_T<ARCH, uxlen_t, instr_memory_if, PROP_CACHES_FORCED_ENABLED> dbbcache;
 	data_memory_if *mem = nullptr;
 	syscall_emulator_if *sys = nullptr;  // optional, if provided, the iss will intercept and handle syscalls directly
 	RegFile regs;
@@ -76,6 +95,8 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 	tlm_utils::tlm_quantumkeeper quantum_keeper;
 	sc_core::sc_time cycle_counter;  // use a separate cycle counter, since cycle count can be inhibited
 	struct OpMapEntry opMap[Operation::OpId::NUMBER_OF_OPERATIONS];
+	/* labels of the fused instruction pairs (see Fusion, nullptr -> not implemented) */
+	void *fusionMap[Fusion::NUMBER_OF_FUSIONS];
 
 	static constexpr unsigned xlen = XLEN;
 
@@ -95,6 +116,92 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 		dbbcache.force_slow_path();
 	}
 
+	/* requests of other harts, devices and the debugger (see post_request) */
+	static constexpr uint32_t REQUEST_INTERRUPT = (1 << 0);
+	static constexpr uint32_t REQUEST_HALT = (1 << 1);
+	static constexpr uint32_t REQUEST_SLOW_PATH = (1 << 2);
+	static constexpr uint32_t REQUEST_LSCACHE_FLUSH = (1 << 3);
+	static constexpr uint32_t REQUEST_DMI_INVALIDATE = (1 << 4);
+
+	/*
+	 * request req from outside of this hart (see "Cross-hart requests" in dbbcache.h)
+	 * -> this hart leaves the fast path on the next block exit and handles it in the slow path (see handle_requests)
+	 * NOTE: force_slow_path must only be called by the hart itself
+	 */
+	void post_request(uint32_t req) {
+		dbbcache.post_request(req);
+	}
+
+	/* flush the LSCache (e.g. on new code pages, see CodePageTracker) -> may be called by other harts */
+	void request_lscache_flush() {
+		if (hart_thread == nullptr || hart_thread->is_current()) {
+			lscache.flush();
+		} else {
+			post_request(REQUEST_LSCACHE_FLUSH);
+		}
+	}
+
+	/*
+	 * remove all dmi ranges of the data memory overlapping [start, end] (e.g. TLM backward path, see mem.h)
+	 * -> may be called by other threads: dmi ranges, fetch cache and LSCache are only modified by the hart itself
+	 * (the hart may be inside a lookup), it executes the invalidation when it returns from SystemC (see systemc_call,
+	 * sync_quantum, wfi) or on its next block exit (see handle_requests), whichever is first
+	 * NOTE: a hart running in parallel may access the old ranges until then -> the memory must stay valid until the end of
+	 * the current quantum
+	 */
+	void request_dmi_invalidate(uint64_t start, uint64_t end) {
+		if (hart_thread == nullptr || hart_thread->is_current()) {
+			mem->dmi_invalidate(start, end);
+		} else {
+			{
+				std::lock_guard<std::mutex> lock(dmi_invalidate_mutex);
+				dmi_invalidate_pending.emplace_back(start, end);
+			}
+			post_request(REQUEST_DMI_INVALIDATE);
+		}
+	}
+
+	/* execute the invalidations posted by request_dmi_invalidate -> must be called by the hart itself */
+	void handle_dmi_invalidate() {
+		std::vector<std::pair<uint64_t, uint64_t>> pending;
+		{
+			std::lock_guard<std::mutex> lock(dmi_invalidate_mutex);
+			pending.swap(dmi_invalidate_pending);
+		}
+		for (auto &e : pending) {
+			mem->dmi_invalidate(e.first, e.second);
+		}
+	}
+
+	/* run the hart on its own host thread (see parallel_runner.h) -> must be set before the simulation starts */
+	void set_hart_thread(hart_thread_if *hart_thread) {
+		this->hart_thread = hart_thread;
+	}
+	__always_inline bool runs_parallel() const {
+		return hart_thread != nullptr;
+	}
+
+	/* execute fn in the SystemC context (e.g. transactions, see hart_thread_if) */
+	template <typename T_fn>
+	__always_inline void systemc_call(T_fn fn) {
+		if (unlikely(hart_thread != nullptr)) {
+			hart_thread->call(fn);
+			handle_dmi_invalidate();
+		} else {
+			fn();
+		}
+	}
+
+	/* end of the quantum -> synchronize with SystemC */
+	void sync_quantum() {
+		if (hart_thread != nullptr) {
+			hart_thread->sync();
+			handle_dmi_invalidate();
+		} else {
+			quantum_keeper.sync();
+		}
+	}
+
 	/*
 	 * commit incremental cycle counter to global counter and quantum_keeper
 	 * NOTE: must be called before any tlm transaction (done in mem.h)
@@ -113,6 +220,24 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 			cycle_counter += cycle_counter_raw_inc_sysc;
 		}
 		quantum_keeper.inc(cycle_counter_raw_inc_sysc);
+
+		/* new budget: cycles left until the next quantum boundary (exact, see quantum_keeper.need_sync) */
+		const sc_core::sc_time &global_quantum = quantum_keeper.get_global_quantum();
+		cycle_counter_raw_quantum_end = cycle_counter_raw;
+		if (global_quantum != sc_core::SC_ZERO_TIME) {
+			sc_core::sc_time remaining = global_quantum - (quantum_keeper.get_current_time() % global_quantum);
+			cycle_counter_raw_quantum_end += (uint64_t)(remaining / sc_core::sc_time(1, sc_core::SC_PS));
+		}
+	}
+
+	/*
+	 * check the cycles accounted on block switches against the budget of the current quantum
+	 * -> called on taken branches and jumps (block exits) instead of counting each instruction
+	 * NOTE: time added to the quantum_keeper outside of commit_cycles (e.g. DMI access delays) is considered only with
+	 * the next commit
+	 */
+	__always_inline bool quantum_budget_exhausted() {
+		return dbbcache.get_cycle_counter_raw_accounted() >= cycle_counter_raw_quantum_end;
 	}
 
 	__always_inline void commit_instructions(uint64_t ninstr) {
@@ -127,20 +252,17 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 		}
 	}
 
-	/* update instr and cycle counters by local fast counters, update quantum_keeper and reset fast quantum */
-	__always_inline void commit_all_and_reset_fast_quantum(uint64_t &ninstr) {
-		/* commit instructions -> update ninstr to csrs */
-		commit_instructions(ninstr);
-		/* commit cycles -> update csrs and quantum_keeper */
-		commit_cycles();
+	/* commit instructions retired before the current one (e.g. for csr reads: current instruction is not retired) */
+	__always_inline void commit_instructions_retired() {
+		commit_instructions(dbbcache.get_instr_counter() - 1);
+	}
 
-		/* reset the instruction counter used for fast quantum
-		 * after commit_instruction, we known that ninst == ninst_last
-		 * holds -> we can safely reset both (x - x = 0 - 0 = 0).
-		 */
-		// assert(ninstr == ninstr_last);
-		ninstr = 0;
-		ninstr_last = ninstr;
+	/* update instr and cycle counters by the DBBCache counters, update quantum_keeper and the quantum budget */
+	__always_inline void commit_all() {
+		/* commit instructions -> update csrs */
+		commit_instructions(dbbcache.get_instr_counter());
+		/* commit cycles -> update csrs, quantum_keeper and budget */
+		commit_cycles();
 	}
 
 	uint64_t _compute_and_get_current_cycles();
@@ -169,7 +291,7 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 
 	void enable_trace(bool ena) override {
 		trace = ena;
-		force_slow_path();
+		post_request(REQUEST_SLOW_PATH);
 	}
 	bool trace_enabled(void) override {
 		return trace;
@@ -191,6 +313,12 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 	bool dbbcache_enabled(void) override {
 		return dbbcache.is_enabled();
 	}
+	void enable_dbbcache_jit(bool ena) override {
+		dbbcache.jit_enable(ena);
+	}
+	bool dbbcache_jit_enabled(void) override {
+		return dbbcache.jit_is_enabled();
+	}
 
 	void enable_lscache(bool ena) override {
 		lscache.enable(ena);
@@ -202,6 +330,9 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 	void print_stats(void) override {
 		dbbcache.print_stats();
 		lscache.print_stats();
+		if (mem != nullptr) {
+			mem->print_stats();
+		}
 		stats.print();
 	}
 
@@ -212,11 +343,36 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 	void set_status(CoreExecStatus) override;
 	void block_on_wfi(bool) override;
 
+	/* pending interrupts may have changed by this hart (e.g. csr write) */
 	void maybe_interrupt_pending() {
 		force_slow_path();
+		/* a hart running in parallel must not enter SystemC (and is not waiting for interrupts anyway) */
+		if (hart_thread == nullptr) {
+			wfi_event.notify(sc_core::SC_ZERO_TIME);
+		}
+	}
+
+	/* pending interrupts may have changed by a device or another hart (CLINT, PLIC, ...) */
+	void request_interrupt() {
+		post_request(REQUEST_INTERRUPT);
 		wfi_event.notify(sc_core::SC_ZERO_TIME);
 	}
 
+	const sc_core::sc_event &get_wfi_event() const {
+		return wfi_event;
+	}
+
+	/*
+	 * clear and set bits of mip
+	 * NOTE: atomic, since devices may update mip of a hart running in parallel (see parallel_runner.h)
+	 */
+	void update_mip(uxlen_t clear, uxlen_t set) {
+		uxlen_t val = __atomic_load_n(&csrs.mip.reg.val, __ATOMIC_RELAXED);
+		while (!__atomic_compare_exchange_n(&csrs.mip.reg.val, &val, (val & ~clear) | set, true, __ATOMIC_RELEASE,
+		                                    __ATOMIC_RELAXED)) {
+		}
+	}
+
 	void insert_breakpoint(uint64_t) override;
 	void remove_breakpoint(uint64_t) override;
 
@@ -227,11 +383,49 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 		mem->atomic_unlock();
 	}
 
-	void fp_prepare_instr();
-	void fp_finish_instr();
-	void fp_set_dirty();
-	void fp_update_exception_flags();
-	void fp_setup_rm();
+	/*
+	 * FP state handling of F/D/Zfh instructions
+	 * FS-aware: The common case (mstatus.FS dirty, valid rounding mode, no new exception flags) is handled inline with
+	 * one predictable branch per step, the FP state is only checked or updated out of line (*_slow) otherwise.
+	 */
+	__always_inline void fp_prepare_instr() {
+		assert(softfloat_exceptionFlags == 0);
+		if (unlikely(csrs.mstatus.reg.fields.fs != FS_DIRTY)) {
+			fp_require_not_off();
+		}
+	}
+
+	__always_inline void fp_set_dirty() {
+		if (unlikely(csrs.mstatus.reg.fields.fs != FS_DIRTY || !csrs.mstatus.reg.fields.sd)) {
+			fp_set_dirty_slow();
+		}
+	}
+
+	__always_inline void fp_update_exception_flags() {
+		if (unlikely(softfloat_exceptionFlags)) {
+			fp_update_exception_flags_slow();
+		}
+	}
+
+	__always_inline void fp_finish_instr() {
+		fp_set_dirty();
+		fp_update_exception_flags();
+	}
+
+	__always_inline void fp_setup_rm() {
+		unsigned int rm = instr.frm();
+		if (rm == FRM_DYN) {
+			rm = csrs.fcsr.reg.fields.frm;
+		}
+		if (unlikely(rm > FRM_RMM)) {
+			fp_invalid_rm();
+		}
+		softfloat_roundingMode = rm;
+	}
+
+	void fp_set_dirty_slow();
+	void fp_update_exception_flags_slow();
+	void fp_invalid_rm();
 	void fp_require_not_off();
 
 	/* see NOTE RVxx.1 and NOTE RVxx.2 in iss_ctemplate_handle.h */
@@ -242,8 +436,20 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 	bool is_invalid_csr_access(uxlen_t csr_addr, bool is_write);
 	void validate_csr_counter_read_access_rights(uxlen_t addr);
 
+	/*
+	 * check, if ISA extension ext (see csr_misa) is available
+	 * compile-time constant, if the ISA config is fixed (see ISS_CT_FIXED_ISA_CFG in iss_ctemplate_handle.h)
+	 */
+	__always_inline bool has_isa_ext(uint64_t ext) {
+#ifdef ISS_CT_FIXED_ISA_CFG
+		return (ISS_CT_FIXED_ISA_CFG) & ext;
+#else
+		return csrs.misa.reg.fields.extensions & ext;
+#endif
+	}
+
 	uxlen_t pc_alignment_mask() {
-		if (csrs.misa.has_C_extension()) {
+		if (has_isa_ext(csr_misa::C)) {
 			return ~uxlen_t(0x1);
 		} else {
 			return ~uxlen_t(0x3);
@@ -319,6 +525,9 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 	/* see NOTE RVxx.1 and NOTE RVxx.2 in iss_ctemplate_handle.h */
 	PROP_METHOD_VIRTUAL void handle_interrupt();
 
+	/* take and handle pending requests (see post_request) -> called in the slow path */
+	void handle_requests();
+
 	/* see NOTE RVxx.1 and NOTE RVxx.2 in iss_ctemplate_handle.h */
 	PROP_METHOD_VIRTUAL void handle_trap(SimulationTrap &e, uxlen_t last_pc);
 
@@ -332,3 +541,4 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 /* see NOTE RVxx.1 and NOTE RVxx.2 in iss_ctemplate_handle.h */
 #undef PROP_CLASS_FINAL
 #undef PROP_METHOD_VIRTUAL
+#undef PROP_CACHES_FORCED_ENABLED
@@ -32,6 +32,23 @@
  *    related to DBBCache based optimization. If this is defined it enables tail dispatch (threaded code)
  *    instead of global dispatch for operations
  *    Longer compilation, increased size, but faster execution
+ *  * ISS_CT_FIXED_ISA_CFG ..
+ *    If defined, the ISA config (RV_ISA_Config::cfg) is fixed to this compile-time constant value. ISA checks in the
+ *    operations (see has_isa_ext) are constant -> dead paths are removed. The ISS throws on construction, if the
+ *    given (runtime) ISA config does not match.
+ *  * ISS_CT_CACHES_FORCED_ENABLED ..
+ *    If defined, DBBCache and LSCache are always enabled, independent of the runtime configuration (same as
+ *    DBBCACHE_FORCED_ENABLED and LSCACHE_FORCED_ENABLED, but only for this ISS)
+ *
+ *
+ * ISS_FIXED_CONFIG (build define, see add_rv64_fixed_library in CMakeLists.txt):
+ * If defined, the classic ISS "ISS" below is created with a fixed configuration: A fixed ISA config and forced
+ * caches. The ISA config is selected per library with additional build defines:
+ *  * none: default ISA config (RV_ISA_Config(), IMAFDCV + NSU)
+ *  * ISS_FIXED_CONFIG_E_BASE_ISA: E instead of I base ISA (RV_ISA_Config(true, ...), see --use-E-base-isa)
+ *  * ISS_FIXED_CONFIG_ZFH: Zfh enabled (RV_ISA_Config(..., true), see --en-ext-Zfh)
+ * Platforms linked with such a library can only be used with its ISA config (checked on construction). The
+ * runtime-configurable ISS (rv64) remains the default.
  */
 
 /*
@@ -51,6 +68,21 @@
 #undef ISS_CT_ENABLE_POLYMORPHISM
 #undef ISS_CT_STATS_ENABLED
 #define ISS_CT_OP_TAIL_FAST_FDD_ENABLED
+#ifdef ISS_FIXED_CONFIG
+#if defined(ISS_FIXED_CONFIG_E_BASE_ISA) && defined(ISS_FIXED_CONFIG_ZFH)
+#define ISS_CT_FIXED_ISA_CFG (RV_ISA_Config(true, true).cfg)
+#elif defined(ISS_FIXED_CONFIG_E_BASE_ISA)
+#define ISS_CT_FIXED_ISA_CFG (RV_ISA_Config(true, false).cfg)
+#elif defined(ISS_FIXED_CONFIG_ZFH)
+#define ISS_CT_FIXED_ISA_CFG (RV_ISA_Config(false, true).cfg)
+#else
+#define ISS_CT_FIXED_ISA_CFG (RV_ISA_Config().cfg)
+#endif
+#define ISS_CT_CACHES_FORCED_ENABLED
+#else
+#undef ISS_CT_FIXED_ISA_CFG
+#undef ISS_CT_CACHES_FORCED_ENABLED
+#endif
 
 #if defined(ISS_CT_CREATE_DEFINITION)
 #include "iss_ctemplate.h"
@@ -65,6 +97,8 @@
 #undef ISS_CT_ENABLE_POLYMORPHISM
 #undef ISS_CT_STATS_ENABLED
 #undef ISS_CT_OP_TAIL_FAST_FDD_ENABLED
+#undef ISS_CT_FIXED_ISA_CFG
+#undef ISS_CT_CACHES_FORCED_ENABLED
 
 /* cleanup */
 #undef ISS_CT_CREATE_DEFINITION
@@ -14,6 +14,7 @@
 #define KEY_STATS 's'            /* s (print statistics) */
 #define KEY_DATADMI 'D'          /* D (toggle data DMI) */
 #define KEY_DBBCACHE 'd'         /* d (toggle dbbcache) */
+#define KEY_DBBCACHE_JIT 'j'     /* j (toggle dbbcache translation) */
 #define KEY_LSCACHE 'l'          /* l (toggle lscache) */
 #define KEY_QUIT 'q'             /* q (character to quit (sc_stop) in command mode) */
 #define KEY_EXIT 'x'             /* x (character to exit (exit) in command mode) */
@@ -83,6 +84,27 @@ void Channel_Console::debug_targets_toggle_dbbcache(void) {
 	std::cout << "CONSOLE: dbbcache: " << (debug_targets_dbbcache_is_enabled() ? "enabled" : "disabled") << std::endl;
 }
 
+bool Channel_Console::debug_targets_dbbcache_jit_is_enabled(void) {
+	if (debug_targets.size() == 0) {
+		/* no debug targets -> false */
+		return false;
+	}
+
+	/* determine the state by looking at the first debug target */
+	return (*debug_targets.begin())->dbbcache_jit_enabled();
+}
+
+void Channel_Console::debug_targets_toggle_dbbcache_jit(void) {
+	bool state = debug_targets_dbbcache_jit_is_enabled();
+
+	/* switch all debug targets */
+	for (debug_target_if *debug_target : debug_targets) {
+		debug_target->enable_dbbcache_jit(!state);
+	}
+	std::cout << "CONSOLE: dbbcache jit: " << (debug_targets_dbbcache_jit_is_enabled() ? "enabled" : "disabled")
+	          << std::endl;
+}
+
 bool Channel_Console::debug_targets_lscache_is_enabled(void) {
 	if (debug_targets.size() == 0) {
 		/* no debug targets -> false */
@@ -111,6 +133,8 @@ void Channel_Console::debug_targets_print_stats(void) {
 	}
 	std::cout << "CONSOLE: datadmi:  " << (debug_targets_datadmi_is_enabled() ? "enabled" : "disabled") << std::endl;
 	std::cout << "CONSOLE: dbbcache: " << (debug_targets_dbbcache_is_enabled() ? "enabled" : "disabled") << std::endl;
+	std::cout << "CONSOLE: dbbcache jit: " << (debug_targets_dbbcache_jit_is_enabled() ? "enabled" : "disabled")
+	          << std::endl;
 	std::cout << "CONSOLE: lscache:  " << (debug_targets_lscache_is_enabled() ? "enabled" : "disabled") << std::endl;
 	std::cout << "++++++++++++++++++++" << std::endl;
 }
@@ -201,6 +225,7 @@ void Channel_Console::handle_cmd() {
 			          << "    ^a-t   toggle trace mode of debug targets\n"
 			          << "    ^a-D   toggle data DMI of debug targets\n"
 			          << "    ^a-d   toggle dbbcache of debug targets\n"
+			          << "    ^a-j   toggle dbbcache translation (jit) of debug targets\n"
 			          << "    ^a-l   toggle lscache of debug targets (requires support for data-DMI)\n"
 			          << "    ^a-q   quit - stop simulation with sc_stop\n"
 			          << "    ^a-x   exit - hard stop of simulation with exit" << std::endl;
@@ -217,6 +242,9 @@ void Channel_Console::handle_cmd() {
 		case KEY_DBBCACHE:
 			debug_targets_toggle_dbbcache();
 			break;
+		case KEY_DBBCACHE_JIT:
+			debug_targets_toggle_dbbcache_jit();
+			break;
 		case KEY_LSCACHE:
 			debug_targets_toggle_lscache();
 			break;
@@ -41,6 +41,8 @@ class Channel_Console final : public sc_core::sc_module, public Channel_FD_IF {
 	void debug_targets_toggle_datadmi(void);
 	bool debug_targets_dbbcache_is_enabled(void);
 	void debug_targets_toggle_dbbcache(void);
+	bool debug_targets_dbbcache_jit_is_enabled(void);
+	void debug_targets_toggle_dbbcache_jit(void);
 	bool debug_targets_lscache_is_enabled(void);
 	void debug_targets_toggle_lscache(void);
 	void debug_targets_print_stats(void);
@@ -6,6 +6,7 @@
 
 #include <systemc>
 
+#include "core/common/code_page_tracker.h"
 #include "core/common/load_if.h"
 #include "platform/common/bus.h"
 #include "util/propertytree.h"
@@ -58,6 +59,7 @@ struct SimpleMemory : public sc_core::sc_module, public load_if {
 		assert(addr + num_bytes <= size);
 
 		memcpy(data + addr, src, num_bytes);
+		CodePageTracker::host_write(data + addr, num_bytes);
 	}
 
 	void read_data(uint64_t addr, uint8_t *dst, unsigned num_bytes) {
@@ -23,6 +23,9 @@ Options::Options(void) {
 		("trace-mode", po::bool_switch(&trace_mode), "enable instruction tracing")
 		("tlm-global-quantum", po::value<unsigned int>(&tlm_global_quantum), "set global tlm quantum (in NS)")
 		("use-dbbcache", po::bool_switch(&use_dbbcache), "use the Dynamic Basic Block Cache (DBBCache) to speed up execution")
+		("use-dbbcache-jit", po::bool_switch(&use_dbbcache_jit), "translate hot blocks of the DBBCache to host code (requires --use-dbbcache, x86-64 hosts only)")
+		("share-dbbcache", po::bool_switch(&share_dbbcache), "share cached blocks of the DBBCache between harts with identical ISA config (multi-core platforms only)")
+		("dbbcache-warm-file", po::value<std::string>(&dbbcache_warm_file), "warm start: load blocks of the DBBCache from this file (if created with the same images) and save them at the end of the simulation")
 		("use-lscache", po::bool_switch(&use_lscache), "use the Load/Store Cache (LSCache) to speed up dmi access")
 		("use-instr-dmi", po::bool_switch(&use_instr_dmi), "use dmi to fetch instructions")
 		("use-data-dmi", po::bool_switch(&use_data_dmi), "use dmi to execute load/store operations")
@@ -30,6 +33,7 @@ Options::Options(void) {
 		("debug-bus-mode", po::bool_switch(&use_debug_bus), "dump tlm transaction data via TCP connection")
 		("debug-bus-port", po::value<unsigned int>(&debug_bus_port),"select port number for tlm transaction data")
 		("break-on-transaction", po::bool_switch(&break_on_transaction),"break on every transaction when in --debug-mode")
+		("parallel-harts", po::bool_switch(&parallel_harts), "run each hart on its own host thread, harts execute a quantum in parallel (multi-core platforms only, use with --use-data-dmi and a large --tlm-global-quantum)")
 
 		("property-tree", po::value<std::string>(&property_tree_file)->default_value(""),"ProppertyTree json file to load or save (see property-tree-export)")
 		("property-tree-export", po::bool_switch(&property_tree_export), "save a ProppertyTree (--property-tree) of the model properties and default values (elaboration phase) and exit")
@@ -65,6 +69,11 @@ void Options::parse(int argc, char **argv) {
 			          << std::endl;
 			exit(1);
 		}
+		if (vm["parallel-harts"].as<bool>() && (vm["debug-mode"].as<bool>() || vm["share-dbbcache"].as<bool>())) {
+			std::cerr << "[Options] Error: switch 'parallel-harts' can not be used with 'debug-mode' or 'share-dbbcache'."
+			          << std::endl;
+			exit(1);
+		}
 		if (vm["intercept-syscalls"].as<bool>() && vm.count("error-on-zero-traphandler") == 0) {
 			// intercept syscalls active, but no overriding error-on-zero-traphandler switch
 			std::cerr
@@ -22,12 +22,16 @@ class Options : public boost::program_options::options_description {
 	bool trace_mode = false;
 	unsigned int tlm_global_quantum = 10;
 	bool use_dbbcache = false;
+	bool use_dbbcache_jit = false;
+	bool share_dbbcache = false;
+	std::string dbbcache_warm_file;
 	bool use_lscache = false;
 	bool use_instr_dmi = false;
 	bool use_data_dmi = false;
 	bool use_debug_bus = false;
 	unsigned int debug_bus_port = 5006;
 	bool break_on_transaction = false;
+	bool parallel_harts = false;
 
 	std::string property_tree_file;
 	bool property_tree_export = false;
@@ -181,6 +181,7 @@ int sc_main(int argc, char **argv) {
 
 	core.init(instr_mem_if, opt.use_dbbcache, data_mem_if, opt.use_lscache, &timer, loader.get_entrypoint(),
 	          opt.sram_end_addr);
+	core.enable_dbbcache_jit(opt.use_dbbcache_jit);
 
 	// connect TLM sockets
 	iss_mem_if.isock.bind(ahb.tsocks[0]);
@@ -10,7 +10,7 @@ void NUCLEI_ISS::trigger_eclic_interrupt() {
 	if (trace_enabled()) {
 		std::cout << "[vp::iss] trigger eclic interrupt, " << sc_core::sc_time_stamp() << std::endl;
 	}
-	maybe_interrupt_pending();
+	request_interrupt();
 }
 
 uxlen_t NUCLEI_ISS::get_csr_value(uxlen_t addr) {
@@ -256,6 +256,7 @@ int sc_main(int argc, char **argv) {
 	loader.load_executable_image(dram, dram.get_size(), opt.dram_start_addr, false);
 	core.init(instr_mem_if, opt.use_dbbcache, data_mem_if, opt.use_lscache, &clint, loader.get_entrypoint(),
 	          opt.dram_end_addr);
+	core.enable_dbbcache_jit(opt.use_dbbcache_jit);
 	sys.init(dram.data, opt.dram_start_addr, loader.get_heap_addr(dram.get_size(), opt.dram_start_addr, false));
 	sys.register_core(&core);
 
@@ -178,6 +178,7 @@ int sc_main(int argc, char** argv) {
 	 * https://github.com/riscv-non-isa/riscv-elf-psabi-doc/blob/master/riscv-elf.adoc
 	 */
 	core.init(instr_mem_if, opt.use_dbbcache, data_mem_if, opt.use_lscache, one_clint, entry_point, opt.mem_end_addr);
+	core.enable_dbbcache_jit(opt.use_dbbcache_jit);
 	sys.init(mem.data, opt.mem_start_addr, loader.get_heap_addr(mem.get_size(), opt.mem_start_addr));
 	sys.register_core(&core);
 
@@ -19,11 +19,13 @@
 #include <iostream>
 
 #include "core/common/clint.h"
+#include "core/common/dbbcache_warm.h"
 #include "core/common/debug.h"
 #include "core/common/debug_memory.h"
 #include "core/common/gdb-mc/gdb_runner.h"
 #include "core/common/gdb-mc/gdb_server.h"
 #include "core/common/lwrt_clint.h"
+#include "core/common/parallel_runner.h"
 
 /*
  * It should be possible to remove the ifdefs here and include all files
@@ -372,6 +374,7 @@ int sc_main(int argc, char **argv) {
 	for (size_t i = 0; i < NUM_CORES; i++) {
 		cores[i]->init(opt.use_data_dmi, opt.use_instr_dmi, opt.use_dbbcache, opt.use_lscache, &clint, entry_point,
 		               opt.mem_end_addr, opt.cheri_purecap);
+		cores[i]->iss.enable_dbbcache_jit(opt.use_dbbcache_jit);
 
 		sys.register_core(&cores[i]->iss);
 		if (opt.intercept_syscalls)
@@ -379,6 +382,27 @@ int sc_main(int argc, char **argv) {
 		cores[i]->iss.error_on_zero_traphandler = opt.error_on_zero_traphandler;
 	}
 
+#ifndef TARGET_RV64_CHERIV9
+	if (opt.share_dbbcache) {
+		for (size_t i = 1; i < NUM_CORES; i++) {
+			if (!cores[i]->iss.dbbcache.share(cores[0]->iss.dbbcache)) {
+				std::cerr << "Warning: DBBCache of core " << i << " can not be shared (different ISA config)"
+				          << std::endl;
+			}
+		}
+	}
+
+	std::unique_ptr<DBBCacheWarmStore> dbbcache_warm_store;
+	if (!opt.dbbcache_warm_file.empty()) {
+		uint64_t image_hash = DBBCacheWarmStore::hash_files({opt.input_program, opt.kernel_file, opt.dtb_file});
+		dbbcache_warm_store =
+		    std::make_unique<DBBCacheWarmStore>(opt.dbbcache_warm_file, image_hash, sizeof(uxlen_t) * 8);
+		for (size_t i = 0; i < NUM_CORES; i++) {
+			cores[i]->iss.dbbcache.set_warm_store(dbbcache_warm_store.get());
+		}
+	}
+#endif
+
 	// setup port mapping
 	bus.ports[0] = new PortMapping(opt.mem_start_addr, opt.mem_end_addr, mem);
 	bus.ports[1] = new PortMapping(opt.clint_start_addr, opt.clint_end_addr, clint);
@@ -483,6 +507,14 @@ int sc_main(int argc, char **argv) {
 		auto server = new GDBServer("GDBServer", dharts, &dbg_if, opt.debug_port, opt.debug_cont_sim_on_wait, mmus);
 		for (size_t i = 0; i < dharts.size(); i++)
 			new GDBServerRunner(("GDBRunner" + std::to_string(i)).c_str(), server, dharts[i]);
+#ifndef TARGET_RV64_CHERIV9
+	} else if (opt.parallel_harts) {
+		std::vector<ISS *> harts;
+		for (size_t i = 0; i < NUM_CORES; i++) {
+			harts.push_back(&cores[i]->iss);
+		}
+		new ParallelCoreRunner<ISS>("ParallelCoreRunner", harts);
+#endif
 	} else {
 		for (size_t i = 0; i < NUM_CORES; i++) {
 			new DirectCoreRunner(cores[i]->iss);
@@ -493,6 +525,16 @@ int sc_main(int argc, char **argv) {
 	opt.handle_property_export_and_exit();
 
 	sc_core::sc_start();
+
+#ifndef TARGET_RV64_CHERIV9
+	if (dbbcache_warm_store) {
+		for (size_t i = 0; i < NUM_CORES; i++) {
+			cores[i]->iss.dbbcache.warm_store_collect(*dbbcache_warm_store);
+		}
+		dbbcache_warm_store->save();
+	}
+#endif
+
 	for (size_t i = 0; i < NUM_CORES; i++) {
 		cores[i]->iss.show();
 	}
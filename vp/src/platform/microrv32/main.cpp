@@ -121,6 +121,7 @@ int sc_main(int argc, char **argv) {
 
 	loader.load_executable_image(mem, mem.get_size(), opt.mem_start_addr);
 	core.init(instr_mem_if, opt.use_dbbcache, data_mem_if, opt.use_lscache, &clint, entry_point, opt.mem_end_addr);
+	core.enable_dbbcache_jit(opt.use_dbbcache_jit);
 	sys.init(mem.data, opt.mem_start_addr, loader.get_heap_addr(mem.get_size(), opt.mem_start_addr));
 	sys.register_core(&core);
 
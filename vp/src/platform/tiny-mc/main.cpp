@@ -13,6 +13,7 @@
 #include "core/common/clint.h"
 #include "core/common/gdb-mc/gdb_runner.h"
 #include "core/common/gdb-mc/gdb_server.h"
+#include "core/common/parallel_runner.h"
 
 /*
  * It should be possible to remove the ifdefs here and include all files
@@ -133,6 +134,8 @@ int sc_main(int argc, char **argv) {
 	           opt.mem_end_addr);
 	core1.init(&core1_mem_if, opt.use_dbbcache, &core1_mem_if, opt.use_lscache, &clint, loader.get_entrypoint(),
 	           opt.mem_end_addr - (32 * 1024));  // start stack 32KiB below stack for core0
+	core0.enable_dbbcache_jit(opt.use_dbbcache_jit);
+	core1.enable_dbbcache_jit(opt.use_dbbcache_jit);
 
 	sys.init(mem.data, opt.mem_start_addr, loader.get_heap_addr(mem.get_size(), opt.mem_start_addr));
 	sys.register_core(&core0);
@@ -175,6 +178,8 @@ int sc_main(int argc, char **argv) {
 		auto server = new GDBServer("GDBServer", threads, &dbg_if, opt.debug_port, opt.debug_cont_sim_on_wait);
 		new GDBServerRunner("GDBRunner0", server, &core0);
 		new GDBServerRunner("GDBRunner1", server, &core1);
+	} else if (opt.parallel_harts) {
+		new ParallelCoreRunner<ISS>("ParallelCoreRunner", {&core0, &core1});
 	} else {
 		new DirectCoreRunner(core0);
 		new DirectCoreRunner(core1);
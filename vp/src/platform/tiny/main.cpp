@@ -173,6 +173,7 @@ int sc_main(int argc, char **argv) {
 	core.init(instr_mem_if, opt.use_dbbcache, data_mem_if, opt.use_lscache, &clint, loader.get_entrypoint(),
 	          opt.mem_end_addr);
 #endif
+	core.enable_dbbcache_jit(opt.use_dbbcache_jit);
 
 	sys.init(mem.data, opt.mem_start_addr, loader.get_heap_addr(mem.get_size(), opt.mem_start_addr));
 	sys.register_core(&core);
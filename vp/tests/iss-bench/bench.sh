@@ -0,0 +1,54 @@
+#!/bin/sh
+# Compare the runtime of the generic ISS and the ISS with fixed configuration (see ISS_FIXED_CONFIG)
+#
+# Usage: bench.sh <vp bin dir>
+# Environment:
+#  * ISS_BENCH_ELF32/ISS_BENCH_ELF64 .. RV32/RV64 program to run (benchmark is skipped, if not set)
+#  * ISS_BENCH_ROUNDS .. number of runs per VP (default: 3, best run is used)
+#  * ISS_BENCH_OPTS .. additional VP options (default: intercept syscalls, DBBCache, LSCache and dmi)
+set -e
+
+if [ $# -ne 1 ] || [ ! -d "${1}" ]; then
+	printf "usage: %s <vp bin dir>\n" "${0}" 1>&2
+	exit 1
+fi
+bindir="${1}"
+rounds="${ISS_BENCH_ROUNDS:-3}"
+opts="${ISS_BENCH_OPTS:---intercept-syscalls --use-dbbcache --use-lscache --use-dmi}"
+
+export SYSTEMC_DISABLE_COPYRIGHT_MESSAGE=1
+
+# best runtime of ${rounds} runs in ms
+run() {
+	best=""
+	i=0
+	while [ ${i} -lt "${rounds}" ]; do
+		start=$(date +%s%N)
+		# shellcheck disable=SC2086
+		"${bindir}/${1}" ${opts} "${2}" >/dev/null 2>&1
+		end=$(date +%s%N)
+		t=$(((end - start) / 1000000))
+		if [ -z "${best}" ] || [ ${t} -lt "${best}" ]; then
+			best=${t}
+		fi
+		i=$((i + 1))
+	done
+	echo "${best}"
+}
+
+bench() {
+	[ $# -eq 2 ] || return 1
+
+	if [ -z "${2}" ]; then
+		printf "%s: no program given -> skipped\n" "${1}"
+		return 0
+	fi
+
+	generic=$(run "${1}-vp" "${2}")
+	fixed=$(run "${1}-fixed-vp" "${2}")
+	printf "%s: generic: %d ms, fixed: %d ms, gain: %d%%\n" "${1}" "${generic}" "${fixed}" \
+		$(((generic - fixed) * 100 / (generic > 0 ? generic : 1)))
+}
+
+bench tiny32 "${ISS_BENCH_ELF32}"
+bench tiny64 "${ISS_BENCH_ELF64}"
@@ -0,0 +1,33 @@
+#!/bin/sh
+# Compare the simulation performance (MIPS) of the DBBCache interpreter with and without translation of hot blocks
+# (--use-dbbcache vs. --use-dbbcache --use-dbbcache-jit)
+#
+# Usage: bench.sh <vp bin dir>
+# Runs the sw examples with both configurations of the same VP build (see ../pgo/bench.sh for details and environment)
+# JIT_BENCH_OPTS .. additional VP options for both configurations (default: LSCache and dmi)
+set -e
+
+if [ $# -ne 1 ] || [ ! -d "${1}" ]; then
+	printf "usage: %s <vp bin dir>\n" "${0}" 1>&2
+	exit 1
+fi
+bindir="$(cd "${1}" && pwd)"
+opts="${JIT_BENCH_OPTS:---use-lscache --use-dmi}"
+
+tmpdir="$(mktemp -d)"
+trap "rm -rf '${tmpdir}' 2>/dev/null" INT EXIT
+
+# wrap all VPs of the bin dir in dir ${1} -> VPs are called with the additional options ${2}
+wrap() {
+	mkdir "${1}"
+	for vp in "${bindir}"/*-vp; do
+		[ -x "${vp}" ] || continue
+		printf '#!/bin/sh\nexec "%s" %s "$@"\n' "${vp}" "${2}" >"${1}/$(basename "${vp}")"
+		chmod +x "${1}/$(basename "${vp}")"
+	done
+}
+
+wrap "${tmpdir}/interp" "--use-dbbcache ${opts}"
+wrap "${tmpdir}/jit" "--use-dbbcache --use-dbbcache-jit ${opts}"
+
+"$(dirname "${0}")/../pgo/bench.sh" "${tmpdir}/interp" "${tmpdir}/jit"
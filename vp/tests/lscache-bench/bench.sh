@@ -0,0 +1,48 @@
+#!/bin/sh
+# Compare the simulation performance (MIPS) of LSCache geometries (see lscache.h)
+#
+# Usage: bench.sh <vp bin dir>
+# Runs the sw examples (and optionally a Linux boot, see PGO_LINUX_ARGS in ../pgo/bench.sh) with the baseline geometry
+# and each of the other geometries of the same VP build (see ../pgo/bench.sh for details and environment). The
+# geometry is set with a PropertyTree (--property-tree). Build with LSCACHE_STATS_ENABLED to get hit, conflict and
+# capacity statistics.
+# LSCACHE_BENCH_BASELINE .. baseline geometry <sets>x<ways>+<victims> (default: 256x1+0 = direct-mapped)
+# LSCACHE_BENCH_GEOMETRIES .. geometries to compare with the baseline (default: see below)
+# LSCACHE_BENCH_OPTS .. additional VP options for all geometries (default: LSCache and dmi)
+set -e
+
+if [ $# -ne 1 ] || [ ! -d "${1}" ]; then
+	printf "usage: %s <vp bin dir>\n" "${0}" 1>&2
+	exit 1
+fi
+bindir="$(cd "${1}" && pwd)"
+baseline="${LSCACHE_BENCH_BASELINE:-256x1+0}"
+geometries="${LSCACHE_BENCH_GEOMETRIES:-256x2+0 256x2+8 256x4+8 512x2+8 1024x2+16 1024x4+16}"
+opts="${LSCACHE_BENCH_OPTS:---use-lscache --use-dmi}"
+
+tmpdir="$(mktemp -d)"
+trap "rm -rf '${tmpdir}' 2>/dev/null" INT EXIT
+
+# wrap all VPs of the bin dir in dir ${1} -> VPs are called with the LSCache geometry ${2} (<sets>x<ways>+<victims>)
+wrap() {
+	sets="${2%%x*}"
+	ways="${2#*x}"
+	ways="${ways%%+*}"
+	victims="${2##*+}"
+	mkdir "${1}"
+	printf '{\n\t"vppp.ISS.lscache_sets": "%s",\n\t"vppp.ISS.lscache_ways": "%s",\n\t"vppp.ISS.lscache_victims": "%s"\n}\n' \
+		"${sets}" "${ways}" "${victims}" >"${1}/lscache.json"
+	for vp in "${bindir}"/*-vp; do
+		[ -x "${vp}" ] || continue
+		printf '#!/bin/sh\nexec "%s" %s --property-tree "%s" "$@"\n' "${vp}" "${opts}" "${1}/lscache.json" \
+			>"${1}/$(basename "${vp}")"
+		chmod +x "${1}/$(basename "${vp}")"
+	done
+}
+
+wrap "${tmpdir}/${baseline}" "${baseline}"
+for geometry in ${geometries}; do
+	wrap "${tmpdir}/${geometry}" "${geometry}"
+	printf "\n%s vs. %s\n" "${baseline}" "${geometry}"
+	"$(dirname "${0}")/../pgo/bench.sh" "${tmpdir}/${baseline}" "${tmpdir}/${geometry}"
+done
@@ -0,0 +1,40 @@
+#!/bin/sh
+# Compare the simulation performance (MIPS) of the multi-core VPs with and without parallel hart execution
+# (one DirectCoreRunner per hart vs. --parallel-harts)
+#
+# Usage: bench.sh <vp bin dir>
+# Runs the sw examples and the Linux boot (needs PGO_LINUX_ARGS, see ../pgo/train.sh; the multi-core Linux boot is the
+# relevant measurement, single-core VPs ignore --parallel-harts) with both configurations of the same VP build (see
+# ../pgo/bench.sh for details and environment). The reported MIPS are the sum of all harts.
+# PARALLEL_BENCH_OPTS .. additional VP options for both configurations
+#                        (default: data dmi and a quantum of 100us, see --parallel-harts)
+set -e
+
+if [ $# -ne 1 ] || [ ! -d "${1}" ]; then
+	printf "usage: %s <vp bin dir>\n" "${0}" 1>&2
+	exit 1
+fi
+bindir="$(cd "${1}" && pwd)"
+opts="${PARALLEL_BENCH_OPTS:---use-data-dmi --tlm-global-quantum=100000}"
+
+if [ -z "${PGO_LINUX_ARGS}" ]; then
+	printf "WARNING: PGO_LINUX_ARGS not set -> no multi-core Linux boot, only the sw examples are compared\n" 1>&2
+fi
+
+tmpdir="$(mktemp -d)"
+trap "rm -rf '${tmpdir}' 2>/dev/null" INT EXIT
+
+# wrap all VPs of the bin dir in dir ${1} -> VPs are called with the additional options ${2}
+wrap() {
+	mkdir "${1}"
+	for vp in "${bindir}"/*-vp; do
+		[ -x "${vp}" ] || continue
+		printf '#!/bin/sh\nexec "%s" %s "$@"\n' "${vp}" "${2}" >"${1}/$(basename "${vp}")"
+		chmod +x "${1}/$(basename "${vp}")"
+	done
+}
+
+wrap "${tmpdir}/serial" "${opts}"
+wrap "${tmpdir}/parallel" "--parallel-harts ${opts}"
+
+"$(dirname "${0}")/../pgo/bench.sh" "${tmpdir}/serial" "${tmpdir}/parallel"
@@ -0,0 +1,75 @@
+#!/bin/sh
+# Compare the simulation performance (MIPS) of two VP builds, e.g. a regular release build and a PGO build
+#
+# Usage: bench.sh <baseline vp bin dir> <vp bin dir>
+# Runs all sw examples (same as the sw test, needs the RISC-V GNU toolchain) and optionally a Linux boot with
+# linux64-sc-vp (see PGO_LINUX_ARGS in train.sh) with both builds and reports the MIPS (executed instructions, as
+# reported by the VPs, per wall-clock time) and its delta per platform.
+# ISS_BENCH_ROUNDS .. number of runs per VP and program (default: 3, best run is used)
+set -e
+
+if [ $# -ne 2 ] || [ ! -d "${1}" ] || [ ! -d "${2}" ]; then
+	printf "usage: %s <baseline vp bin dir> <vp bin dir>\n" "${0}" 1>&2
+	exit 1
+fi
+basedir="$(cd "${1}" && pwd)"
+newdir="$(cd "${2}" && pwd)"
+swdir="$(cd "$(dirname "${0}")/../../../sw" && pwd)"
+rounds="${ISS_BENCH_ROUNDS:-3}"
+
+export SYSTEMC_DISABLE_COPYRIGHT_MESSAGE=1
+
+results="${TMPDIR:-/tmp}/pgo-bench"
+trap "rm -f '${results}' 2>/dev/null" INT EXIT
+: >"${results}"
+
+# run command with VPs from bin dir ${1} ${rounds} times -> "<instructions> <best runtime in ms>"
+run() {
+	bindir="${1}"
+	shift
+	best=""
+	instr=0
+	i=0
+	while [ ${i} -lt "${rounds}" ]; do
+		start=$(date +%s%N)
+		out="$(PATH="${bindir}:${PATH}" "$@" </dev/null 2>&1)"
+		end=$(date +%s%N)
+		t=$(((end - start) / 1000000))
+		if [ -z "${best}" ] || [ ${t} -lt "${best}" ]; then
+			best=${t}
+		fi
+		i=$((i + 1))
+	done
+	# sum of num-instr of all cores
+	instr=$(printf "%s\n" "${out}" | sed -n 's/^num-instr = \([0-9]*\)$/\1/p' | awk '{ s += $1 } END { print s + 0 }')
+	echo "${instr} ${best}"
+}
+
+for test in "${swdir}"/*; do
+	[ -d "${test}" ] && [ ! -e "${test}/test-ignore" ] || continue
+
+	make -C "${test}" >/dev/null
+	vp=$(printf 'print-vp:\n\t@echo $(VP)\n' | make -s -C "${test}" -f Makefile -f - print-vp)
+	printf "%s %s %s\n" "${vp}" "$(run "${basedir}" make -C "${test}" sim)" \
+		"$(run "${newdir}" make -C "${test}" sim)" >>"${results}"
+done
+
+if [ -n "${PGO_LINUX_ARGS}" ]; then
+	# shellcheck disable=SC2086
+	printf "%s %s %s\n" linux64-sc-vp "$(run "${basedir}" linux64-sc-vp ${PGO_LINUX_ARGS})" \
+		"$(run "${newdir}" linux64-sc-vp ${PGO_LINUX_ARGS})" >>"${results}"
+fi
+
+# per platform: <vp> <base instr> <base ms> <new instr> <new ms>
+awk '
+{
+	bi[$1] += $2; bt[$1] += $3; ni[$1] += $4; nt[$1] += $5
+}
+END {
+	for (vp in bi) {
+		bm = bt[vp] > 0 ? bi[vp] / bt[vp] / 1000 : 0
+		nm = nt[vp] > 0 ? ni[vp] / nt[vp] / 1000 : 0
+		delta = bm > 0 ? (nm - bm) * 100 / bm : 0
+		printf "%s: baseline: %.2f MIPS, new: %.2f MIPS, delta: %+.1f%%\n", vp, bm, nm, delta
+	}
+}' "${results}" | sort
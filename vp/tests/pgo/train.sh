@@ -0,0 +1,39 @@
+#!/bin/sh
+# PGO training run (see PGO in vp/CMakeLists.txt and vps-pgo in the top-level Makefile)
+#
+# Usage: train.sh <vp bin dir of the instrumented (PGO=GENERATE) build>
+# Runs
+#  1. all sw examples (same as the sw test, needs the RISC-V GNU toolchain), and
+#  2. optionally, a Linux boot with linux64-sc-vp, if PGO_LINUX_ARGS is set (options and firmware, e.g.
+#     "--dtb-file=fu540.dtb --kernel-file=Image --mram-root-image=rootfs.img fw_jump.elf").
+#     The Linux image has to shut down by itself (the profile is only written on a regular exit of the VP).
+#     PGO_LINUX_TIMEOUT limits the runtime in seconds (default: 1800)
+set -e
+
+if [ $# -ne 1 ] || [ ! -d "${1}" ]; then
+	printf "usage: %s <vp bin dir>\n" "${0}" 1>&2
+	exit 1
+fi
+bindir="$(cd "${1}" && pwd)"
+swdir="$(cd "$(dirname "${0}")/../../../sw" && pwd)"
+
+export SYSTEMC_DISABLE_COPYRIGHT_MESSAGE=1
+export PATH="${bindir}:${PATH}"
+
+printf "PGO training: sw examples\n"
+(cd "${swdir}" && ./test.sh)
+
+if [ -n "${PGO_LINUX_ARGS}" ]; then
+	printf "PGO training: Linux boot\n"
+	# shellcheck disable=SC2086
+	# timeout exits with 124 if the limit is hit -> keep the profile of the sw examples (no abort by set -e)
+	rc=0
+	timeout "${PGO_LINUX_TIMEOUT:-1800}" linux64-sc-vp ${PGO_LINUX_ARGS} </dev/null || rc=$?
+	if [ ${rc} -eq 124 ]; then
+		printf "PGO training: Linux boot timed out after %s seconds (no profile of the boot)\n" "${PGO_LINUX_TIMEOUT:-1800}"
+	elif [ ${rc} -ne 0 ]; then
+		exit ${rc}
+	fi
+else
+	printf "PGO training: Linux boot skipped (PGO_LINUX_ARGS not set)\n"
+fi
@@ -0,0 +1,170 @@
+/*
+ * Test: DMI table (dmi_table.h) vs. a linear search over the added ranges
+ *
+ * An iteration is one random add, invalidate or find (default: 100000, see random_test.h).
+ * Covers the fixed cases (boundaries, overlap rejection, invalidate, swap) and random sequences of add, invalidate
+ * and find (single addresses and ranges, incl. repeated lookups of the last hit) on a few random ranges.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "core/common/dmi_table.h"
+#include "random_test.h"
+
+static bool ok = true;
+
+#define CHECK(cond)                                                                        \
+	do {                                                                                   \
+		if (!(cond)) {                                                                     \
+			std::cerr << "FAILED: " << #cond << " (line " << __LINE__ << ")" << std::endl; \
+			ok = false;                                                                    \
+		}                                                                                  \
+	} while (0)
+
+static uint8_t mem_a[0x10000];
+static uint8_t mem_b[0x1000];
+static uint8_t mem_c[0x2000];
+
+static void test_fixed() {
+	DMITable t;
+	t.add(MemoryDMI::create_start_size_mapping(mem_a, 0x80000000, sizeof(mem_a)));
+	t.add(MemoryDMI::create_start_size_mapping(mem_b, 0x1000, sizeof(mem_b)));
+	t.add(MemoryDMI::create_start_size_mapping(mem_c, 0x20000000, sizeof(mem_c)));
+
+	bool thrown = false;
+	try {
+		t.add(MemoryDMI::create_start_size_mapping(mem_b, 0x1800, 0x100));
+	} catch (std::runtime_error &) {
+		thrown = true;
+	}
+	CHECK(thrown);
+
+	/* boundaries */
+	CHECK(t.find(0) == nullptr);
+	CHECK(t.find(0xfff) == nullptr);
+	CHECK(t.find(0x1000) != nullptr && t.find(0x1000)->get_raw_mem_ptr() == mem_b);
+	CHECK(t.find(0x1fff) != nullptr && t.find(0x1fff)->get_raw_mem_ptr() == mem_b);
+	CHECK(t.find(0x2000) == nullptr);
+	CHECK(t.find(0x8000ffff) != nullptr && t.find(0x8000ffff)->get_raw_mem_ptr() == mem_a);
+	CHECK(t.find(0x80010000) == nullptr);
+	CHECK(t.find(0x20001fff) != nullptr && t.find(0x20001fff)->get_raw_mem_ptr() == mem_c);
+	CHECK(t.find(UINT64_MAX) == nullptr);
+
+	/* ranges */
+	CHECK(t.find(0x20001000, 0x1000) != nullptr);
+	CHECK(t.find(0x20001001, 0x1000) == nullptr);
+	CHECK(t.find(0x1ffc, 4) != nullptr);
+	CHECK(t.find(0x1ffd, 4) == nullptr);
+
+	/* invalidate (inclusive end) */
+	CHECK(!t.invalidate(0x3000, 0x4000));
+	CHECK(!t.invalidate(0x2000, 0x2000));
+	CHECK(t.find(0x80000000) != nullptr); /* -> last hit */
+	CHECK(t.invalidate(0x80000100, 0x80000100));
+	CHECK(t.find(0x80000000) == nullptr);
+	CHECK(t.find(0x1000) != nullptr);
+	CHECK(t.invalidate(0, 0x1000));
+	CHECK(t.find(0x1000) == nullptr);
+	CHECK(t.find(0x20000000) != nullptr);
+
+	/* swap */
+	DMITable d;
+	t.swap(d);
+	CHECK(t.empty());
+	CHECK(t.find(0x20000000) == nullptr);
+	CHECK(d.find(0x20000000) != nullptr);
+	CHECK(d.invalidate(0, UINT64_MAX));
+	CHECK(d.empty());
+}
+
+struct Range {
+	uint64_t start;
+	uint64_t end;
+};
+
+static const Range *ref_find(const std::vector<Range> &ref, uint64_t addr, uint64_t len) {
+	for (auto &r : ref) {
+		if (addr >= r.start && addr < r.end) {
+			return addr + len <= r.end ? &r : nullptr;
+		}
+	}
+	return nullptr;
+}
+
+static void test_random(uint64_t iterations, uint64_t seed) {
+	/* addresses in a small window -> many overlaps, hits and misses */
+	static constexpr uint64_t WINDOW = 0x10000;
+	static uint8_t host[WINDOW];
+	std::mt19937_64 rng(seed);
+	auto rnd = [&rng](uint64_t n) { return std::uniform_int_distribution<uint64_t>(0, n - 1)(rng); };
+
+	DMITable t;
+	std::vector<Range> ref;
+	for (uint64_t it = 0; it < iterations && ok; it++) {
+		switch (rnd(8)) {
+			case 0: {
+				uint64_t start = rnd(WINDOW);
+				uint64_t size = 1 + rnd(std::min<uint64_t>(0x1000, WINDOW - start));
+				bool overlaps = false;
+				for (auto &r : ref) {
+					overlaps |= start < r.end && r.start < start + size;
+				}
+				bool thrown = false;
+				try {
+					t.add(MemoryDMI::create_start_size_mapping(host + start, start, size));
+				} catch (std::runtime_error &) {
+					thrown = true;
+				}
+				CHECK(thrown == overlaps);
+				if (!overlaps) {
+					ref.push_back(Range{start, start + size});
+				}
+				break;
+			}
+			case 1: {
+				uint64_t start = rnd(WINDOW);
+				uint64_t end = start + rnd(0x800);
+				size_t n = ref.size();
+				ref.erase(std::remove_if(ref.begin(), ref.end(),
+				                         [start, end](const Range &r) { return r.start <= end && start < r.end; }),
+				          ref.end());
+				CHECK(t.invalidate(start, end) == (ref.size() != n));
+				break;
+			}
+			default: {
+				uint64_t addr = rnd(WINDOW + 0x100);
+				uint64_t len = rnd(3) == 0 ? 0 : 1 + rnd(16);
+				/* twice -> second lookup hits the last range */
+				for (int i = 0; i < 2; i++) {
+					MemoryDMI *dmi = len == 0 ? t.find(addr) : t.find(addr, len);
+					const Range *r = ref_find(ref, addr, len == 0 ? 1 : len);
+					CHECK((dmi == nullptr) == (r == nullptr));
+					if (dmi != nullptr && r != nullptr) {
+						CHECK(dmi->get_start() == r->start && dmi->get_end() == r->end);
+						CHECK(dmi->get_raw_mem_ptr() == host + r->start);
+					}
+				}
+				break;
+			}
+		}
+		CHECK(t.empty() == ref.empty());
+		if (!ok) {
+			std::cerr << "FAILED: iteration " << it << std::endl;
+		}
+	}
+}
+
+int main(int argc, char **argv) {
+	return random_test_main(argc, argv, 100000, [](uint64_t iterations, uint64_t seed) {
+		test_fixed();
+		test_random(iterations, seed);
+		return ok;
+	});
+}
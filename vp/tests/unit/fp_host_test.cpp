@@ -0,0 +1,159 @@
+/*
+ * Randomized differential test: host FPU fast path (fp_host.h) vs. softfloat
+ *
+ * An iteration is one random operand pair per operation and rounding mode (default: 1000000, see random_test.h).
+ * Operands are random bit patterns biased towards special cases (zeros, subnormals, values near overflow and
+ * underflow, infinities, quiet and signaling NaNs). Results and exception flags of all operations in all rounding
+ * modes have to be bit-identical, the test fails on any difference.
+ */
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "core/common/fp_host.h"
+#include "random_test.h"
+
+template <typename T>
+struct Format;
+
+template <>
+struct Format<float32_t> {
+	using uint_t = uint32_t;
+	static constexpr unsigned int EXP_BITS = 8;
+	static constexpr unsigned int FRAC_BITS = 23;
+};
+
+template <>
+struct Format<float64_t> {
+	using uint_t = uint64_t;
+	static constexpr unsigned int EXP_BITS = 11;
+	static constexpr unsigned int FRAC_BITS = 52;
+};
+
+template <typename T>
+static T random_operand(std::mt19937_64 &rng) {
+	using F = Format<T>;
+	using uint_t = typename F::uint_t;
+	const uint_t exp_max = ((uint_t)1 << F::EXP_BITS) - 1;
+	const uint_t frac_mask = ((uint_t)1 << F::FRAC_BITS) - 1;
+
+	uint_t sign = (uint_t)(rng() & 1) << (F::EXP_BITS + F::FRAC_BITS);
+	uint_t frac = rng() & frac_mask;
+	uint_t exp;
+	switch (rng() % 8) {
+		case 0:
+			/* zero and subnormals */
+			exp = 0;
+			if (rng() % 4 == 0) {
+				frac = 0;
+			}
+			break;
+		case 1:
+			/* near underflow */
+			exp = 1 + rng() % (F::FRAC_BITS + 2);
+			break;
+		case 2:
+			/* near overflow */
+			exp = exp_max - 1 - rng() % 4;
+			break;
+		case 3:
+			/* infinities and NaNs (quiet and signaling) */
+			exp = exp_max;
+			if (rng() % 4 == 0) {
+				frac = 0;
+			}
+			break;
+		case 4:
+			/* around one (exact results) */
+			exp = (exp_max >> 1) - 2 + rng() % 4;
+			frac &= ~(frac_mask >> 4);
+			break;
+		default:
+			exp = rng() & exp_max;
+			break;
+	}
+	T x;
+	x.v = sign | (exp << F::FRAC_BITS) | frac;
+	return x;
+}
+
+struct Result {
+	uint64_t value;
+	uint_fast8_t flags;
+
+	bool operator!=(const Result &o) const {
+		return value != o.value || flags != o.flags;
+	}
+};
+
+template <typename T, typename T_op>
+static Result run(T_op op, T a, T b, uint_fast8_t rm) {
+	softfloat_roundingMode = rm;
+	softfloat_exceptionFlags = 0;
+	T r = op(a, b);
+	return Result{r.v, softfloat_exceptionFlags};
+}
+
+template <typename T, typename T_host_op, typename T_sf_op>
+static unsigned int test(const std::string &name, uint64_t iterations, std::mt19937_64 &rng, T_host_op host_op,
+                         T_sf_op sf_op) {
+	const unsigned int MAX_REPORTS = 10;
+	const uint_fast8_t rms[] = {softfloat_round_near_even, softfloat_round_minMag, softfloat_round_min,
+	                            softfloat_round_max, softfloat_round_near_maxMag};
+	unsigned int errors = 0;
+
+	for (uint_fast8_t rm : rms) {
+		for (uint64_t i = 0; i < iterations; i++) {
+			T a = random_operand<T>(rng);
+			T b = random_operand<T>(rng);
+			Result host = run<T>(host_op, a, b, rm);
+			Result sf = run<T>(sf_op, a, b, rm);
+			if (host != sf) {
+				if (errors < MAX_REPORTS) {
+					std::cout << std::hex << "MISMATCH " << name << " rm=" << (unsigned int)rm << " a=0x" << a.v
+					          << " b=0x" << b.v << ": host=0x" << host.value << "/0x" << (unsigned int)host.flags
+					          << " softfloat=0x" << sf.value << "/0x" << (unsigned int)sf.flags << std::dec
+					          << std::endl;
+				}
+				errors++;
+			}
+		}
+	}
+
+	std::cout << std::left << std::setw(10) << name << (errors == 0 ? "OK" : "FAILED") << " (" << errors << " errors)"
+	          << std::endl;
+	return errors;
+}
+
+static bool test_all(uint64_t iterations, uint64_t seed) {
+	std::mt19937_64 rng(seed);
+
+#ifndef FP_HOST_ENABLED
+	std::cout << "host FPU fast path disabled (see fp_host.h) -> nothing to test" << std::endl;
+#endif
+
+	unsigned int errors = 0;
+	errors += test<float32_t>("f32_add", iterations, rng, FpHost::f32_add, ::f32_add);
+	errors += test<float32_t>("f32_sub", iterations, rng, FpHost::f32_sub, ::f32_sub);
+	errors += test<float32_t>("f32_mul", iterations, rng, FpHost::f32_mul, ::f32_mul);
+	errors += test<float32_t>("f32_div", iterations, rng, FpHost::f32_div, ::f32_div);
+	errors += test<float32_t>(
+	    "f32_sqrt", iterations, rng, [](float32_t a, float32_t) { return FpHost::f32_sqrt(a); },
+	    [](float32_t a, float32_t) { return ::f32_sqrt(a); });
+	errors += test<float64_t>("f64_add", iterations, rng, FpHost::f64_add, ::f64_add);
+	errors += test<float64_t>("f64_sub", iterations, rng, FpHost::f64_sub, ::f64_sub);
+	errors += test<float64_t>("f64_mul", iterations, rng, FpHost::f64_mul, ::f64_mul);
+	errors += test<float64_t>("f64_div", iterations, rng, FpHost::f64_div, ::f64_div);
+	errors += test<float64_t>(
+	    "f64_sqrt", iterations, rng, [](float64_t a, float64_t) { return FpHost::f64_sqrt(a); },
+	    [](float64_t a, float64_t) { return ::f64_sqrt(a); });
+
+	return errors == 0;
+}
+
+int main(int argc, char **argv) {
+	return random_test_main(argc, argv, 1000000, test_all);
+}
@@ -0,0 +1,308 @@
+/*
+ * LSCache geometry microbenchmark: replays synthetic access patterns on LSCache_T (lscache.h) for several geometries
+ *
+ * Usage: lscache-replay [accesses [geometry ...]]
+ *  * accesses: number of loads/stores per pattern (default: 4000000)
+ *  * geometry: <sets>x<ways>+<victims> (default: the geometries of ../lscache-bench/bench.sh and some more)
+ * Results: see LSCACHE_DEFAULT_* in lscache.h
+ * The memory interface behind the cache is a stub (hash map page table, see BenchMemory) -> the cost of a miss differs
+ * from a VP (mmu and dmi lookups, quantum keeper). Compare the miss rates first, the times show the cost of the
+ * ways and victim checks on hits and of the flushes. The patterns:
+ *  * memcpy: copy between two buffers 1MiB apart (same sets in the direct-mapped default)
+ *  * segments: random accesses to stack, heap and data of a program at MiB aligned addresses (same sets)
+ *  * random-N: uniform random accesses to N pages
+ *  * zipf: zipf distributed accesses to 4096 scattered pages (e.g. kernel and user data of Linux)
+ *  * zipf-flush: as zipf, with a flush (sfence.vma, e.g. context switch) every 10000 accesses
+ * The cache is not flushed between the repetitions of a pattern (warm cache).
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/common/lscache.h"
+#include "core/common/mem_if.h"
+
+class BenchMemory : public data_memory_if_T<int64_t, uint64_t> {
+	static constexpr uint64_t PAGE_SIZE = 0x1000;
+
+	std::unordered_map<uint64_t, std::vector<uint8_t>> pages;
+	uint8_t *last_page = nullptr;
+
+	uint8_t *access(uint64_t addr) {
+		misses++;
+		std::vector<uint8_t> &page = pages[addr / PAGE_SIZE];
+		if (page.empty()) {
+			page.resize(PAGE_SIZE);
+		}
+		last_page = page.data();
+		return last_page + addr % PAGE_SIZE;
+	}
+
+	template <typename T>
+	T load(uint64_t addr) {
+		T value;
+		memcpy(&value, access(addr), sizeof(T));
+		return value;
+	}
+
+	template <typename T>
+	void store(uint64_t addr, T value) {
+		memcpy(access(addr), &value, sizeof(T));
+	}
+
+   public:
+	/* accesses of the memory interface (= misses of the cache) */
+	uint64_t misses = 0;
+
+	int64_t load_double(uint64_t addr) override {
+		return load<uint64_t>(addr);
+	}
+	int64_t load_word(uint64_t addr) override {
+		return (int32_t)load<uint32_t>(addr);
+	}
+	int64_t load_half(uint64_t addr) override {
+		return (int16_t)load<uint16_t>(addr);
+	}
+	int64_t load_byte(uint64_t addr) override {
+		return (int8_t)load<uint8_t>(addr);
+	}
+	uint64_t load_uword(uint64_t addr) override {
+		return load<uint32_t>(addr);
+	}
+	uint64_t load_uhalf(uint64_t addr) override {
+		return load<uint16_t>(addr);
+	}
+	uint64_t load_ubyte(uint64_t addr) override {
+		return load<uint8_t>(addr);
+	}
+	void store_double(uint64_t addr, uint64_t value) override {
+		store(addr, value);
+	}
+	void store_word(uint64_t addr, uint32_t value) override {
+		store(addr, value);
+	}
+	void store_half(uint64_t addr, uint16_t value) override {
+		store(addr, value);
+	}
+	void store_byte(uint64_t addr, uint8_t value) override {
+		store(addr, value);
+	}
+
+	/* not used by the benchmark */
+	int64_t atomic_execute_amo_word(uint64_t, uint32_t, std::function<uint32_t(uint32_t, uint32_t)>) override {
+		abort();
+	}
+	int64_t atomic_load_reserved_word(uint64_t) override {
+		abort();
+	}
+	bool atomic_store_conditional_word(uint64_t, uint32_t) override {
+		abort();
+	}
+	void atomic_unlock() override {}
+	int64_t atomic_execute_amo_double(uint64_t, uint64_t, std::function<uint64_t(uint64_t, uint64_t)>) override {
+		abort();
+	}
+	int64_t atomic_load_reserved_double(uint64_t) override {
+		abort();
+	}
+	bool atomic_store_conditional_double(uint64_t, uint64_t) override {
+		abort();
+	}
+
+	bool is_bus_locked() override {
+		return false;
+	}
+	void *get_last_dmi_page_host_addr() override {
+		return last_page;
+	}
+	void flush_tlb() override {}
+};
+
+struct Access {
+	uint64_t addr;
+	bool store;
+};
+
+struct Pattern {
+	std::string name;
+	std::vector<Access> accesses;
+	/* flush the cache every flush_period accesses (0: never) */
+	uint64_t flush_period;
+};
+
+static constexpr uint64_t PAGE = 0x1000;
+static constexpr uint64_t MIB = 0x100000;
+
+static std::vector<Pattern> generate_patterns(uint64_t n) {
+	std::mt19937_64 rng(42);
+	std::vector<Pattern> patterns;
+	auto store = [&rng]() { return rng() % 4 == 0; };
+	auto word = [&rng]() { return (rng() % (PAGE / 8)) * 8; };
+
+	/* memcpy of 64KiB, 8 bytes per load/store */
+	Pattern memcpy_p{"memcpy", {}, 0};
+	for (uint64_t off = 0; memcpy_p.accesses.size() < n; off = (off + 8) % (64 * 1024)) {
+		memcpy_p.accesses.push_back(Access{0x10000000 + off, false});
+		memcpy_p.accesses.push_back(Access{0x10000000 + MIB + off, true});
+	}
+	patterns.push_back(memcpy_p);
+
+	/* stack (4 pages), heap (64 pages) and data (16 pages) */
+	Pattern segments{"segments", {}, 0};
+	while (segments.accesses.size() < n) {
+		uint64_t r = rng() % 8;
+		uint64_t addr;
+		if (r < 4) {
+			addr = 0x7ff00000 - 4 * PAGE + (rng() % 4) * PAGE;
+		} else if (r < 6) {
+			addr = 0x20000000 + (rng() % 64) * PAGE;
+		} else {
+			addr = 0x00100000 + (rng() % 16) * PAGE;
+		}
+		segments.accesses.push_back(Access{addr + word(), store()});
+	}
+	patterns.push_back(segments);
+
+	for (uint64_t pages : {64, 512, 2048}) {
+		Pattern random{"random-" + std::to_string(pages), {}, 0};
+		while (random.accesses.size() < n) {
+			random.accesses.push_back(Access{0x80000000 + (rng() % pages) * PAGE + word(), store()});
+		}
+		patterns.push_back(random);
+	}
+
+	/* zipf (s = 1) over 4096 pages scattered in 1GiB */
+	const unsigned int ZIPF_PAGES = 4096;
+	std::vector<double> cdf(ZIPF_PAGES);
+	double sum = 0;
+	for (unsigned int i = 0; i < ZIPF_PAGES; i++) {
+		sum += 1.0 / (i + 1);
+		cdf[i] = sum;
+	}
+	std::vector<uint64_t> zipf_page(ZIPF_PAGES);
+	for (auto &p : zipf_page) {
+		p = 0x40000000 + (rng() % (1024 * MIB / PAGE)) * PAGE;
+	}
+	Pattern zipf{"zipf", {}, 0};
+	std::uniform_real_distribution<double> uniform(0, sum);
+	while (zipf.accesses.size() < n) {
+		unsigned int i = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin();
+		zipf.accesses.push_back(Access{zipf_page[std::min(i, ZIPF_PAGES - 1)] + word(), store()});
+	}
+	patterns.push_back(zipf);
+	patterns.push_back(Pattern{"zipf-flush", zipf.accesses, 10000});
+
+	return patterns;
+}
+
+struct Geometry {
+	unsigned int sets;
+	unsigned int ways;
+	unsigned int victims;
+
+	std::string str() const {
+		return std::to_string(sets) + "x" + std::to_string(ways) + "+" + std::to_string(victims);
+	}
+};
+
+static bool parse_geometry(const std::string &s, Geometry &g) {
+	return sscanf(s.c_str(), "%ux%u+%u", &g.sets, &g.ways, &g.victims) == 3;
+}
+
+struct Result {
+	double ns;
+	double miss_rate;
+};
+
+static Result run(const Pattern &p, const Geometry &g) {
+	const unsigned int REPEAT = 3;
+	BenchMemory mem;
+	LSCache_T<int64_t, uint64_t> lscache;
+	lscache.set_geometry(g.sets, g.ways, g.victims);
+	lscache.init(true, 0, &mem);
+
+	/* first pass: warm up (allocate pages) */
+	volatile uint64_t sink = 0;
+	double best = INFINITY;
+	for (unsigned int r = 0; r <= REPEAT; r++) {
+		mem.misses = 0;
+		auto start = std::chrono::steady_clock::now();
+		uint64_t i = 0;
+		for (const Access &a : p.accesses) {
+			if (a.store) {
+				lscache.store_double(a.addr, i);
+			} else {
+				sink += lscache.load_double(a.addr);
+			}
+			if (p.flush_period != 0 && ++i == p.flush_period) {
+				lscache.fence_vma();
+				i = 0;
+			}
+		}
+		auto end = std::chrono::steady_clock::now();
+		if (r > 0) {
+			best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+		}
+	}
+	return Result{best / p.accesses.size(), (double)mem.misses / p.accesses.size()};
+}
+
+int main(int argc, char **argv) {
+	uint64_t n = argc > 1 ? strtoull(argv[1], nullptr, 0) : 4000000;
+	std::vector<Geometry> geometries;
+	for (int i = 2; i < argc; i++) {
+		Geometry g;
+		if (!parse_geometry(argv[i], g)) {
+			std::cerr << "usage: " << argv[0] << " [accesses [<sets>x<ways>+<victims> ...]]" << std::endl;
+			return EXIT_FAILURE;
+		}
+		geometries.push_back(g);
+	}
+	if (geometries.empty()) {
+		geometries = {{256, 1, 0},  {256, 1, 8},  {512, 1, 0},  {1024, 1, 0},  {256, 2, 0},
+		              {256, 2, 8},  {256, 4, 8},  {512, 2, 8},  {1024, 2, 16}, {1024, 4, 16}};
+	}
+	if (n == 0) {
+		std::cerr << "usage: " << argv[0] << " [accesses [<sets>x<ways>+<victims> ...]]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::vector<Pattern> patterns = generate_patterns(n);
+
+	std::cout << "ns per access (miss rate in %), " << n << " accesses per pattern" << std::endl;
+	std::cout << std::left << std::setw(12) << "geometry";
+	for (const Pattern &p : patterns) {
+		std::cout << std::setw(15) << p.name;
+	}
+	std::cout << std::endl;
+	for (const Geometry &g : geometries) {
+		try {
+			std::cout << std::left << std::setw(12) << g.str();
+			for (const Pattern &p : patterns) {
+				Result r = run(p, g);
+				std::ostringstream s;
+				s << std::fixed << std::setprecision(2) << r.ns << " (" << std::setprecision(1) << 100 * r.miss_rate
+				  << ")";
+				std::cout << std::setw(15) << s.str() << std::flush;
+			}
+			std::cout << std::endl;
+		} catch (std::runtime_error &e) {
+			std::cerr << e.what() << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,163 @@
+/*
+ * Decode throughput microbenchmark: reference decoders (Instruction::decode_*) vs. Predecoder
+ *
+ * Usage: predecode-bench [rounds [file]]
+ *        predecode-bench --all
+ *  * rounds: number of decode rounds over the instruction stream (default: 100)
+ *  * file: raw binary (e.g. objcopy -O binary) used as instruction stream
+ *    (default: all compressed encodings + random normal instruction words)
+ *  * --all: only compare the decoders for all 2^30 normal encodings (takes some minutes)
+ * The results of both decoders are compared, the benchmark fails on any difference.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "core/common/predecode.h"
+
+static std::vector<uint32_t> load_stream(const char *file) {
+	std::vector<uint32_t> stream;
+	std::ifstream f(file, std::ios::binary);
+	std::vector<uint8_t> buf((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+	for (size_t i = 0; i + 1 < buf.size();) {
+		uint32_t word = buf[i] | (buf[i + 1] << 8);
+		if ((word & 0x3) == 0x3) {
+			if (i + 3 >= buf.size()) {
+				break;
+			}
+			word |= (buf[i + 2] << 16) | ((uint32_t)buf[i + 3] << 24);
+			i += 4;
+		} else {
+			i += 2;
+		}
+		stream.push_back(word);
+	}
+	return stream;
+}
+
+static std::vector<uint32_t> generate_stream() {
+	std::vector<uint32_t> stream;
+	for (uint32_t i = 0; i < (1 << 16); i++) {
+		if ((i & 0x3) != 0x3) {
+			stream.push_back(i);
+		}
+	}
+	/* code footprint of 4K different normal instruction words */
+	std::mt19937 rng(42);
+	std::vector<uint32_t> words(4096);
+	for (auto &word : words) {
+		word = rng() | 0x3;
+	}
+	for (unsigned int i = 0; i < (1 << 16); i++) {
+		stream.push_back(words[rng() % words.size()]);
+	}
+	return stream;
+}
+
+template <typename T_decode>
+static double bench(const std::vector<uint32_t> &stream, unsigned int rounds, T_decode decode) {
+	uint64_t sum = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned int r = 0; r < rounds; r++) {
+		for (uint32_t word : stream) {
+			Instruction instr(word);
+			sum += decode(instr) + instr.data();
+		}
+	}
+	auto end = std::chrono::steady_clock::now();
+	/* keep the compiler from removing the loop */
+	if (sum == 1) {
+		std::cout << std::endl;
+	}
+	return std::chrono::duration<double, std::nano>(end - start).count() / ((double)rounds * stream.size());
+}
+
+static bool run(Architecture arch, const char *name, const std::vector<uint32_t> &stream, unsigned int rounds,
+                bool all) {
+	RV_ISA_Config isa_config(false, true);
+	static Predecoder predecoder;
+
+	auto start = std::chrono::steady_clock::now();
+	predecoder.init(arch, &isa_config);
+	auto end = std::chrono::steady_clock::now();
+
+	auto reference = [&](Instruction &instr) {
+		try {
+			if (instr.is_compressed()) {
+				return instr.decode_and_expand_compressed(arch, isa_config);
+			}
+			return instr.decode_normal(arch, isa_config);
+		} catch (std::exception &) {
+			return Operation::OpId::UNDEF;
+		}
+	};
+	auto predecode = [&](Instruction &instr) {
+		try {
+			return predecoder.decode(instr);
+		} catch (std::exception &) {
+			return Operation::OpId::UNDEF;
+		}
+	};
+
+	auto compare = [&](uint32_t word) {
+		Instruction a(word), b(word);
+		Operation::OpId opA = reference(a);
+		Operation::OpId opB = predecode(b);
+		if (opA != opB || a.data() != b.data()) {
+			std::cerr << name << ": mismatch for 0x" << std::hex << word << ": " << Operation::opIdStr[opA] << "/0x"
+			          << a.data() << " != " << Operation::opIdStr[opB] << "/0x" << b.data() << std::dec << std::endl;
+			return false;
+		}
+		return true;
+	};
+
+	if (all) {
+		for (uint64_t word = 0x3; word <= UINT32_MAX; word += 4) {
+			if (!compare(word)) {
+				return false;
+			}
+		}
+		std::cout << name << ": all normal encodings match (" << predecoder.get_normal_fallbacks() << " of "
+		          << Predecoder::NORMAL_TABLE_SIZE << " dispatch entries use the reference decoder)" << std::endl;
+		return true;
+	}
+
+	for (uint32_t word : stream) {
+		if (!compare(word)) {
+			return false;
+		}
+	}
+
+	double ref_ns = bench(stream, rounds, reference);
+	double pre_ns = bench(stream, rounds, predecode);
+	std::cout << name << ": table generation: "
+	          << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+	std::cout << name << ": reference: " << ref_ns << " ns/decode, predecoder: " << pre_ns
+	          << " ns/decode, speedup: " << ref_ns / pre_ns << std::endl;
+	return true;
+}
+
+int main(int argc, char **argv) {
+	if (argc == 2 && std::string(argv[1]) == "--all") {
+		bool ok = run(RV32, "RV32", {}, 0, true);
+		ok = run(RV64, "RV64", {}, 0, true) && ok;
+		return ok ? 0 : 1;
+	}
+
+	unsigned int rounds = argc > 1 ? strtoul(argv[1], nullptr, 0) : 100;
+	std::vector<uint32_t> stream = argc > 2 ? load_stream(argv[2]) : generate_stream();
+	if (rounds == 0 || stream.empty()) {
+		std::cerr << "usage: " << argv[0] << " [rounds [file]]" << std::endl;
+		return 1;
+	}
+
+	std::cout << "instruction stream: " << stream.size() << " words, " << rounds << " rounds" << std::endl;
+	bool ok = run(RV32, "RV32", stream, rounds, false);
+	ok = run(RV64, "RV64", stream, rounds, false) && ok;
+	return ok ? 0 : 1;
+}
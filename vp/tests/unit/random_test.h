@@ -0,0 +1,36 @@
+/*
+ * Driver of the randomized host tests
+ *
+ * Usage: <test> [iterations [seed]]
+ *  * iterations: number of random iterations (default: given by the test, see random_test_main)
+ *  * seed: seed of the random generator (default: RANDOM_TEST_SEED)
+ * The seed is printed on failure -> a failed run can be repeated with the same arguments.
+ */
+
+#ifndef RISCV_VP_TESTS_UNIT_RANDOM_TEST_H
+#define RISCV_VP_TESTS_UNIT_RANDOM_TEST_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+static constexpr uint64_t RANDOM_TEST_SEED = 42;
+
+/* run(iterations, seed) -> true, if the test passed; returns the exit code of the test */
+template <typename T_run>
+static int random_test_main(int argc, char **argv, uint64_t default_iterations, T_run run) {
+	if (argc > 3) {
+		std::cerr << "usage: " << argv[0] << " [iterations [seed]]" << std::endl;
+		return EXIT_FAILURE;
+	}
+	uint64_t iterations = argc > 1 ? strtoull(argv[1], nullptr, 0) : default_iterations;
+	uint64_t seed = argc > 2 ? strtoull(argv[2], nullptr, 0) : RANDOM_TEST_SEED;
+
+	if (!run(iterations, seed)) {
+		std::cerr << "FAILED (iterations: " << iterations << ", seed: " << seed << ")" << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
+
+#endif /* RISCV_VP_TESTS_UNIT_RANDOM_TEST_H */
@@ -0,0 +1,465 @@
+/*
+ * Randomized test: vector loads/stores (v.h, VExtension::vLoadStore) vs. a reference model
+ *
+ * An iteration is one random load or store (default: 100000, see random_test.h).
+ * Covers unit-stride (incl. segments), whole register (nf > 0), mask and strided loads/stores (masked and unmasked)
+ * with random element widths, vl, vstart, misaligned base addresses and strides and runs crossing page boundaries.
+ * Virtual pages are mapped to scattered host pages. Optionally, one page touched by the access faults: The access
+ * has to trap at the first element touching the page with vstart set to this element, only the elements before it
+ * may be committed (no partially committed element) and a restart (with vstart) after the fault was resolved has to
+ * complete the access. The LSCache is used as in the ISS (bulk accesses on hits, element accesses on misses).
+ */
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "core/common/fp.h"
+#include "core/common/instr.h"
+#include "core/common/irq_if.h"
+#include "core/common/lscache.h"
+#include "core/common/mem_if.h"
+#include "core/common/trap.h"
+#include "core/common/v.h"
+#include "core/rv64/csr.h"
+#include "random_test.h"
+
+/* virtual address space: N_PAGES pages at V_BASE, mapped to scattered host pages */
+static constexpr uint64_t V_BASE = 0x80000000;
+static constexpr uint64_t N_PAGES = 8;
+static constexpr uint64_t PAGE_SIZE = 0x1000;
+
+class TestMemory : public data_memory_if_T<int64_t, uint64_t> {
+	std::vector<uint8_t> host = std::vector<uint8_t>(N_PAGES * PAGE_SIZE);
+	std::array<uint64_t, N_PAGES> host_page;
+	uint8_t *last_page = nullptr;
+
+	uint64_t vpage(uint64_t addr) {
+		if (addr < V_BASE || addr >= V_BASE + N_PAGES * PAGE_SIZE) {
+			std::cerr << "test error: access out of range: 0x" << std::hex << addr << std::endl;
+			exit(1);
+		}
+		return (addr - V_BASE) / PAGE_SIZE;
+	}
+
+	/* one access (may cross a page boundary) -> traps before any byte is accessed */
+	void access(uint64_t addr, unsigned int len, bool store) {
+		if (vpage(addr) == fault_page || vpage(addr + len - 1) == fault_page) {
+			raise_trap(store ? EXC_STORE_AMO_PAGE_FAULT : EXC_LOAD_PAGE_FAULT, addr);
+		}
+		last_page = &host[host_page[vpage(addr)] * PAGE_SIZE];
+	}
+
+	template <typename T>
+	T load(uint64_t addr) {
+		access(addr, sizeof(T), false);
+		T value = 0;
+		for (unsigned int b = 0; b < sizeof(T); b++) {
+			value |= (T)byte(addr + b) << (8 * b);
+		}
+		return value;
+	}
+
+	template <typename T>
+	void store(uint64_t addr, T value) {
+		access(addr, sizeof(T), true);
+		for (unsigned int b = 0; b < sizeof(T); b++) {
+			byte(addr + b) = value >> (8 * b);
+		}
+	}
+
+   public:
+	/* page index or N_PAGES (no fault) */
+	uint64_t fault_page = N_PAGES;
+
+	TestMemory(std::mt19937_64 &rng) {
+		for (uint64_t i = 0; i < N_PAGES; i++) {
+			host_page[i] = i;
+		}
+		std::shuffle(host_page.begin(), host_page.end(), rng);
+	}
+
+	uint8_t &byte(uint64_t addr) {
+		return host[host_page[vpage(addr)] * PAGE_SIZE + (addr % PAGE_SIZE)];
+	}
+
+	/* contents in virtual address order */
+	std::vector<uint8_t> snapshot() {
+		std::vector<uint8_t> ret(N_PAGES * PAGE_SIZE);
+		for (uint64_t i = 0; i < N_PAGES; i++) {
+			memcpy(&ret[i * PAGE_SIZE], &host[host_page[i] * PAGE_SIZE], PAGE_SIZE);
+		}
+		return ret;
+	}
+
+	int64_t load_double(uint64_t addr) override {
+		return load<uint64_t>(addr);
+	}
+	int64_t load_word(uint64_t addr) override {
+		return (int32_t)load<uint32_t>(addr);
+	}
+	int64_t load_half(uint64_t addr) override {
+		return (int16_t)load<uint16_t>(addr);
+	}
+	int64_t load_byte(uint64_t addr) override {
+		return (int8_t)load<uint8_t>(addr);
+	}
+	uint64_t load_uword(uint64_t addr) override {
+		return load<uint32_t>(addr);
+	}
+	uint64_t load_uhalf(uint64_t addr) override {
+		return load<uint16_t>(addr);
+	}
+	uint64_t load_ubyte(uint64_t addr) override {
+		return load<uint8_t>(addr);
+	}
+	void store_double(uint64_t addr, uint64_t value) override {
+		store(addr, value);
+	}
+	void store_word(uint64_t addr, uint32_t value) override {
+		store(addr, value);
+	}
+	void store_half(uint64_t addr, uint16_t value) override {
+		store(addr, value);
+	}
+	void store_byte(uint64_t addr, uint8_t value) override {
+		store(addr, value);
+	}
+
+	/* not used by vector loads/stores */
+	int64_t atomic_execute_amo_word(uint64_t, uint32_t, std::function<uint32_t(uint32_t, uint32_t)>) override {
+		abort();
+	}
+	int64_t atomic_load_reserved_word(uint64_t) override {
+		abort();
+	}
+	bool atomic_store_conditional_word(uint64_t, uint32_t) override {
+		abort();
+	}
+	void atomic_unlock() override {}
+	int64_t atomic_execute_amo_double(uint64_t, uint64_t, std::function<uint64_t(uint64_t, uint64_t)>) override {
+		abort();
+	}
+	int64_t atomic_load_reserved_double(uint64_t) override {
+		abort();
+	}
+	bool atomic_store_conditional_double(uint64_t, uint64_t) override {
+		abort();
+	}
+
+	bool is_bus_locked() override {
+		return false;
+	}
+	void *get_last_dmi_page_host_addr() override {
+		return last_page;
+	}
+	void flush_tlb() override {}
+};
+
+struct TestRegFile {
+	static constexpr unsigned int zero = 0;
+	int64_t regs[32] = {};
+	int64_t &operator[](unsigned int idx) {
+		return regs[idx];
+	}
+};
+
+/* the parts of the ISS used by vector loads/stores */
+struct TestISS {
+	rv64::csr_table csrs;
+	Instruction instr;
+	TestRegFile regs;
+	TestMemory memory;
+	data_memory_if_T<int64_t, uint64_t> *mem = &memory;
+	LSCache_T<int64_t, uint64_t> lscache;
+
+	TestISS(std::mt19937_64 &rng) : memory(rng) {
+		lscache.init(true, 0, &memory);
+	}
+};
+
+using VExt = VExtension<TestISS>;
+
+/* one element access: memory address, byte offset in the register file, vstart of the element */
+struct Access {
+	uint64_t addr;
+	uint64_t reg_off;
+	uint64_t vstart;
+};
+
+struct Test {
+	VExt::load_store_t ldst;
+	VExt::load_store_type_t type;
+	unsigned int numBits;
+	uint64_t base;
+	uint64_t stride;
+	unsigned int rd;
+	unsigned int nf;
+	bool vm;
+	unsigned int sew;
+	unsigned int vlmul;
+	uint64_t vl;
+	uint64_t vstart;
+};
+
+static const char *type_name(VExt::load_store_type_t type) {
+	switch (type) {
+		case VExt::load_store_type_t::standard:
+			return "unit-stride";
+		case VExt::load_store_type_t::standard_reg:
+			return "strided";
+		case VExt::load_store_type_t::masked:
+			return "mask";
+		case VExt::load_store_type_t::whole:
+			return "whole";
+		default:
+			return "?";
+	}
+}
+
+/* random valid load/store (see vLoadReqs and the register alignment checks in vLoadStore) */
+static Test random_test(std::mt19937_64 &rng) {
+	static const VExt::load_store_type_t types[] = {
+	    VExt::load_store_type_t::standard, VExt::load_store_type_t::standard_reg, VExt::load_store_type_t::masked,
+	    VExt::load_store_type_t::whole};
+	Test t;
+	t.ldst = rng() % 2 ? VExt::load_store_t::load : VExt::load_store_t::store;
+	t.type = types[rng() % 4];
+	t.numBits = 8 << (rng() % 4);
+	t.nf = 0;
+	t.vm = true;
+	t.stride = t.numBits / 8;
+	t.sew = 8 << (rng() % 4);
+	t.vlmul = 0;
+	unsigned int emul = 1;
+
+	if (t.type == VExt::load_store_type_t::whole) {
+		static const unsigned int nfs[] = {0, 1, 3, 7};
+		t.nf = nfs[rng() % 4];
+		emul = t.nf + 1;
+	} else if (t.type == VExt::load_store_type_t::masked) {
+		t.numBits = 8;
+		t.stride = 1;
+	} else {
+		/* lmul 1/2 .. 4, emul = numBits / sew * lmul in 1/8 .. 8 */
+		while (true) {
+			int lmul_log2 = (int)(rng() % 4) - 1;
+			int emul_log2 = lmul_log2 + __builtin_ctz(t.numBits) - __builtin_ctz(t.sew);
+			if (emul_log2 < -3 || emul_log2 > 3) {
+				continue;
+			}
+			emul = emul_log2 < 0 ? 1 : 1 << emul_log2;
+			t.nf = rng() % (8 / emul);
+			t.vlmul = lmul_log2 & 7;
+			break;
+		}
+		t.vm = rng() % 4 != 0;
+		if (t.type == VExt::load_store_type_t::standard_reg) {
+			/* stride = element size (contiguous) or any (misaligned) stride */
+			t.stride = rng() % 2 ? t.numBits / 8 : rng() % 40;
+		}
+	}
+
+	/* vd aligned to its group, not v0 for masked loads */
+	while (true) {
+		t.rd = (rng() % (32 / emul)) * emul;
+		if (t.type != VExt::load_store_type_t::whole && t.rd + (t.nf + 1) * emul > 32) {
+			continue;
+		}
+		if (t.vm || t.rd != 0) {
+			break;
+		}
+	}
+
+	int lmul_log2 = (int8_t)(t.vlmul << 5) >> 5;
+	uint64_t vlmax = lmul_log2 < 0 ? VLEN / t.sew >> -lmul_log2 : VLEN / t.sew << lmul_log2;
+	t.vl = rng() % (vlmax + 1);
+
+	/* elements (see vLoadReqs) */
+	uint64_t nelem = t.vl;
+	if (t.type == VExt::load_store_type_t::whole) {
+		nelem = VLEN / t.numBits * (t.nf + 1);
+	} else if (t.type == VExt::load_store_type_t::masked) {
+		nelem = (t.vl + 7) / 8;
+	}
+	t.vstart = rng() % 4 ? 0 : rng() % (nelem + 1);
+
+	/* base near a page boundary (misaligned, if not aligned to the element size) */
+	t.base = V_BASE + (1 + rng() % 3) * PAGE_SIZE - rng() % 256;
+	if (rng() % 2) {
+		t.base &= ~(uint64_t)(t.numBits / 8 - 1);
+	}
+	return t;
+}
+
+/* all element accesses of t in order of execution (see vLoadStore) */
+static std::vector<Access> accesses(const Test &t, VExt &v) {
+	std::vector<Access> ret;
+	uint64_t nb = t.numBits / 8;
+	uint64_t epr = VLENB / nb;
+
+	if (t.type == VExt::load_store_type_t::whole) {
+		/* flat register group, vstart counts elements of the group */
+		for (uint64_t k = t.vstart; k < VLEN / t.numBits * (t.nf + 1); k++) {
+			ret.push_back({t.base + k * nb, t.rd * VLENB + k * nb, k});
+		}
+		return ret;
+	}
+
+	uint64_t evl = t.type == VExt::load_store_type_t::masked ? (t.vl + 7) / 8 : t.vl;
+	int lmul_log2 = (int8_t)(t.vlmul << 5) >> 5;
+	int emul_log2 = lmul_log2 + __builtin_ctz(t.numBits) - __builtin_ctz(t.sew);
+	uint64_t emul = t.type == VExt::load_store_type_t::masked || emul_log2 < 0 ? 1 : 1 << emul_log2;
+	for (uint64_t i = t.vstart; i < evl; i++) {
+		if (!t.vm && !((v.get_reg<uint8_t>(0, i / 8) >> (i % 8)) & 1)) {
+			continue;
+		}
+		for (uint64_t field = 0; field <= t.nf; field++) {
+			uint64_t addr = t.type == VExt::load_store_type_t::standard_reg ? t.base + i * t.stride + field * nb
+			                                                                : t.base + (i * (t.nf + 1) + field) * nb;
+			uint64_t reg = t.rd + field * emul + i / epr;
+			ret.push_back({addr, reg * VLENB + (i % epr) * nb, i});
+		}
+	}
+	return ret;
+}
+
+static uint32_t encode(const Test &t) {
+	static const uint32_t widths[] = {0b000, 0b101, 0b110, 0b111};
+	uint32_t mop = t.type == VExt::load_store_type_t::standard_reg ? 0b10 : 0b00;
+	uint32_t lumop = t.type == VExt::load_store_type_t::whole ? 0b01000 : t.type == VExt::load_store_type_t::masked ? 0b01011 : 0;
+	uint32_t rs2 = t.type == VExt::load_store_type_t::standard_reg ? 2 : lumop;
+	return t.nf << 29 | mop << 26 | (uint32_t)t.vm << 25 | rs2 << 20 | 1 << 15 |
+	       widths[__builtin_ctz(t.numBits) - 3] << 12 | t.rd << 7 | (t.ldst == VExt::load_store_t::load ? 0x07 : 0x27);
+}
+
+static bool run(uint64_t iterations, uint64_t seed) {
+	std::mt19937_64 rng(seed);
+	TestISS iss(rng);
+	VExt v(iss);
+	uint64_t traps = 0;
+
+	for (uint64_t a = V_BASE; a < V_BASE + N_PAGES * PAGE_SIZE; a++) {
+		iss.memory.byte(a) = rng();
+	}
+
+	for (uint64_t it = 0; it < iterations; it++) {
+		Test t = random_test(rng);
+
+		iss.instr = Instruction(encode(t));
+		iss.regs[1] = t.base;
+		iss.regs[2] = t.stride;
+		iss.csrs.vtype.reg.val = 0;
+		iss.csrs.vtype.reg.fields.vsew = __builtin_ctz(t.sew) - 3;
+		iss.csrs.vtype.reg.fields.vlmul = t.vlmul;
+		iss.csrs.vl.reg.val = t.vl;
+		iss.csrs.vstart.reg.val = t.vstart;
+
+		/* random register file (memory: random on start, changed by the stores) */
+		std::vector<uint8_t> regs_before(32 * VLENB);
+		for (uint64_t i = 0; i < regs_before.size(); i++) {
+			regs_before[i] = v.get_reg<uint8_t>(0, i) = rng();
+		}
+		std::vector<uint8_t> mem_before = iss.memory.snapshot();
+
+		std::vector<Access> acc = accesses(t, v);
+		uint64_t nb = t.numBits / 8;
+
+		/* optional fault on a page of an element -> index of the first access touching the page */
+		size_t fault_idx = acc.size();
+		iss.memory.fault_page = N_PAGES;
+		if (!acc.empty() && rng() % 2) {
+			/* the page may be cached from previous accesses */
+			iss.lscache.flush();
+			const Access &a = acc[rng() % acc.size()];
+			iss.memory.fault_page = (a.addr + (rng() % 2 ? nb - 1 : 0) - V_BASE) / PAGE_SIZE;
+			for (fault_idx = 0; fault_idx < acc.size(); fault_idx++) {
+				uint64_t first = (acc[fault_idx].addr - V_BASE) / PAGE_SIZE;
+				uint64_t last = (acc[fault_idx].addr + nb - 1 - V_BASE) / PAGE_SIZE;
+				if (first == iss.memory.fault_page || last == iss.memory.fault_page) {
+					break;
+				}
+			}
+		}
+
+		/* expected state after the accesses before fault_idx (n) */
+		auto check = [&](size_t n, const char *when) {
+			std::vector<uint8_t> regs = regs_before;
+			std::vector<uint8_t> mem = mem_before;
+			for (size_t i = 0; i < n; i++) {
+				for (uint64_t b = 0; b < nb; b++) {
+					uint64_t moff = acc[i].addr + b - V_BASE;
+					if (t.ldst == VExt::load_store_t::load) {
+						regs[acc[i].reg_off + b] = mem[moff];
+					} else {
+						mem[moff] = regs[acc[i].reg_off + b];
+					}
+				}
+			}
+			for (uint64_t i = 0; i < regs.size(); i++) {
+				if (v.get_reg<uint8_t>(0, i) != regs[i]) {
+					std::cerr << "register file mismatch (" << when << ") at byte " << i << std::endl;
+					return false;
+				}
+			}
+			std::vector<uint8_t> mem_now = iss.memory.snapshot();
+			for (uint64_t i = 0; i < mem.size(); i++) {
+				if (mem_now[i] != mem[i]) {
+					std::cerr << "memory mismatch (" << when << ") at 0x" << std::hex << V_BASE + i << std::dec
+					          << std::endl;
+					return false;
+				}
+			}
+			return true;
+		};
+
+		bool ok = true;
+		try {
+			v.vLoadStore(t.ldst, t.numBits, t.type);
+			if (fault_idx != acc.size()) {
+				std::cerr << "missing trap" << std::endl;
+				ok = false;
+			}
+		} catch (SimulationTrap &e) {
+			traps++;
+			if (fault_idx == acc.size() || e.reason == EXC_ILLEGAL_INSTR) {
+				std::cerr << "unexpected trap " << e.reason << std::endl;
+				ok = false;
+			} else if (iss.csrs.vstart.reg.val != acc[fault_idx].vstart) {
+				std::cerr << "vstart " << iss.csrs.vstart.reg.val << ", expected " << acc[fault_idx].vstart
+				          << std::endl;
+				ok = false;
+			} else {
+				/* only the elements before the trapping one are committed */
+				ok = check(fault_idx, "after trap");
+				if (ok) {
+					/* restart (e.g. after the page fault was handled) */
+					iss.memory.fault_page = N_PAGES;
+					v.vLoadStore(t.ldst, t.numBits, t.type);
+				}
+			}
+		}
+		ok = ok && check(acc.size(), "after completion");
+
+		if (!ok) {
+			std::cerr << "FAILED: iteration " << it << ": " << (t.ldst == VExt::load_store_t::load ? "load " : "store ")
+			          << type_name(t.type) << " eew " << t.numBits << " sew " << t.sew << " vlmul " << t.vlmul
+			          << " vl " << t.vl << " vstart " << t.vstart << " nf " << t.nf << " vm " << t.vm << " rd "
+			          << t.rd << " base 0x" << std::hex << t.base << std::dec << " stride " << t.stride << std::endl;
+			return false;
+		}
+	}
+
+	std::cout << iterations << " loads/stores (" << traps << " with trap and restart) ok" << std::endl;
+	return true;
+}
+
+int main(int argc, char **argv) {
+	return random_test_main(argc, argv, 100000, run);
+}